@@ -0,0 +1,51 @@
+import pandas as pd
+import matplotlib.pyplot as plt
+import os
+import sys
+
+# File and output configurations
+file_hopcount = sys.argv[1] if len(sys.argv) > 1 else "result_hopcount.csv"  # Hop count runs
+file_etx = sys.argv[2] if len(sys.argv) > 2 else "result_etx.csv"  # ETX runs
+output_dir = "graphs/etx"  # Directory to save the graphs
+os.makedirs(output_dir, exist_ok=True)
+
+# Load the data
+df_hopcount = pd.read_csv(file_hopcount)
+df_etx = pd.read_csv(file_etx)
+
+# Metrics to plot
+metrics = ["Throughput", "EndToEndDelay", "PacketDeliveryRatio", "PacketDropRatio"]
+
+# Row groups of run_simulation.sh: first 4 vary nodes, next 4 packets/s, last 4 speed
+groups = [("NumOfNodes", slice(0, 4)), ("PacketsPerSec", slice(4, 8)), ("NodeSpeed", slice(8, 12))]
+
+# Function to plot and save a single graph
+def plot_graph(rows_hopcount, rows_etx, x_label, y_label, title, output_filename):
+    plt.figure()
+    plt.plot(rows_hopcount[x_label], rows_hopcount[y_label], marker='o', label='Hop count', color='blue')
+    plt.plot(rows_etx[x_label], rows_etx[y_label], marker='x', label='ETX', color='red')
+    plt.title(title)
+    plt.xlabel(x_label)
+    plt.ylabel(y_label)
+    plt.grid(True)
+    plt.legend()
+    plt.savefig(output_filename)
+    plt.close()
+
+for parameter, rows in groups:
+    rows_hopcount = df_hopcount.iloc[rows]
+    rows_etx = df_etx.iloc[rows]
+    for metric in metrics:
+        title = f"{parameter} vs {metric}"
+        filename = os.path.join(output_dir, f"{parameter}_vs_{metric}.png")
+        plot_graph(rows_hopcount, rows_etx, parameter, metric, title, filename)
+
+# Goodput summary, the throughput column counts application bytes received
+for parameter, rows in groups:
+    hopcount = df_hopcount.iloc[rows]["Throughput"].mean()
+    etx = df_etx.iloc[rows]["Throughput"].mean()
+    change = (etx - hopcount) * 100.0 / hopcount if hopcount > 0 else 0.0
+    print(f"{parameter} sweep: mean goodput {hopcount:.2f} kbps (hop count), "
+          f"{etx:.2f} kbps (ETX), {change:+.1f}%")
+
+print(f"12 graphs have been saved in the '{output_dir}' directory.")
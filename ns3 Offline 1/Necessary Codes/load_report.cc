@@ -0,0 +1,198 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Turns the forwarding load snapshots written by ns3::AodvLoadSampler into CSVs.
+ *
+ *   load_report <trace> [prefix]
+ *
+ * writes <prefix>-series.csv, one row per node and snapshot, and <prefix>-nodes.csv, one row per
+ * node sorted by forwarded packets. The prefix defaults to the trace name without extension.
+ * The program does not depend on ns-3 and builds with any C++17 compiler.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/// Per-node fields of a snapshot
+struct Sample
+{
+    double x;           ///< position, metres
+    double y;           ///< position, metres
+    uint64_t packets;   ///< data packets forwarded since the previous snapshot
+    uint64_t bytes;     ///< data bytes forwarded since the previous snapshot
+    uint64_t queue;     ///< request queue length
+    uint64_t queuePeak; ///< request queue peak length so far
+    uint64_t macDrops;  ///< MAC queue drops since the previous snapshot
+};
+
+/// Totals of a node over the trace
+struct Totals
+{
+    uint32_t id{0};        ///< node ID
+    double sumX{0};        ///< sum of the sampled x positions
+    double sumY{0};        ///< sum of the sampled y positions
+    uint64_t packets{0};   ///< forwarded data packets
+    uint64_t bytes{0};     ///< forwarded data bytes
+    uint64_t queuePeak{0}; ///< request queue peak length
+    uint64_t macDrops{0};  ///< MAC queue drops
+};
+
+/**
+ * Read an unsigned LEB128 varint
+ * \param is the input stream
+ * \param value the value read
+ * \returns false at the end of the stream or on a truncated varint
+ */
+bool
+ReadVarint(std::istream& is, uint64_t& value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        int c = is.get();
+        if (c == EOF)
+        {
+            return false;
+        }
+        value |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if (!(c & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Read a zigzag coded coordinate in decimetres
+ * \param is the input stream
+ * \param metres the coordinate in metres
+ * \returns false at the end of the stream
+ */
+bool
+ReadCoordinate(std::istream& is, double& metres)
+{
+    uint64_t v;
+    if (!ReadVarint(is, v))
+    {
+        return false;
+    }
+    int64_t dm = static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    metres = dm / 10.0;
+    return true;
+}
+
+/**
+ * Read the fields of one node in a snapshot
+ * \param is the input stream
+ * \param s the fields read
+ * \returns false at the end of the stream
+ */
+bool
+ReadSample(std::istream& is, Sample& s)
+{
+    return ReadCoordinate(is, s.x) && ReadCoordinate(is, s.y) && ReadVarint(is, s.packets) &&
+           ReadVarint(is, s.bytes) && ReadVarint(is, s.queue) && ReadVarint(is, s.queuePeak) &&
+           ReadVarint(is, s.macDrops);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <trace> [prefix]" << std::endl;
+        return 1;
+    }
+    std::string trace = argv[1];
+    std::string prefix = argc == 3 ? argv[2] : trace.substr(0, trace.rfind('.'));
+
+    std::ifstream in(trace, std::ios::binary);
+    char magic[4];
+    uint64_t version;
+    uint64_t count;
+    if (!in.read(magic, 4) || std::string(magic, 4) != "ALDS" || !ReadVarint(in, version) ||
+        version != 1 || !ReadVarint(in, count))
+    {
+        std::cerr << trace << ": not a version 1 load trace" << std::endl;
+        return 1;
+    }
+    std::vector<Totals> nodes(count);
+    for (Totals& node : nodes)
+    {
+        uint64_t id;
+        if (!ReadVarint(in, id))
+        {
+            std::cerr << trace << ": truncated header" << std::endl;
+            return 1;
+        }
+        node.id = id;
+    }
+    uint64_t intervalMs;
+    if (!ReadVarint(in, intervalMs))
+    {
+        std::cerr << trace << ": truncated header" << std::endl;
+        return 1;
+    }
+
+    std::ofstream series(prefix + "-series.csv");
+    series << "Time,Node,X,Y,ForwardedPackets,ForwardedBytes,QueueLength,QueuePeak,MacQueueDrops"
+           << std::endl;
+    uint64_t snapshots = 0;
+    uint64_t timeMs;
+    while (ReadVarint(in, timeMs))
+    {
+        for (Totals& node : nodes)
+        {
+            Sample s;
+            if (!ReadSample(in, s))
+            {
+                std::cerr << trace << ": truncated snapshot at " << timeMs / 1000.0 << " s"
+                          << std::endl;
+                return 1;
+            }
+            series << timeMs / 1000.0 << "," << node.id << "," << s.x << "," << s.y << ","
+                   << s.packets << "," << s.bytes << "," << s.queue << "," << s.queuePeak << ","
+                   << s.macDrops << std::endl;
+            node.sumX += s.x;
+            node.sumY += s.y;
+            node.packets += s.packets;
+            node.bytes += s.bytes;
+            node.queuePeak = std::max(node.queuePeak, s.queuePeak);
+            node.macDrops += s.macDrops;
+        }
+        snapshots++;
+    }
+
+    uint64_t totalPackets = 0;
+    for (const Totals& node : nodes)
+    {
+        totalPackets += node.packets;
+    }
+    std::stable_sort(nodes.begin(), nodes.end(), [](const Totals& a, const Totals& b) {
+        return a.packets > b.packets;
+    });
+    std::ofstream summary(prefix + "-nodes.csv");
+    summary << "Node,MeanX,MeanY,ForwardedPackets,ForwardedBytes,LoadShare,QueuePeak,MacQueueDrops"
+            << std::endl;
+    for (const Totals& node : nodes)
+    {
+        double share = totalPackets ? (double)node.packets / totalPackets : 0;
+        summary << node.id << "," << (snapshots ? node.sumX / snapshots : 0) << ","
+                << (snapshots ? node.sumY / snapshots : 0) << "," << node.packets << ","
+                << node.bytes << "," << share << "," << node.queuePeak << "," << node.macDrops
+                << std::endl;
+    }
+    std::cout << snapshots << " snapshots of " << nodes.size() << " nodes every " << intervalMs
+              << " ms, " << totalPackets << " forwarded packets" << std::endl;
+    return 0;
+}
@@ -43,7 +43,15 @@ class RoutingExperiment
     std::string m_protocolName{"AODV"};
     double m_txp{7.5};
     bool m_traceMobility{false};
-    bool m_flowMonitor{true};
+    // FlowMonitor probes every IP node and is only needed for its XML; the metrics of the result
+    // row come from the collector below, as in raodv_usage
+    bool m_flowMonitor{false};
+    AodvFlowCollector m_flowStats;
+    bool m_etx{false};
+    // Binary trajectory files (see AodvMobilityRecorder) to record to and to replay instead of
+    // generating random waypoint movement
+    std::string m_mobilityRecord;
+    std::string m_mobilityReplay;
 };
 
 RoutingExperiment::RoutingExperiment()
@@ -78,6 +86,7 @@ RoutingExperiment::ReceivePacket(Ptr<Socket> socket)
     {
         bytesTotal += packet->GetSize();
         packetsReceived += 1;
+        m_flowStats.Receive(packet);
         // NS_LOG_UNCOND(PrintReceivedPacket(socket, packet, senderAddress));
     }
 }
@@ -116,6 +125,15 @@ RoutingExperiment::CommandSetup(int argc, char** argv)
     cmd.AddValue("numberOfNodes", "Number of nodes", m_numberOfNodes);
     cmd.AddValue("packetsPerSecond", "Number of packets generated per second", m_packetsPerSecond);
     cmd.AddValue("nodeSpeed", "Speed of nodes in m/s", nodeSpeed);
+    cmd.AddValue("etx", "Select AODV routes by ETX instead of hop count", m_etx);
+    cmd.AddValue("CSVfileName", "The name of the CSV output file", m_CSVfileName);
+    cmd.AddValue("flowMonitor", "Also install FlowMonitor and write its XML", m_flowMonitor);
+    cmd.AddValue("mobilityRecord",
+                 "Record the node trajectories to this binary file for --mobilityReplay",
+                 m_mobilityRecord);
+    cmd.AddValue("mobilityReplay",
+                 "Move the nodes along the trajectories recorded in this file",
+                 m_mobilityReplay);
     cmd.Parse(argc, argv);
 }
 
@@ -136,8 +154,9 @@ RoutingExperiment::Run()
     if (!std::ifstream(m_CSVfileName).good())
     {
         std::ofstream out(m_CSVfileName);
-        out << "NumOfNodes,PacketsPerSec,NodeSpeed,Throughput,EndToEndDelay,PacketDeliveryRatio,"
-               "PacketDropRatio"
+        out << "Protocol,Run,NumOfNodes,PacketsPerSec,NodeSpeed,Throughput,EndToEndDelay,"
+               "PacketDeliveryRatio,PacketDropRatio,ControlFrames,ControlBytes,"
+               "NormalizedRoutingLoad,MacOverhead"
             << std::endl;
         out.close();
     }
@@ -153,6 +172,12 @@ RoutingExperiment::Run()
     Config::SetDefault("ns3::OnOffApplication::DataRate", StringValue(rate));
 
     Config::SetDefault("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue(phyMode));
+    Config::SetDefault("ns3::aodv::RoutingProtocol::EnableEtx", BooleanValue(m_etx));
+    if (m_etx)
+    {
+        // Link delivery ratios are measured from hellos
+        Config::SetDefault("ns3::aodv::RoutingProtocol::EnableHello", BooleanValue(true));
+    }
 
     NodeContainer adhocNodes;
     adhocNodes.Create(m_numberOfNodes);
@@ -177,34 +202,47 @@ RoutingExperiment::Run()
 
     wifiMac.SetType("ns3::AdhocWifiMac");
     NetDeviceContainer adhocDevices = wifi.Install(wifiPhy, wifiMac, adhocNodes);
+    AodvOverheadMonitor overhead;
+    overhead.Install(adhocDevices);
 
-    MobilityHelper mobilityAdhoc;
-    int64_t streamIndex = 0;
-
-    ObjectFactory pos;
-    pos.SetTypeId("ns3::RandomRectanglePositionAllocator");
-    pos.Set("X", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=300.0]"));
-    pos.Set("Y", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=1500.0]"));
-
-    Ptr<PositionAllocator> taPositionAlloc = pos.Create()->GetObject<PositionAllocator>();
-    streamIndex += taPositionAlloc->AssignStreams(streamIndex);
-
-    std::stringstream ssSpeed;
-    ssSpeed << "ns3::UniformRandomVariable[Min=0.0|Max=" << nodeSpeed << "]";
-    std::stringstream ssPause;
-    ssPause << "ns3::ConstantRandomVariable[Constant=" << nodePause << "]";
-    mobilityAdhoc.SetMobilityModel("ns3::RandomWaypointMobilityModel",
-                                   "Speed",
-                                   StringValue(ssSpeed.str()),
-                                   "Pause",
-                                   StringValue(ssPause.str()),
-                                   "PositionAllocator",
-                                   PointerValue(taPositionAlloc));
-    mobilityAdhoc.SetPositionAllocator(taPositionAlloc);
-    mobilityAdhoc.Install(adhocNodes);
-    streamIndex += mobilityAdhoc.AssignStreams(adhocNodes, streamIndex);
+    // A replayed trajectory draws no random numbers, so every protocol moves the same way
+    if (!m_mobilityReplay.empty())
+    {
+        AodvMobilityRecorder::Replay(m_mobilityReplay, adhocNodes);
+    }
+    else
+    {
+        MobilityHelper mobilityAdhoc;
+        int64_t streamIndex = 0;
+
+        ObjectFactory pos;
+        pos.SetTypeId("ns3::RandomRectanglePositionAllocator");
+        pos.Set("X", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=300.0]"));
+        pos.Set("Y", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=1500.0]"));
+
+        Ptr<PositionAllocator> taPositionAlloc = pos.Create()->GetObject<PositionAllocator>();
+        streamIndex += taPositionAlloc->AssignStreams(streamIndex);
+
+        std::stringstream ssSpeed;
+        ssSpeed << "ns3::UniformRandomVariable[Min=0.0|Max=" << nodeSpeed << "]";
+        std::stringstream ssPause;
+        ssPause << "ns3::ConstantRandomVariable[Constant=" << nodePause << "]";
+        mobilityAdhoc.SetMobilityModel("ns3::RandomWaypointMobilityModel",
+                                       "Speed",
+                                       StringValue(ssSpeed.str()),
+                                       "Pause",
+                                       StringValue(ssPause.str()),
+                                       "PositionAllocator",
+                                       PointerValue(taPositionAlloc));
+        mobilityAdhoc.SetPositionAllocator(taPositionAlloc);
+        mobilityAdhoc.Install(adhocNodes);
+        streamIndex += mobilityAdhoc.AssignStreams(adhocNodes, streamIndex);
+    }
 
+    // The aodv module is R-AODV; without the reverse request flood it behaves like stock AODV,
+    // which is the baseline this driver measures
     AodvHelper aodv;
+    aodv.Set("EnableReverseRequest", BooleanValue(false));
     InternetStackHelper internet;
     Ipv4ListRoutingHelper list;
     list.Add(aodv, 100);
@@ -222,6 +260,7 @@ RoutingExperiment::Run()
 
     m_nSinks = m_numberOfNodes / 2;
 
+    ApplicationContainer sources;
     for (int i = 0; i < m_nSinks; i++)
     {
         Ptr<Socket> sink = SetupPacketReceive(adhocInterfaces.GetAddress(i), adhocNodes.Get(i));
@@ -233,7 +272,9 @@ RoutingExperiment::Run()
         ApplicationContainer temp = onoff1.Install(adhocNodes.Get(i + m_nSinks));
         temp.Start(Seconds(var->GetValue(100.0, 101.0)));
         temp.Stop(Seconds(TotalTime));
+        sources.Add(temp);
     }
+    m_flowStats.Install(sources);
 
     std::stringstream ss;
     ss << m_numberOfNodes;
@@ -260,6 +301,11 @@ RoutingExperiment::Run()
     // wifiPhy.EnableAsciiAll(osw);
     AsciiTraceHelper ascii;
     MobilityHelper::EnableAsciiAll(ascii.CreateFileStream(tr_name + ".mob"));
+    AodvMobilityRecorder mobilityRecorder;
+    if (!m_mobilityRecord.empty())
+    {
+        mobilityRecorder.Start(m_mobilityRecord, adhocNodes);
+    }
 
     FlowMonitorHelper flowmonHelper;
     Ptr<FlowMonitor> flowmon;
@@ -275,45 +321,33 @@ RoutingExperiment::Run()
     Simulator::Stop(Seconds(TotalTime));
     Simulator::Run();
 
+    // The same definitions as raodv_usage, so that both CSVs plot on one axis: payload bytes and
+    // end to end delays as the applications see them, from the flow collector
+    uint64_t totalBytes = m_flowStats.GetRxBytes();
+    uint64_t totalPackets = m_flowStats.GetTxPackets();
+    uint64_t totalDroppedPackets = m_flowStats.GetLostPackets();
+    uint64_t totalReceivedPackets = m_flowStats.GetRxPackets();
+    double totalDelay = m_flowStats.GetDelaySum().GetSeconds();
+
+    double throughput = (double)(totalBytes * 8.0) / (double)((TotalTime - startTime) * 1024.0);
+    double packetDeliveryRatio = (double)(totalReceivedPackets * 100.0) / (double)totalPackets;
+    double packetDropRatio = (double)(totalDroppedPackets * 100.0) / (double)totalPackets;
+    double delay = totalDelay / (double)totalReceivedPackets;
+
+    // Write the metrics to the CSV file
+    std::ofstream out(m_CSVfileName, std::ios::app);
+    out << m_protocolName << "," << RngSeedManager::GetRun() << "," << m_numberOfNodes << ","
+        << m_packetsPerSecond << "," << nodeSpeed << "," << throughput << "," << delay << ","
+        << packetDeliveryRatio << "," << packetDropRatio << ",";
+    // Control frames per delivered data packet, and control bytes per delivered data byte
+    out << overhead.GetControlFrames() << "," << overhead.GetControlBytes() << ","
+        << (double)overhead.GetControlFrames() / (double)totalReceivedPackets << ","
+        << (double)overhead.GetControlBytes() / (double)totalBytes << std::endl;
+    out.close();
+
     if (m_flowMonitor)
     {
         flowmon->CheckForLostPackets();
-        FlowMonitor::FlowStatsContainer stats = flowmon->GetFlowStats();
-
-        double throughput = 0.0;
-        double delay = 0.0;
-        double packetDeliveryRatio = 0.0;
-        double packetDropRatio = 0.0;
-
-        // Iterate over flow stats to extract the necessary metrics
-        uint64_t totalBytes = 0;
-        uint64_t totalPackets = 0;
-        uint64_t totalDroppedPackets = 0;
-        uint64_t totalReceivedPackets = 0;
-        double totalDelay = 0;
-
-        for (const auto &entry : stats)
-        {
-            FlowMonitor::FlowStats flowStats = entry.second;
-            //throughput += (flowStats.rxBytes * 8.0)/(flowStats. timeLastRxPacket.GetSeconds() - flowStats.timeFirstTxPacket.GetSeconds()) / 1000; // kbps
-            totalBytes += flowStats.rxBytes;
-            totalPackets += flowStats.txPackets;
-            totalDroppedPackets += flowStats.lostPackets;
-            totalReceivedPackets += flowStats.rxPackets;
-            totalDelay += flowStats.delaySum.GetSeconds();
-        }
-
-        double simulationTimeInSeconds = Simulator::Now().GetSeconds();
-        throughput = (double)(totalBytes * 8.0) /(double)((TotalTime - startTime) *1024.0);// kbps
-        packetDeliveryRatio = (double)((totalReceivedPackets * 1.0) * 100.0) / (double)totalPackets;
-        packetDropRatio = (double)((totalDroppedPackets * 1.0) * 100.0 )/ (double)totalPackets;
-        delay = totalDelay / (double)totalReceivedPackets;
-
-        // Write the metrics to the CSV file
-        std::ofstream out(m_CSVfileName, std::ios::app);
-        out << m_numberOfNodes << "," << m_packetsPerSecond << "," << nodeSpeed << "," << throughput
-            << "," << delay << "," << packetDeliveryRatio << "," << packetDropRatio << std::endl;
-        out.close();
         flowmon->SerializeToXmlFile(tr_name + ".flowmon", false, false);
     }
 
@@ -0,0 +1,118 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Turns the course changes ns3::AodvMobilityRecorder writes into a CSV.
+ *
+ *   mobility_report <trace> [csv]
+ *
+ * writes one row per course change with the time, node, position and velocity. The CSV name
+ * defaults to the trace name with its extension replaced by .csv. The program does not depend
+ * on ns-3 and builds with any C++17 compiler.
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+/**
+ * Read an unsigned LEB128 varint
+ * \param is the input stream
+ * \param value the value read
+ * \returns false at the end of the stream or on a truncated varint
+ */
+bool
+ReadVarint(std::istream& is, uint64_t& value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        int c = is.get();
+        if (c == EOF)
+        {
+            return false;
+        }
+        value |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if (!(c & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Read a zigzag coded value in thousandths
+ * \param is the input stream
+ * \param value the value
+ * \returns false at the end of the stream
+ */
+bool
+ReadMilli(std::istream& is, double& value)
+{
+    uint64_t v;
+    if (!ReadVarint(is, v))
+    {
+        return false;
+    }
+    int64_t milli = static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    value = milli / 1000.0;
+    return true;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <trace> [csv]" << std::endl;
+        return 1;
+    }
+    std::string trace = argv[1];
+    std::string csv = argc == 3 ? argv[2] : trace.substr(0, trace.rfind('.')) + ".csv";
+
+    std::ifstream in(trace, std::ios::binary);
+    char magic[4];
+    uint64_t version;
+    if (!in.read(magic, 4) || std::string(magic, 4) != "AMOB" || !ReadVarint(in, version) ||
+        version != 1)
+    {
+        std::cerr << trace << ": not a version 1 mobility trace" << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(csv);
+    // Microsecond times need more than the default 6 significant digits
+    out.precision(12);
+    out << "Time,Node,X,Y,Z,VX,VY,VZ" << std::endl;
+    uint64_t records = 0;
+    uint64_t timeUs = 0;
+    uint64_t delta;
+    while (ReadVarint(in, delta))
+    {
+        timeUs += delta;
+        uint64_t node;
+        double v[6];
+        if (!ReadVarint(in, node) || !ReadMilli(in, v[0]) || !ReadMilli(in, v[1]) ||
+            !ReadMilli(in, v[2]) || !ReadMilli(in, v[3]) || !ReadMilli(in, v[4]) ||
+            !ReadMilli(in, v[5]))
+        {
+            std::cerr << trace << ": truncated record at " << timeUs / 1e6 << " s" << std::endl;
+            return 1;
+        }
+        out << timeUs / 1e6 << "," << node;
+        for (double value : v)
+        {
+            out << "," << value;
+        }
+        out << std::endl;
+        records++;
+    }
+    std::cout << records << " course changes written to " << csv << std::endl;
+    return 0;
+}
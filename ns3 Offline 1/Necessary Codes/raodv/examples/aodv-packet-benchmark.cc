@@ -0,0 +1,570 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Serialization benchmark and round-trip fuzzer for the AODV control headers.
+ */
+
+#include "ns3/aodv-module.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace ns3;
+using namespace ns3::aodv;
+
+/**
+ * \ingroup aodv-examples
+ * \ingroup examples
+ * \brief AODV header microbenchmark and fuzzer.
+ *
+ * The benchmark reports the nanoseconds one Serialize, one Deserialize and one
+ * Packet::AddHeader / Packet::RemoveHeader cycle take for every AODV header, in the sizes that
+ * occur in practice, RERR with the maximum of 255 destinations included. For requests it also
+ * times the receive path: dropping a duplicate and decoding plus rebuilding a forwarded request,
+ * once by removing the headers from the packet and once through RequestView.
+ *
+ * The fuzzer builds headers with random values over the full range of every field, both RREQ
+ * encodings and all extensions included, sends them through a packet behind their TypeHeader
+ * and checks that they come back equal and with the advertised size. Requests are checked
+ * against RequestView as well. The program exits with 1 if any round trip failed.
+ *
+ * ./ns3 run "aodv-packet-benchmark --iterations=1000000 --fuzzRuns=100000"
+ */
+class PacketBenchmark
+{
+  public:
+    PacketBenchmark();
+    /**
+     * \brief Configure script parameters
+     * \param argc is the command line argument count
+     * \param argv is the command line arguments
+     * \return true on successful configuration
+     */
+    bool Configure(int argc, char** argv);
+    /// Run benchmark and fuzzer
+    void Run();
+    /**
+     * Report results
+     * \param os the output stream
+     * \return true if every round trip succeeded
+     */
+    bool Report(std::ostream& os);
+
+  private:
+    // parameters
+    /// Iterations per benchmarked operation
+    uint32_t iterations;
+    /// Random headers per header type
+    uint32_t fuzzRuns;
+    /// Seed of the fuzzer
+    uint32_t seed;
+
+    /// Random variable of the fuzzer
+    Ptr<UniformRandomVariable> m_rng;
+    /// Sum of results, keeps the benchmarked calls from being optimized away
+    uint64_t m_checksum;
+    /// Number of round trips per header type
+    std::map<std::string, uint32_t> m_runs;
+    /// Number of failed round trips per header type
+    std::map<std::string, uint32_t> m_failures;
+
+  private:
+    /// Benchmark every header
+    void Benchmark();
+    /**
+     * Benchmark one header
+     * \param name the row label
+     * \param header the header, also the prototype of the deserialization target
+     */
+    template <class T>
+    void BenchmarkHeader(const std::string& name, const T& header);
+    /**
+     * Benchmark the receive path of a request
+     * \param name the row label
+     * \param header the RREQ or REV_RREQ
+     * \param type the message type of header
+     */
+    template <class T>
+    void BenchmarkReceive(const std::string& name, const T& header, MessageType type);
+    /// Fuzz every header
+    void Fuzz();
+    /**
+     * Send a header through a packet and compare it with the result
+     * \param name the header type label
+     * \param header the header
+     * \param received empty header prepared for the encoding of header
+     * \param type the message type of header
+     * \return true on success
+     */
+    template <class T>
+    bool RoundTrip(const std::string& name, const T& header, T received, MessageType type);
+    /**
+     * Check RequestView against a RREQ or REV_RREQ
+     * \param header the header
+     * \param type the message type of header
+     * \return true if the view reads the fields of header
+     */
+    template <class T>
+    bool CheckView(const T& header, MessageType type);
+    /// \return a random RREQ in either encoding
+    RreqHeader RandomRequest();
+    /// \return a random REV_RREQ in either encoding
+    RrevreqHeader RandomRevRequest();
+    /// \return a random RREP
+    RrepHeader RandomReply();
+    /**
+     * \param count the number of destinations
+     * \return a random RERR
+     */
+    RerrHeader RandomError(uint32_t count);
+    /// \return a random 32-bit value
+    uint32_t RandomU32();
+    /// \return a random 32-bit value of random bit length, covering every varint size
+    uint32_t RandomVarintValue();
+    /// \return true with probability 1/2
+    bool RandomBool();
+};
+
+int
+main(int argc, char** argv)
+{
+    PacketBenchmark test;
+    if (!test.Configure(argc, argv))
+    {
+        NS_FATAL_ERROR("Configuration failed. Aborted.");
+    }
+
+    test.Run();
+    return test.Report(std::cout) ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+PacketBenchmark::PacketBenchmark()
+    : iterations(100000),
+      fuzzRuns(10000),
+      seed(12345),
+      m_checksum(0)
+{
+}
+
+bool
+PacketBenchmark::Configure(int argc, char** argv)
+{
+    CommandLine cmd(__FILE__);
+
+    cmd.AddValue("iterations", "Iterations per benchmarked operation.", iterations);
+    cmd.AddValue("fuzzRuns", "Random headers per header type, 0 skips fuzzing.", fuzzRuns);
+    cmd.AddValue("seed", "Seed of the fuzzer.", seed);
+
+    cmd.Parse(argc, argv);
+    SeedManager::SetSeed(seed);
+    m_rng = CreateObject<UniformRandomVariable>();
+    return iterations > 0;
+}
+
+void
+PacketBenchmark::Run()
+{
+    Benchmark();
+    Fuzz();
+}
+
+bool
+PacketBenchmark::Report(std::ostream& os)
+{
+    bool ok = true;
+    for (auto i = m_runs.begin(); i != m_runs.end(); ++i)
+    {
+        uint32_t failures = m_failures[i->first];
+        os << std::setw(24) << std::left << i->first << i->second << " round trips, " << failures
+           << " failed\n";
+        ok = ok && failures == 0;
+    }
+    os << "checksum " << m_checksum << "\n";
+    return ok;
+}
+
+void
+PacketBenchmark::Benchmark()
+{
+    std::cout << std::setw(24) << std::left << "header" << std::setw(8) << std::right << "bytes"
+              << std::setw(16) << "serialize ns" << std::setw(16) << "deserialize ns"
+              << std::setw(16) << "add/remove ns" << "\n";
+
+    BenchmarkHeader("TypeHeader", TypeHeader(AODVTYPE_RREQ));
+
+    RreqHeader rreq(0,
+                    0,
+                    3,
+                    4711,
+                    Ipv4Address("10.1.1.20"),
+                    0,
+                    Ipv4Address("10.1.1.1"),
+                    58);
+    rreq.SetUnknownSeqno(true);
+    BenchmarkHeader("RreqHeader", rreq);
+    rreq.SetCompact(true);
+    BenchmarkHeader("RreqHeader compact", rreq);
+    rreq.SetCompact(false);
+    for (uint32_t k = 0; k < 8; ++k)
+    {
+        rreq.AddDestination(Ipv4Address(0x0a010115 + k), k);
+    }
+    rreq.SetPathEtx(250);
+    BenchmarkHeader("RreqHeader M=8 E", rreq);
+
+    RrevreqHeader revreq(0,
+                         0,
+                         3,
+                         4712,
+                         Ipv4Address("10.1.1.1"),
+                         58,
+                         Ipv4Address("10.1.1.20"),
+                         17);
+    BenchmarkHeader("RrevreqHeader", revreq);
+    revreq.SetCompact(true);
+    BenchmarkHeader("RrevreqHeader compact", revreq);
+
+    RrepHeader rrep(0,
+                    2,
+                    Ipv4Address("10.1.1.20"),
+                    17,
+                    Ipv4Address("10.1.1.1"),
+                    Seconds(3));
+    BenchmarkHeader("RrepHeader", rrep);
+    BenchmarkHeader("RrepAckHeader", RrepAckHeader());
+
+    RerrHeader rerr;
+    rerr.AddUnDestination(Ipv4Address("10.1.1.20"), 18);
+    BenchmarkHeader("RerrHeader 1", rerr);
+    for (uint32_t k = 1; rerr.AddUnDestination(Ipv4Address(0x0a010200 + k), k); ++k)
+    {
+    }
+    BenchmarkHeader("RerrHeader 255", rerr);
+
+    std::cout << "\n"
+              << std::setw(24) << std::left << "request" << std::setw(16) << std::right
+              << "dup packet ns" << std::setw(16) << "dup view ns" << std::setw(16)
+              << "fwd packet ns" << std::setw(16) << "fwd view ns" << "\n";
+    rreq = RreqHeader(0,
+                      0,
+                      3,
+                      4711,
+                      Ipv4Address("10.1.1.20"),
+                      0,
+                      Ipv4Address("10.1.1.1"),
+                      58);
+    rreq.SetUnknownSeqno(true);
+    BenchmarkReceive("RreqHeader", rreq, AODVTYPE_RREQ);
+    rreq.SetCompact(true);
+    BenchmarkReceive("RreqHeader compact", rreq, AODVTYPE_RREQ_COMPACT);
+    rreq.SetCompact(false);
+    for (uint32_t k = 0; k < 8; ++k)
+    {
+        rreq.AddDestination(Ipv4Address(0x0a010115 + k), k);
+    }
+    rreq.SetPathEtx(250);
+    BenchmarkReceive("RreqHeader M=8 E", rreq, AODVTYPE_RREQ);
+    revreq.SetCompact(false);
+    BenchmarkReceive("RrevreqHeader", revreq, AODVTYPE_REV_RREQ);
+}
+
+template <class T>
+void
+PacketBenchmark::BenchmarkHeader(const std::string& name, const T& header)
+{
+    using Clock = std::chrono::steady_clock;
+
+    Buffer buffer;
+    buffer.AddAtStart(header.GetSerializedSize());
+
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        header.Serialize(buffer.Begin());
+    }
+    double serializeNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    T target = header;
+    start = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        m_checksum += target.Deserialize(buffer.Begin());
+    }
+    double deserializeNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    Ptr<Packet> packet = Create<Packet>();
+    start = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        packet->AddHeader(header);
+        m_checksum += packet->RemoveHeader(target);
+    }
+    double cycleNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    std::cout << std::setw(24) << std::left << name << std::setw(8) << std::right
+              << header.GetSerializedSize() << std::fixed << std::setprecision(1)
+              << std::setw(16) << serializeNs / iterations << std::setw(16)
+              << deserializeNs / iterations << std::setw(16) << cycleNs / iterations << "\n";
+}
+
+template <class T>
+void
+PacketBenchmark::BenchmarkReceive(const std::string& name, const T& header, MessageType type)
+{
+    using Clock = std::chrono::steady_clock;
+
+    Ptr<Packet> received = Create<Packet>();
+    received->AddHeader(header);
+    received->AddHeader(TypeHeader(type));
+    T prototype;
+    prototype.SetCompact(header.IsCompact());
+
+    // Duplicate: only the request ID and the originator are needed
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        Ptr<Packet> p = received->Copy();
+        TypeHeader tHeader;
+        p->RemoveHeader(tHeader);
+        T target = prototype;
+        p->RemoveHeader(target);
+        m_checksum += target.GetId() + target.GetOrigin().Get();
+    }
+    double dupPacketNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        RequestView view(received);
+        m_checksum += view.GetId() + view.GetOrigin().Get();
+    }
+    double dupViewNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    // New request: decode it, bump the hop count and build the rebroadcast
+    start = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        Ptr<Packet> p = received->Copy();
+        TypeHeader tHeader;
+        p->RemoveHeader(tHeader);
+        T target = prototype;
+        p->RemoveHeader(target);
+        target.SetHopCount(target.GetHopCount() + 1);
+        Ptr<Packet> message = Create<Packet>();
+        message->AddHeader(target);
+        message->AddHeader(tHeader);
+        m_checksum += message->GetSize();
+    }
+    double fwdPacketNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        RequestView view(received);
+        T target;
+        view.Deserialize(target);
+        view.SetHopCount(target.GetHopCount() + 1);
+        m_checksum += view.CreatePacket()->GetSize();
+    }
+    double fwdViewNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    std::cout << std::setw(24) << std::left << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(16) << dupPacketNs / iterations
+              << std::setw(16) << dupViewNs / iterations << std::setw(16)
+              << fwdPacketNs / iterations << std::setw(16) << fwdViewNs / iterations << "\n";
+}
+
+void
+PacketBenchmark::Fuzz()
+{
+    for (uint32_t run = 0; run < fuzzRuns; ++run)
+    {
+        RreqHeader rreq = RandomRequest();
+        RreqHeader rreqTarget;
+        rreqTarget.SetCompact(rreq.IsCompact());
+        MessageType type = rreq.IsCompact() ? AODVTYPE_RREQ_COMPACT : AODVTYPE_RREQ;
+        if (!RoundTrip("RreqHeader", rreq, rreqTarget, type) || !CheckView(rreq, type))
+        {
+            m_failures["RreqHeader"]++;
+        }
+
+        RrevreqHeader revreq = RandomRevRequest();
+        RrevreqHeader revreqTarget;
+        revreqTarget.SetCompact(revreq.IsCompact());
+        type = revreq.IsCompact() ? AODVTYPE_REV_RREQ_COMPACT : AODVTYPE_REV_RREQ;
+        if (!RoundTrip("RrevreqHeader", revreq, revreqTarget, type) || !CheckView(revreq, type))
+        {
+            m_failures["RrevreqHeader"]++;
+        }
+
+        if (!RoundTrip("RrepHeader", RandomReply(), RrepHeader(), AODVTYPE_RREP))
+        {
+            m_failures["RrepHeader"]++;
+        }
+
+        if (!RoundTrip("RrepAckHeader", RrepAckHeader(), RrepAckHeader(), AODVTYPE_RREP_ACK))
+        {
+            m_failures["RrepAckHeader"]++;
+        }
+
+        // Every fourth RERR is full, the others have a random number of destinations
+        uint32_t count = (run % 4 == 0) ? 255 : m_rng->GetInteger(0, 255);
+        if (!RoundTrip("RerrHeader", RandomError(count), RerrHeader(), AODVTYPE_RERR))
+        {
+            m_failures["RerrHeader"]++;
+        }
+    }
+
+    // A full RERR refuses further destinations instead of overflowing its count
+    if (fuzzRuns > 0)
+    {
+        RerrHeader rerr = RandomError(255);
+        m_runs["RerrHeader limit"]++;
+        if (rerr.GetDestCount() != 255 || rerr.AddUnDestination(Ipv4Address("1.1.1.1"), 1))
+        {
+            m_failures["RerrHeader limit"]++;
+        }
+    }
+}
+
+template <class T>
+bool
+PacketBenchmark::RoundTrip(const std::string& name, const T& header, T received, MessageType type)
+{
+    m_runs[name]++;
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(header);
+    packet->AddHeader(TypeHeader(type));
+    if (packet->GetSize() != header.GetSerializedSize() + 1)
+    {
+        return false;
+    }
+    TypeHeader typeHeader;
+    packet->RemoveHeader(typeHeader);
+    if (!typeHeader.IsValid() || typeHeader.Get() != type)
+    {
+        return false;
+    }
+    uint32_t bytes = packet->RemoveHeader(received);
+    return bytes == header.GetSerializedSize() && packet->GetSize() == 0 && received == header;
+}
+
+template <class T>
+bool
+PacketBenchmark::CheckView(const T& header, MessageType type)
+{
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(header);
+    packet->AddHeader(TypeHeader(type));
+    RequestView view(packet);
+    T decoded;
+    return view.IsValid() && view.GetType() == type &&
+           view.GetHopCount() == header.GetHopCount() && view.GetId() == header.GetId() &&
+           view.GetDst() == header.GetDst() && view.GetDstSeqno() == header.GetDstSeqno() &&
+           view.GetOrigin() == header.GetOrigin() && view.GetPathEtx() == header.GetPathEtx() &&
+           view.GetCompactSavings() == header.GetCompactSavings() && view.Deserialize(decoded) &&
+           decoded == header;
+}
+
+RreqHeader
+PacketBenchmark::RandomRequest()
+{
+    bool compact = RandomBool();
+    // All flag bits are random, M and E without extension data included
+    uint8_t flags = m_rng->GetInteger(0, 255);
+    bool unknownSeqNo = flags & (1 << 3);
+    RreqHeader h(flags,
+                 compact ? 0 : m_rng->GetInteger(0, 255),
+                 m_rng->GetInteger(0, 255),
+                 RandomVarintValue(),
+                 Ipv4Address(RandomU32()),
+                 (compact && unknownSeqNo) ? 0 : RandomVarintValue(),
+                 Ipv4Address(RandomU32()),
+                 RandomVarintValue());
+    h.SetCompact(compact);
+    if (RandomBool())
+    {
+        uint32_t count = RandomBool() ? 255 : m_rng->GetInteger(0, 255);
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            h.AddDestination(Ipv4Address(RandomU32()), RandomU32(), RandomBool());
+        }
+    }
+    if (RandomBool())
+    {
+        h.SetPathEtx(m_rng->GetInteger(0, 65535));
+    }
+    return h;
+}
+
+RrevreqHeader
+PacketBenchmark::RandomRevRequest()
+{
+    bool compact = RandomBool();
+    uint8_t flags = m_rng->GetInteger(0, 255);
+    bool unknownSeqNo = flags & (1 << 3);
+    RrevreqHeader h(flags,
+                    compact ? 0 : m_rng->GetInteger(0, 255),
+                    m_rng->GetInteger(0, 255),
+                    RandomVarintValue(),
+                    Ipv4Address(RandomU32()),
+                    (compact && unknownSeqNo) ? 0 : RandomVarintValue(),
+                    Ipv4Address(RandomU32()),
+                    RandomVarintValue());
+    h.SetCompact(compact);
+    if (RandomBool())
+    {
+        h.SetPathEtx(m_rng->GetInteger(0, 65535));
+    }
+    return h;
+}
+
+RrepHeader
+PacketBenchmark::RandomReply()
+{
+    RrepHeader h(m_rng->GetInteger(0, 255),
+                 m_rng->GetInteger(0, 255),
+                 Ipv4Address(RandomU32()),
+                 RandomU32(),
+                 Ipv4Address(RandomU32()),
+                 MilliSeconds(RandomU32()));
+    h.SetAckRequired(RandomBool());
+    return h;
+}
+
+RerrHeader
+PacketBenchmark::RandomError(uint32_t count)
+{
+    RerrHeader h;
+    h.SetNoDelete(RandomBool());
+    // Consecutive addresses keep the destinations distinct
+    uint32_t base = RandomU32();
+    for (uint32_t k = 0; k < count; ++k)
+    {
+        h.AddUnDestination(Ipv4Address(base + k), RandomU32());
+    }
+    return h;
+}
+
+uint32_t
+PacketBenchmark::RandomU32()
+{
+    return m_rng->GetInteger(0, 0xffffffff);
+}
+
+uint32_t
+PacketBenchmark::RandomVarintValue()
+{
+    uint32_t bits = m_rng->GetInteger(0, 32);
+    return bits == 0 ? 0 : RandomU32() >> (32 - bits);
+}
+
+bool
+PacketBenchmark::RandomBool()
+{
+    return m_rng->GetInteger(0, 1) == 1;
+}
@@ -0,0 +1,290 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Streaming per-flow delivery, delay and jitter statistics of application traffic.
+ */
+
+#include "aodv-flow-collector.h"
+
+#include "ns3/abort.h"
+#include "ns3/application.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/tag.h"
+
+#include <cstdlib>
+
+namespace ns3
+{
+
+/**
+ * \ingroup aodv
+ * \brief Flow, sequence number and send time of a packet measured by AodvFlowCollector
+ */
+class AodvFlowTag : public Tag
+{
+  public:
+    /**
+     * \brief Constructor
+     * \param flow the flow index
+     * \param seq the sequence number
+     * \param sent the send time
+     */
+    AodvFlowTag(uint32_t flow = 0, uint32_t seq = 0, Time sent = Time())
+        : Tag(),
+          m_flow(flow),
+          m_seq(seq),
+          m_sent(sent)
+    {
+    }
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::AodvFlowTag")
+                                .SetParent<Tag>()
+                                .SetGroupName("Aodv")
+                                .AddConstructor<AodvFlowTag>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return GetTypeId();
+    }
+
+    /**
+     * \returns the flow index
+     */
+    uint32_t GetFlow() const
+    {
+        return m_flow;
+    }
+
+    /**
+     * \returns the sequence number
+     */
+    uint32_t GetSeq() const
+    {
+        return m_seq;
+    }
+
+    /**
+     * \returns the send time
+     */
+    Time GetSent() const
+    {
+        return m_sent;
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return 2 * sizeof(uint32_t) + sizeof(int64_t);
+    }
+
+    void Serialize(TagBuffer i) const override
+    {
+        i.WriteU32(m_flow);
+        i.WriteU32(m_seq);
+        i.WriteU64(m_sent.GetTimeStep());
+    }
+
+    void Deserialize(TagBuffer i) override
+    {
+        m_flow = i.ReadU32();
+        m_seq = i.ReadU32();
+        m_sent = TimeStep(i.ReadU64());
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "AodvFlowTag: flow = " << m_flow << ", seq = " << m_seq << ", sent = " << m_sent;
+    }
+
+  private:
+    uint32_t m_flow; ///< Flow index
+    uint32_t m_seq;  ///< Sequence number
+    Time m_sent;     ///< Send time
+};
+
+NS_OBJECT_ENSURE_REGISTERED(AodvFlowTag);
+
+void
+AodvFlowCollector::Install(ApplicationContainer sources)
+{
+    for (auto i = sources.Begin(); i != sources.End(); ++i)
+    {
+        uint32_t flow = m_flows.size();
+        m_flows.push_back(Flow());
+        m_flows.back().node = (*i)->GetNode()->GetId();
+        bool ok = (*i)->TraceConnectWithoutContext(
+            "Tx",
+            MakeCallback(&AodvFlowCollector::Tx, this).Bind(flow));
+        NS_ABORT_MSG_UNLESS(ok, "Application " << (*i)->GetInstanceTypeId() << " has no Tx trace");
+    }
+}
+
+void
+AodvFlowCollector::Tx(uint32_t flow, Ptr<const Packet> packet)
+{
+    packet->AddPacketTag(AodvFlowTag(flow, m_flows[flow].nextSeq++, Simulator::Now()));
+}
+
+void
+AodvFlowCollector::Receive(Ptr<const Packet> packet)
+{
+    AodvFlowTag tag;
+    if (!packet->PeekPacketTag(tag) || tag.GetFlow() >= m_flows.size())
+    {
+        m_untagged++;
+        return;
+    }
+    Flow& flow = m_flows[tag.GetFlow()];
+    uint32_t seq = tag.GetSeq();
+    if (flow.rxPackets == 0 || seq > flow.highest)
+    {
+        uint32_t shift = flow.rxPackets == 0 ? WINDOW : seq - flow.highest;
+        flow.window = (shift >= WINDOW ? 0 : flow.window << shift) | 1;
+        flow.highest = seq;
+    }
+    else
+    {
+        // Older than the window: assume it is not a duplicate
+        uint32_t age = flow.highest - seq;
+        if (age < WINDOW)
+        {
+            if (flow.window & (uint64_t(1) << age))
+            {
+                flow.duplicates++;
+                return;
+            }
+            flow.window |= uint64_t(1) << age;
+        }
+        flow.reordered++;
+    }
+
+    int64_t delay = (Simulator::Now() - tag.GetSent()).GetNanoSeconds();
+    if (flow.rxPackets > 0)
+    {
+        flow.jitterSum += std::llabs(delay - flow.lastDelay);
+    }
+    flow.lastDelay = delay;
+    flow.delaySum += delay;
+    flow.delays.Add(delay / 1000);
+    flow.rxPackets++;
+    flow.rxBytes += packet->GetSize();
+}
+
+uint64_t
+AodvFlowCollector::GetLost(const Flow& flow)
+{
+    return flow.nextSeq > flow.rxPackets ? flow.nextSeq - flow.rxPackets : 0;
+}
+
+uint64_t
+AodvFlowCollector::GetTxPackets() const
+{
+    uint64_t packets = 0;
+    for (const Flow& flow : m_flows)
+    {
+        packets += flow.nextSeq;
+    }
+    return packets;
+}
+
+uint64_t
+AodvFlowCollector::GetRxPackets() const
+{
+    uint64_t packets = 0;
+    for (const Flow& flow : m_flows)
+    {
+        packets += flow.rxPackets;
+    }
+    return packets;
+}
+
+uint64_t
+AodvFlowCollector::GetRxBytes() const
+{
+    uint64_t bytes = 0;
+    for (const Flow& flow : m_flows)
+    {
+        bytes += flow.rxBytes;
+    }
+    return bytes;
+}
+
+uint64_t
+AodvFlowCollector::GetLostPackets() const
+{
+    uint64_t packets = 0;
+    for (const Flow& flow : m_flows)
+    {
+        packets += GetLost(flow);
+    }
+    return packets;
+}
+
+Time
+AodvFlowCollector::GetDelaySum() const
+{
+    int64_t sum = 0;
+    for (const Flow& flow : m_flows)
+    {
+        sum += flow.delaySum;
+    }
+    return NanoSeconds(sum);
+}
+
+Time
+AodvFlowCollector::GetMeanJitter() const
+{
+    int64_t sum = 0;
+    uint64_t pairs = 0;
+    for (const Flow& flow : m_flows)
+    {
+        sum += flow.jitterSum;
+        pairs += flow.rxPackets > 0 ? flow.rxPackets - 1 : 0;
+    }
+    return NanoSeconds(pairs ? sum / (int64_t)pairs : 0);
+}
+
+Time
+AodvFlowCollector::GetDelayQuantile(double q) const
+{
+    aodv::LogHistogram delays;
+    for (const Flow& flow : m_flows)
+    {
+        delays.Merge(flow.delays);
+    }
+    return MicroSeconds(delays.GetQuantile(q));
+}
+
+std::string
+AodvFlowCollector::GetFlowHeader()
+{
+    return "Flow,Source,TxPackets,RxPackets,RxBytes,LostPackets,Duplicates,Reordered,"
+           "DeliveryRatio,MeanDelay,DelayP50,DelayP95,DelayP99,Jitter";
+}
+
+void
+AodvFlowCollector::WriteFlows(std::ostream& os, const std::string& prefix) const
+{
+    for (uint32_t i = 0; i < m_flows.size(); ++i)
+    {
+        const Flow& flow = m_flows[i];
+        double rx = flow.rxPackets;
+        os << prefix << i << "," << flow.node << "," << flow.nextSeq << "," << flow.rxPackets
+           << "," << flow.rxBytes << "," << GetLost(flow) << "," << flow.duplicates << ","
+           << flow.reordered << "," << (flow.nextSeq ? rx / flow.nextSeq : 0) << ","
+           << (rx ? flow.delaySum / rx / 1e9 : 0) << ","
+           << flow.delays.GetQuantile(0.5) / 1e6 << "," << flow.delays.GetQuantile(0.95) / 1e6
+           << "," << flow.delays.GetQuantile(0.99) / 1e6 << ","
+           << (rx > 1 ? flow.jitterSum / (rx - 1) / 1e9 : 0) << std::endl;
+    }
+}
+
+} // namespace ns3
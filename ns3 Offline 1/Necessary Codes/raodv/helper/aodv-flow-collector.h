@@ -0,0 +1,138 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Streaming per-flow delivery, delay and jitter statistics of application traffic.
+ */
+
+#ifndef AODV_FLOW_COLLECTOR_H
+#define AODV_FLOW_COLLECTOR_H
+
+#include "ns3/aodv-histogram.h"
+#include "ns3/application-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+/**
+ * \ingroup aodv
+ * \brief Measures application flows end to end while they run, in fixed memory per flow.
+ *
+ * Every packet a source application sends is tagged with its flow, a sequence number and its
+ * send time; the receiving sink hands it to Receive. Delivery, duplicates, mean delay, delay
+ * quantiles and jitter are updated on the spot, so nothing is stored per packet and no probe
+ * runs on the nodes in between. Duplicates are detected within the last WINDOW sequence numbers
+ * of a flow; a packet still in flight when the statistics are read counts as lost.
+ *
+ * Sources must have a "Tx" trace source with the signature of OnOffApplication's. The collector
+ * does not depend on the routing protocol.
+ */
+class AodvFlowCollector
+{
+  public:
+    /// Number of sequence numbers below the highest one received for which duplicates are caught
+    static const uint32_t WINDOW = 64;
+
+    /**
+     * Tag the packets sent by every application in the container, each application one flow
+     * \param sources the source applications
+     */
+    void Install(ApplicationContainer sources);
+    /**
+     * Count a packet received by a sink. Packets without a flow tag are only counted as untagged.
+     * \param packet the received packet
+     */
+    void Receive(Ptr<const Packet> packet);
+
+    /**
+     * \returns the number of packets sent by all flows
+     */
+    uint64_t GetTxPackets() const;
+    /**
+     * \returns the number of distinct packets received from all flows
+     */
+    uint64_t GetRxPackets() const;
+    /**
+     * \returns the payload bytes of the distinct packets received from all flows
+     */
+    uint64_t GetRxBytes() const;
+    /**
+     * \returns the number of packets sent but not received, in flight ones included
+     */
+    uint64_t GetLostPackets() const;
+    /**
+     * \returns the sum of the delays of the received packets
+     */
+    Time GetDelaySum() const;
+    /**
+     * \returns the mean absolute difference between the delays of consecutively received packets
+     *          of a flow, over all flows
+     */
+    Time GetMeanJitter() const;
+    /**
+     * \param q the quantile, in [0, 1]
+     * \returns the delay quantile over all flows, within the relative error of aodv::LogHistogram
+     */
+    Time GetDelayQuantile(double q) const;
+    /**
+     * \returns the number of received packets without a flow tag
+     */
+    uint64_t GetUntagged() const
+    {
+        return m_untagged;
+    }
+
+    /**
+     * \returns the comma separated column names written by WriteFlows
+     */
+    static std::string GetFlowHeader();
+    /**
+     * Write one CSV row per flow: the prefix, then the columns of GetFlowHeader. Times are in
+     * seconds.
+     *
+     * \param os the output stream
+     * \param prefix text written at the start of every row, e.g. the scenario parameters
+     */
+    void WriteFlows(std::ostream& os, const std::string& prefix = "") const;
+
+  private:
+    /// Running statistics of a flow
+    struct Flow
+    {
+        uint32_t node{0};          ///< ID of the source node
+        uint32_t nextSeq{0};       ///< sequence number of the next packet sent
+        uint64_t rxPackets{0};     ///< distinct packets received
+        uint64_t rxBytes{0};       ///< payload bytes of the distinct packets received
+        uint64_t duplicates{0};    ///< duplicate packets received
+        uint64_t reordered{0};     ///< packets received after a higher sequence number
+        int64_t delaySum{0};       ///< sum of the delays, ns
+        int64_t jitterSum{0};      ///< sum of the delay differences, ns
+        int64_t lastDelay{0};      ///< delay of the previous packet received, ns
+        uint32_t highest{0};       ///< highest sequence number received
+        uint64_t window{0};        ///< bit i set if highest - i was received
+        aodv::LogHistogram delays; ///< delays, us
+    };
+
+    /**
+     * Tag a packet a source sends
+     * \param flow the flow index
+     * \param packet the packet
+     */
+    void Tx(uint32_t flow, Ptr<const Packet> packet);
+    /**
+     * \param flow a flow
+     * \returns the packets of the flow sent but not received
+     */
+    static uint64_t GetLost(const Flow& flow);
+
+    std::vector<Flow> m_flows; ///< Flows, by index
+    uint64_t m_untagged{0};    ///< Received packets without a flow tag
+};
+
+} // namespace ns3
+
+#endif /* AODV_FLOW_COLLECTOR_H */
@@ -13,10 +13,44 @@
 #include "ns3/names.h"
 #include "ns3/node-list.h"
 #include "ns3/ptr.h"
+#include "ns3/uinteger.h"
+
+#include <iterator>
 
 namespace ns3
 {
 
+namespace
+{
+/// Read-only attributes of ns3::aodv::RoutingProtocol written by AodvHelper::WriteCounters
+const char* const AODV_COUNTERS[] = {
+    "RreqSent",
+    "RreqReceived",
+    "RreqForwarded",
+    "RevRreqSent",
+    "RevRreqReceived",
+    "RevRreqForwarded",
+    "RrepSent",
+    "RrepReceived",
+    "RrepForwarded",
+    "RerrSent",
+    "RerrReceived",
+    "RerrForwarded",
+    "DuplicateRequests",
+    "RateLimited",
+    "QueueOverflowDrops",
+    "QueueTimeoutDrops",
+    "QueueNoRouteDrops",
+    "QueuePeak",
+    "DataForwarded",
+    "DataBytesForwarded",
+    "RouteTableSize",
+};
+
+/// Percentiles written by AodvHelper::WritePercentiles, in percent
+const uint32_t AODV_PERCENTILES[] = {50, 95, 99};
+} // namespace
+
 AodvHelper::AodvHelper()
     : Ipv4RoutingHelper()
 {
@@ -47,40 +81,131 @@ int64_t
 AodvHelper::AssignStreams(NodeContainer c, int64_t stream)
 {
     int64_t currentStream = stream;
-    Ptr<Node> node;
     for (auto i = c.Begin(); i != c.End(); ++i)
     {
-        node = (*i);
-        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-        NS_ASSERT_MSG(ipv4, "Ipv4 not installed on node");
-        Ptr<Ipv4RoutingProtocol> proto = ipv4->GetRoutingProtocol();
-        NS_ASSERT_MSG(proto, "Ipv4 routing not installed on node");
-        Ptr<aodv::RoutingProtocol> aodv = DynamicCast<aodv::RoutingProtocol>(proto);
+        Ptr<aodv::RoutingProtocol> aodv = GetAodv(*i);
         if (aodv)
         {
             currentStream += aodv->AssignStreams(currentStream);
+        }
+    }
+    return (currentStream - stream);
+}
+
+Ptr<aodv::RoutingProtocol>
+AodvHelper::GetAodv(Ptr<Node> node)
+{
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    NS_ASSERT_MSG(ipv4, "Ipv4 not installed on node");
+    Ptr<Ipv4RoutingProtocol> proto = ipv4->GetRoutingProtocol();
+    NS_ASSERT_MSG(proto, "Ipv4 routing not installed on node");
+    Ptr<aodv::RoutingProtocol> aodv = DynamicCast<aodv::RoutingProtocol>(proto);
+    if (aodv)
+    {
+        return aodv;
+    }
+    // Aodv may also be in a list
+    Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting>(proto);
+    for (uint32_t i = 0; list && i < list->GetNRoutingProtocols(); i++)
+    {
+        int16_t priority;
+        aodv = DynamicCast<aodv::RoutingProtocol>(list->GetRoutingProtocol(i, priority));
+        if (aodv)
+        {
+            return aodv;
+        }
+    }
+    return nullptr;
+}
+
+std::string
+AodvHelper::GetCounterHeader()
+{
+    std::string header = "Node";
+    for (const char* name : AODV_COUNTERS)
+    {
+        header += std::string(",") + name;
+    }
+    return header;
+}
+
+void
+AodvHelper::WriteCounters(NodeContainer c, std::ostream& os, const std::string& prefix)
+{
+    for (auto i = c.Begin(); i != c.End(); ++i)
+    {
+        Ptr<aodv::RoutingProtocol> aodv = GetAodv(*i);
+        if (!aodv)
+        {
             continue;
         }
-        // Aodv may also be in a list
-        Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting>(proto);
-        if (list)
+        os << prefix << (*i)->GetId();
+        for (const char* name : AODV_COUNTERS)
         {
-            int16_t priority;
-            Ptr<Ipv4RoutingProtocol> listProto;
-            Ptr<aodv::RoutingProtocol> listAodv;
-            for (uint32_t i = 0; i < list->GetNRoutingProtocols(); i++)
-            {
-                listProto = list->GetRoutingProtocol(i, priority);
-                listAodv = DynamicCast<aodv::RoutingProtocol>(listProto);
-                if (listAodv)
-                {
-                    currentStream += listAodv->AssignStreams(currentStream);
-                    break;
-                }
-            }
+            UintegerValue value;
+            aodv->GetAttribute(name, value);
+            os << "," << value.Get();
         }
+        os << std::endl;
+    }
+}
+
+std::string
+AodvHelper::GetPercentileHeader()
+{
+    std::string header;
+    for (const char* name : {"DiscoveryLatency", "DiscoveryRings", "QueueResidence"})
+    {
+        for (uint32_t p : AODV_PERCENTILES)
+        {
+            header += (header.empty() ? "" : ",") + std::string(name) + "P" + std::to_string(p);
+        }
+    }
+    return header;
+}
+
+void
+AodvHelper::WritePercentiles(NodeContainer c, std::ostream& os)
+{
+    aodv::LogHistogram latency;
+    aodv::LogHistogram rings;
+    aodv::LogHistogram residence;
+    bool any = false;
+    for (auto i = c.Begin(); i != c.End(); ++i)
+    {
+        Ptr<aodv::RoutingProtocol> aodv = GetAodv(*i);
+        if (aodv)
+        {
+            latency.Merge(aodv->GetDiscoveryLatency());
+            rings.Merge(aodv->GetDiscoveryRings());
+            residence.Merge(aodv->GetQueueResidence());
+            any = true;
+        }
+    }
+    const char* sep = "";
+    if (!any)
+    {
+        // Other protocols have no such histograms, a 0 would read as a measurement
+        for (uint32_t k = 0; k < 3 * std::size(AODV_PERCENTILES); ++k)
+        {
+            os << sep << "NA";
+            sep = ",";
+        }
+        return;
+    }
+    for (uint32_t p : AODV_PERCENTILES)
+    {
+        os << sep << MicroSeconds(latency.GetQuantile(p / 100.0)).GetSeconds();
+        sep = ",";
+    }
+    for (uint32_t p : AODV_PERCENTILES)
+    {
+        os << "," << rings.GetQuantile(p / 100.0);
+    }
+    for (uint32_t p : AODV_PERCENTILES)
+    {
+        os << "," << MicroSeconds(residence.GetQuantile(p / 100.0)).GetSeconds();
     }
-    return (currentStream - stream);
 }
 
 } // namespace ns3
@@ -15,8 +15,16 @@
 #include "ns3/node.h"
 #include "ns3/object-factory.h"
 
+#include <ostream>
+#include <string>
+
 namespace ns3
 {
+namespace aodv
+{
+class RoutingProtocol;
+}
+
 /**
  * \ingroup aodv
  * \brief Helper class that adds AODV routing to nodes.
@@ -64,6 +72,42 @@ class AodvHelper : public Ipv4RoutingHelper
      */
     int64_t AssignStreams(NodeContainer c, int64_t stream);
 
+    /**
+     * Find the AODV instance of a node, installed alone or in an Ipv4ListRouting
+     * \param node the node
+     * \returns the routing protocol, or null if the node does not run AODV
+     */
+    static Ptr<aodv::RoutingProtocol> GetAodv(Ptr<Node> node);
+
+    /**
+     * \returns the comma separated names of the protocol counters written by WriteCounters
+     */
+    static std::string GetCounterHeader();
+    /**
+     * Write the protocol counters of every node running AODV as one CSV row per node: the
+     * prefix, the node ID, then the counters in the order of GetCounterHeader.
+     *
+     * \param c the nodes
+     * \param os the output stream
+     * \param prefix text written at the start of every row, e.g. the scenario parameters
+     */
+    static void WriteCounters(NodeContainer c, std::ostream& os, const std::string& prefix = "");
+
+    /**
+     * \returns the comma separated names of the percentiles written by WritePercentiles
+     */
+    static std::string GetPercentileHeader();
+    /**
+     * Merge the route discovery latency, discovery ring and request queue residence histograms
+     * of every node running AODV and write their 50th, 95th and 99th percentiles as comma
+     * separated values, in the order of GetPercentileHeader. Times are written in seconds.
+     * Every value is NA if no node runs AODV.
+     *
+     * \param c the nodes
+     * \param os the output stream
+     */
+    static void WritePercentiles(NodeContainer c, std::ostream& os);
+
   private:
     /** the factory to create AODV routing object */
     ObjectFactory m_agentFactory;
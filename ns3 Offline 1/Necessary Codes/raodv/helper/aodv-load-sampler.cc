@@ -0,0 +1,138 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Periodic per-node forwarding load snapshots in a compact binary file.
+ */
+
+#include "aodv-load-sampler.h"
+
+#include "aodv-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-net-device.h"
+
+#include <cmath>
+
+namespace ns3
+{
+
+namespace
+{
+/**
+ * Write an unsigned LEB128 varint
+ * \param os the output stream
+ * \param value the value
+ */
+void
+WriteVarint(std::ostream& os, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        os.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    os.put(static_cast<char>(value));
+}
+
+/**
+ * Write a coordinate in decimetres as a zigzag coded varint
+ * \param os the output stream
+ * \param metres the coordinate in metres
+ */
+void
+WriteCoordinate(std::ostream& os, double metres)
+{
+    int64_t dm = std::llround(metres * 10);
+    WriteVarint(os, (static_cast<uint64_t>(dm) << 1) ^ static_cast<uint64_t>(dm >> 63));
+}
+} // namespace
+
+void
+AodvLoadSampler::Install(NetDeviceContainer devices)
+{
+    for (auto i = devices.Begin(); i != devices.End(); ++i)
+    {
+        Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice>(*i);
+        if (!wifi)
+        {
+            continue;
+        }
+        Ptr<Node> node = wifi->GetNode();
+        auto id = m_ids.find(node->GetId());
+        if (id == m_ids.end())
+        {
+            id = m_ids.insert({node->GetId(), m_nodes.size()}).first;
+            m_nodes.push_back(NodeState());
+            m_nodes.back().node = node;
+        }
+        wifi->GetMac()->TraceConnectWithoutContext(
+            "DroppedMpdu",
+            MakeCallback(&AodvLoadSampler::DroppedMpdu, this).Bind(id->second));
+    }
+}
+
+void
+AodvLoadSampler::DroppedMpdu(uint32_t index, WifiMacDropReason reason, Ptr<const WifiMpdu> mpdu)
+{
+    // Retry limit drops are link failures rather than congestion
+    if (reason == WIFI_MAC_DROP_FAILED_ENQUEUE || reason == WIFI_MAC_DROP_EXPIRED_LIFETIME)
+    {
+        m_nodes[index].macDrops++;
+    }
+}
+
+void
+AodvLoadSampler::Start(const std::string& fileName, Time interval)
+{
+    NS_ASSERT_MSG(interval.IsStrictlyPositive(), "Sampling interval must be positive");
+    m_file.open(fileName, std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_UNLESS(m_file.good(), "Cannot open " << fileName);
+    m_interval = interval;
+    m_file.write("ALDS", 4);
+    WriteVarint(m_file, VERSION);
+    WriteVarint(m_file, m_nodes.size());
+    for (const NodeState& state : m_nodes)
+    {
+        WriteVarint(m_file, state.node->GetId());
+    }
+    WriteVarint(m_file, interval.GetMilliSeconds());
+    m_event.Cancel();
+    m_event = Simulator::ScheduleNow(&AodvLoadSampler::Sample, this);
+}
+
+void
+AodvLoadSampler::Sample()
+{
+    WriteVarint(m_file, Simulator::Now().GetMilliSeconds());
+    for (NodeState& state : m_nodes)
+    {
+        Ptr<aodv::RoutingProtocol> routing = AodvHelper::GetAodv(state.node);
+        NS_ASSERT_MSG(routing, "Node " << state.node->GetId() << " does not run AODV");
+        Ptr<MobilityModel> mobility = state.node->GetObject<MobilityModel>();
+        Vector position = mobility ? mobility->GetPosition() : Vector();
+        UintegerValue forwarded;
+        UintegerValue bytes;
+        routing->GetAttribute("DataForwarded", forwarded);
+        routing->GetAttribute("DataBytesForwarded", bytes);
+
+        WriteCoordinate(m_file, position.x);
+        WriteCoordinate(m_file, position.y);
+        WriteVarint(m_file, forwarded.Get() - state.lastForwarded);
+        WriteVarint(m_file, bytes.Get() - state.lastBytes);
+        WriteVarint(m_file, routing->GetQueueSize());
+        WriteVarint(m_file, routing->GetQueuePeak());
+        WriteVarint(m_file, state.macDrops - state.lastMacDrops);
+
+        state.lastForwarded = forwarded.Get();
+        state.lastBytes = bytes.Get();
+        state.lastMacDrops = state.macDrops;
+    }
+    m_file.flush();
+    m_event = Simulator::Schedule(m_interval, &AodvLoadSampler::Sample, this);
+}
+
+} // namespace ns3
@@ -0,0 +1,85 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Periodic per-node forwarding load snapshots in a compact binary file.
+ */
+
+#ifndef AODV_LOAD_SAMPLER_H
+#define AODV_LOAD_SAMPLER_H
+
+#include "ns3/event-id.h"
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-mpdu.h"
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+/**
+ * \ingroup aodv
+ * \brief Writes periodic snapshots of the forwarding load of every node to a binary file.
+ *
+ * The file starts with the magic "ALDS", then the format version, the number of nodes, their IDs
+ * and the sampling interval in milliseconds. Every snapshot that follows is the simulation time
+ * in milliseconds and, for each node in header order, its position in decimetres (zigzag coded),
+ * the data packets and bytes it forwarded since the previous snapshot, its request queue length
+ * and peak length, and its MAC queue drops since the previous snapshot. Every field is an
+ * unsigned LEB128 varint, so a snapshot of an idle node takes 7-10 bytes.
+ *
+ * Nodes must run AODV; load_report.cc turns the file into CSVs.
+ */
+class AodvLoadSampler
+{
+  public:
+    /// Format version written in the file header
+    static const uint32_t VERSION = 1;
+
+    /**
+     * Sample the nodes of the Wifi devices in the container and count their MAC queue drops.
+     * Other devices are ignored.
+     * \param devices the devices
+     */
+    void Install(NetDeviceContainer devices);
+    /**
+     * Open the file, write its header and schedule a snapshot every interval, the first one now
+     * \param fileName the file name
+     * \param interval the sampling interval
+     */
+    void Start(const std::string& fileName, Time interval);
+
+  private:
+    /// State of a sampled node
+    struct NodeState
+    {
+        Ptr<Node> node;            ///< the node
+        uint32_t macDrops{0};      ///< MAC queue drops so far
+        uint32_t lastForwarded{0}; ///< forwarded packets at the previous snapshot
+        uint64_t lastBytes{0};     ///< forwarded bytes at the previous snapshot
+        uint32_t lastMacDrops{0};  ///< MAC queue drops at the previous snapshot
+    };
+
+    /**
+     * Count an MPDU the MAC of a node dropped from or before its queue
+     * \param index the index of the node in m_nodes
+     * \param reason the drop reason
+     * \param mpdu the dropped MPDU
+     */
+    void DroppedMpdu(uint32_t index, WifiMacDropReason reason, Ptr<const WifiMpdu> mpdu);
+    /// Write a snapshot and schedule the next one
+    void Sample();
+
+    std::vector<NodeState> m_nodes;     ///< Sampled nodes, in file order
+    std::map<uint32_t, uint32_t> m_ids; ///< Index in m_nodes by node ID
+    std::ofstream m_file;               ///< Output file
+    Time m_interval;                    ///< Sampling interval
+    EventId m_event;                    ///< Next snapshot
+};
+
+} // namespace ns3
+
+#endif /* AODV_LOAD_SAMPLER_H */
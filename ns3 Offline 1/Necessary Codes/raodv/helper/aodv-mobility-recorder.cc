@@ -0,0 +1,187 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Compact binary trace of node course changes.
+ */
+
+#include "aodv-mobility-recorder.h"
+
+#include "ns3/abort.h"
+#include "ns3/aodv-replay-mobility-model.h"
+#include "ns3/simulator.h"
+
+#include <cmath>
+#include <map>
+
+namespace ns3
+{
+
+namespace
+{
+/**
+ * Write an unsigned LEB128 varint
+ * \param os the output stream
+ * \param value the value
+ */
+void
+WriteVarint(std::ostream& os, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        os.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    os.put(static_cast<char>(value));
+}
+
+/**
+ * Write a coordinate in thousandths as a zigzag coded varint
+ * \param os the output stream
+ * \param value the coordinate
+ */
+void
+WriteMilli(std::ostream& os, double value)
+{
+    int64_t milli = std::llround(value * 1000);
+    WriteVarint(os, (static_cast<uint64_t>(milli) << 1) ^ static_cast<uint64_t>(milli >> 63));
+}
+
+/**
+ * Read an unsigned LEB128 varint
+ * \param is the input stream
+ * \param value the value read
+ * \returns false at the end of the stream or on a truncated varint
+ */
+bool
+ReadVarint(std::istream& is, uint64_t& value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        int c = is.get();
+        if (c == EOF)
+        {
+            return false;
+        }
+        value |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if (!(c & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Read a zigzag coded value in thousandths
+ * \param is the input stream
+ * \param value the value
+ * \returns false at the end of the stream
+ */
+bool
+ReadMilli(std::istream& is, double& value)
+{
+    uint64_t v;
+    if (!ReadVarint(is, v))
+    {
+        return false;
+    }
+    value = (static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1)) / 1000.0;
+    return true;
+}
+} // namespace
+
+void
+AodvMobilityRecorder::Start(const std::string& fileName, NodeContainer nodes)
+{
+    m_file.open(fileName, std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_UNLESS(m_file.good(), "Cannot open " << fileName);
+    m_file.write("AMOB", 4);
+    WriteVarint(m_file, VERSION);
+    m_last = Time();
+    for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+    {
+        Ptr<MobilityModel> model = (*i)->GetObject<MobilityModel>();
+        if (!model)
+        {
+            continue;
+        }
+        uint32_t node = (*i)->GetId();
+        CourseChange(node, model);
+        model->TraceConnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&AodvMobilityRecorder::CourseChange, this).Bind(node));
+    }
+}
+
+void
+AodvMobilityRecorder::CourseChange(uint32_t node, Ptr<const MobilityModel> model)
+{
+    Time now = Simulator::Now();
+    Vector position = model->GetPosition();
+    Vector velocity = model->GetVelocity();
+    WriteVarint(m_file, (now - m_last).GetMicroSeconds());
+    WriteVarint(m_file, node);
+    WriteMilli(m_file, position.x);
+    WriteMilli(m_file, position.y);
+    WriteMilli(m_file, position.z);
+    WriteMilli(m_file, velocity.x);
+    WriteMilli(m_file, velocity.y);
+    WriteMilli(m_file, velocity.z);
+    // Times are rounded down to whole microseconds without accumulating the error
+    m_last += MicroSeconds((now - m_last).GetMicroSeconds());
+    m_records++;
+}
+
+uint64_t
+AodvMobilityRecorder::Replay(const std::string& fileName, NodeContainer nodes)
+{
+    std::ifstream in(fileName, std::ios::binary);
+    char magic[4];
+    uint64_t version;
+    NS_ABORT_MSG_UNLESS(in.read(magic, 4) && std::string(magic, 4) == "AMOB" &&
+                            ReadVarint(in, version) && version == VERSION,
+                        fileName << " is not a version " << VERSION << " mobility trace");
+
+    std::map<uint32_t, Ptr<AodvReplayMobilityModel>> models;
+    for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+    {
+        NS_ABORT_MSG_IF((*i)->GetObject<MobilityModel>(),
+                        "Node " << (*i)->GetId() << " already has a mobility model");
+        Ptr<AodvReplayMobilityModel> model = CreateObject<AodvReplayMobilityModel>();
+        (*i)->AggregateObject(model);
+        models[(*i)->GetId()] = model;
+    }
+
+    uint64_t records = 0;
+    uint64_t timeUs = 0;
+    uint64_t delta;
+    while (ReadVarint(in, delta))
+    {
+        timeUs += delta;
+        uint64_t node;
+        AodvReplayMobilityModel::Segment segment;
+        segment.start = MicroSeconds(timeUs);
+        NS_ABORT_MSG_UNLESS(ReadVarint(in, node) && ReadMilli(in, segment.position.x) &&
+                                ReadMilli(in, segment.position.y) &&
+                                ReadMilli(in, segment.position.z) &&
+                                ReadMilli(in, segment.velocity.x) &&
+                                ReadMilli(in, segment.velocity.y) &&
+                                ReadMilli(in, segment.velocity.z),
+                            fileName << ": truncated record at " << timeUs / 1e6 << " s");
+        auto model = models.find(node);
+        if (model != models.end())
+        {
+            model->second->AddSegment(segment);
+        }
+        records++;
+    }
+    for (const auto& [node, model] : models)
+    {
+        NS_ABORT_MSG_UNLESS(model->GetSegments(),
+                            "No trajectory of node " << node << " in " << fileName);
+    }
+    return records;
+}
+
+} // namespace ns3
@@ -0,0 +1,80 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Compact binary trace of node course changes.
+ */
+
+#ifndef AODV_MOBILITY_RECORDER_H
+#define AODV_MOBILITY_RECORDER_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+
+#include <fstream>
+#include <string>
+
+namespace ns3
+{
+/**
+ * \ingroup aodv
+ * \brief Writes every course change of a set of nodes to a compact binary file.
+ *
+ * The file starts with the magic "AMOB" and the format version. Every record that follows is the
+ * time since the previous record (since time zero for the first one) in microseconds, the node
+ * ID, the position in millimetres and the velocity in millimetres per second, the coordinates
+ * zigzag coded. Every field is an unsigned LEB128 varint, so a record takes about 15 bytes
+ * against about 100 for the ASCII trace of MobilityHelper::EnableAsciiAll. The first records
+ * hold the state of every node when recording starts; between two records of a node it moves in
+ * a straight line, so the file describes the whole trajectory of a waypoint-based model.
+ *
+ * Replay drives nodes along a recorded file, the same trajectories for every protocol compared;
+ * mobility_report.cc turns the file into a CSV.
+ */
+class AodvMobilityRecorder
+{
+  public:
+    /// Format version written in the file header
+    static const uint32_t VERSION = 1;
+
+    /**
+     * Open the file, record the current state of every node with a mobility model and then
+     * every course change of those nodes. Other nodes are ignored.
+     * \param fileName the file name
+     * \param nodes the nodes
+     */
+    void Start(const std::string& fileName, NodeContainer nodes);
+
+    /**
+     * Give every node in the container an AodvReplayMobilityModel that follows its trajectory in
+     * a recorded file. Nodes are matched by ID, so the nodes must be created in the same order as
+     * in the recorded run, and every node must have a trajectory.
+     * \param fileName the file name
+     * \param nodes the nodes, without a mobility model
+     * \returns the number of records read
+     */
+    static uint64_t Replay(const std::string& fileName, NodeContainer nodes);
+
+    /**
+     * \returns the number of records written
+     */
+    uint64_t GetRecords() const
+    {
+        return m_records;
+    }
+
+  private:
+    /**
+     * Record the state of a node
+     * \param node the node ID
+     * \param model the mobility model of the node
+     */
+    void CourseChange(uint32_t node, Ptr<const MobilityModel> model);
+
+    std::ofstream m_file;  ///< Output file
+    Time m_last;           ///< Time of the previous record
+    uint64_t m_records{0}; ///< Records written
+};
+
+} // namespace ns3
+
+#endif /* AODV_MOBILITY_RECORDER_H */
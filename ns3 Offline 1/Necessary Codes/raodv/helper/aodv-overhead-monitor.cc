@@ -0,0 +1,188 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * MAC-level accounting of AODV control traffic.
+ */
+
+#include "aodv-overhead-monitor.h"
+
+#include "ns3/aodv-packet.h"
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-psdu.h"
+
+namespace ns3
+{
+
+namespace
+{
+/// Column name prefixes of the categories, in the order of AodvOverheadMonitor::Category
+const char* const CATEGORY_NAMES[] = {"Hello", "Rreq", "RevRreq", "Rrep", "Rerr", "RrepAck"};
+} // namespace
+
+void
+AodvOverheadMonitor::Install(NetDeviceContainer devices)
+{
+    for (auto i = devices.Begin(); i != devices.End(); ++i)
+    {
+        Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice>(*i);
+        if (!wifi)
+        {
+            continue;
+        }
+        uint32_t node = wifi->GetNode()->GetId();
+        m_nodes[node];
+        wifi->GetPhy()->TraceConnectWithoutContext(
+            "PhyTxPsduBegin",
+            MakeCallback(&AodvOverheadMonitor::PhyTxPsduBegin, this).Bind(node));
+    }
+}
+
+AodvOverheadMonitor::Category
+AodvOverheadMonitor::Classify(Ptr<const WifiMpdu> mpdu)
+{
+    const WifiMacHeader& mac = mpdu->GetHeader();
+    if (!mac.IsData() || mpdu->GetPacket()->GetSize() == 0)
+    {
+        return CATEGORIES;
+    }
+    Ptr<Packet> p = mpdu->GetPacket()->Copy();
+    LlcSnapHeader llc;
+    p->RemoveHeader(llc);
+    if (llc.GetType() != Ipv4L3Protocol::PROT_NUMBER)
+    {
+        return CATEGORIES;
+    }
+    Ipv4Header ip;
+    p->RemoveHeader(ip);
+    if (ip.GetProtocol() != UdpL4Protocol::PROT_NUMBER || ip.GetFragmentOffset() != 0)
+    {
+        return CATEGORIES;
+    }
+    UdpHeader udp;
+    p->RemoveHeader(udp);
+    if (udp.GetDestinationPort() != aodv::RoutingProtocol::AODV_PORT)
+    {
+        return CATEGORIES;
+    }
+    aodv::TypeHeader type;
+    p->RemoveHeader(type);
+    if (!type.IsValid())
+    {
+        return CATEGORIES;
+    }
+    switch (type.Get())
+    {
+    case aodv::AODVTYPE_RREQ:
+    case aodv::AODVTYPE_RREQ_COMPACT:
+        return RREQ;
+    case aodv::AODVTYPE_REV_RREQ:
+    case aodv::AODVTYPE_REV_RREQ_COMPACT:
+        return REV_RREQ;
+    case aodv::AODVTYPE_RREP:
+        return mac.GetAddr1().IsBroadcast() ? HELLO : RREP;
+    case aodv::AODVTYPE_RERR:
+        return RERR;
+    case aodv::AODVTYPE_RREP_ACK:
+        return RREP_ACK;
+    }
+    return CATEGORIES;
+}
+
+void
+AodvOverheadMonitor::PhyTxPsduBegin(uint32_t node,
+                                    WifiConstPsduMap psdus,
+                                    WifiTxVector txVector,
+                                    double txPowerW)
+{
+    NodeCounts& counts = m_nodes[node];
+    for (const auto& psdu : psdus)
+    {
+        for (auto mpdu = psdu.second->begin(); mpdu != psdu.second->end(); ++mpdu)
+        {
+            Category category = Classify(*mpdu);
+            if (category != CATEGORIES)
+            {
+                counts[category].frames++;
+                counts[category].bytes += (*mpdu)->GetSize();
+            }
+        }
+    }
+}
+
+uint64_t
+AodvOverheadMonitor::GetFrames(Category category) const
+{
+    uint64_t frames = 0;
+    for (const auto& node : m_nodes)
+    {
+        frames += node.second[category].frames;
+    }
+    return frames;
+}
+
+uint64_t
+AodvOverheadMonitor::GetBytes(Category category) const
+{
+    uint64_t bytes = 0;
+    for (const auto& node : m_nodes)
+    {
+        bytes += node.second[category].bytes;
+    }
+    return bytes;
+}
+
+uint64_t
+AodvOverheadMonitor::GetControlFrames() const
+{
+    uint64_t frames = 0;
+    for (uint32_t c = 0; c < CATEGORIES; ++c)
+    {
+        frames += GetFrames(Category(c));
+    }
+    return frames;
+}
+
+uint64_t
+AodvOverheadMonitor::GetControlBytes() const
+{
+    uint64_t bytes = 0;
+    for (uint32_t c = 0; c < CATEGORIES; ++c)
+    {
+        bytes += GetBytes(Category(c));
+    }
+    return bytes;
+}
+
+std::string
+AodvOverheadMonitor::GetNodeHeader()
+{
+    std::string header = "Node";
+    for (const char* name : CATEGORY_NAMES)
+    {
+        header += std::string(",") + name + "Frames," + name + "Bytes";
+    }
+    return header;
+}
+
+void
+AodvOverheadMonitor::WriteNodes(std::ostream& os, const std::string& prefix) const
+{
+    for (const auto& node : m_nodes)
+    {
+        os << prefix << node.first;
+        for (const Count& count : node.second)
+        {
+            os << "," << count.frames << "," << count.bytes;
+        }
+        os << std::endl;
+    }
+}
+
+} // namespace ns3
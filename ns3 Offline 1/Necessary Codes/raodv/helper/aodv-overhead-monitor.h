@@ -0,0 +1,119 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * MAC-level accounting of AODV control traffic.
+ */
+
+#ifndef AODV_OVERHEAD_MONITOR_H
+#define AODV_OVERHEAD_MONITOR_H
+
+#include "ns3/net-device-container.h"
+#include "ns3/wifi-mpdu.h"
+#include "ns3/wifi-ppdu.h"
+#include "ns3/wifi-tx-vector.h"
+
+#include <array>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace ns3
+{
+/**
+ * \ingroup aodv
+ * \brief Counts the frames and bytes Wifi devices transmit for AODV control messages.
+ *
+ * Frames are counted when the PHY starts transmitting them, so MAC retransmissions are included,
+ * and bytes are whole MPDUs, i.e. MAC header and FCS included. Hellos are told apart from RREPs
+ * by their broadcast receiver address. Control information piggybacked on data packets is not
+ * counted.
+ */
+class AodvOverheadMonitor
+{
+  public:
+    /// Control message categories
+    enum Category
+    {
+        HELLO,      ///< Hello, i.e. broadcast RREP
+        RREQ,       ///< RREQ, compact encoding included
+        REV_RREQ,   ///< REV_RREQ, compact encoding included
+        RREP,       ///< unicast RREP
+        RERR,       ///< RERR
+        RREP_ACK,   ///< RREP_ACK
+        CATEGORIES, ///< Number of categories
+    };
+
+    /**
+     * Start counting the transmissions of every Wifi device in the container. Other devices
+     * are ignored.
+     * \param devices the devices
+     */
+    void Install(NetDeviceContainer devices);
+
+    /**
+     * \param category the message category
+     * \returns the number of frames sent by all nodes
+     */
+    uint64_t GetFrames(Category category) const;
+    /**
+     * \param category the message category
+     * \returns the number of bytes sent by all nodes
+     */
+    uint64_t GetBytes(Category category) const;
+    /**
+     * \returns the number of control frames of any category sent by all nodes
+     */
+    uint64_t GetControlFrames() const;
+    /**
+     * \returns the number of control bytes of any category sent by all nodes
+     */
+    uint64_t GetControlBytes() const;
+
+    /**
+     * \returns the comma separated column names written by WriteNodes
+     */
+    static std::string GetNodeHeader();
+    /**
+     * Write one CSV row per node with a monitored device: the prefix, the node ID, then the
+     * frames and bytes of every category in the order of GetNodeHeader.
+     *
+     * \param os the output stream
+     * \param prefix text written at the start of every row, e.g. the scenario parameters
+     */
+    void WriteNodes(std::ostream& os, const std::string& prefix = "") const;
+
+  private:
+    /// Frames and bytes of one category
+    struct Count
+    {
+        uint64_t frames{0}; ///< frames
+        uint64_t bytes{0};  ///< bytes
+    };
+
+    /// Counts of a node, by category
+    typedef std::array<Count, CATEGORIES> NodeCounts;
+
+    /**
+     * Count the AODV control frames of a PSDU the PHY of a node starts transmitting
+     * \param node the node ID
+     * \param psdus the PSDUs
+     * \param txVector the TXVECTOR
+     * \param txPowerW the transmit power in Watts
+     */
+    void PhyTxPsduBegin(uint32_t node,
+                        WifiConstPsduMap psdus,
+                        WifiTxVector txVector,
+                        double txPowerW);
+    /**
+     * \param mpdu an MPDU
+     * \returns the category of the AODV control message it carries, CATEGORIES if none
+     */
+    static Category Classify(Ptr<const WifiMpdu> mpdu);
+
+    /// Counts per node ID
+    std::map<uint32_t, NodeCounts> m_nodes;
+};
+
+} // namespace ns3
+
+#endif /* AODV_OVERHEAD_MONITOR_H */
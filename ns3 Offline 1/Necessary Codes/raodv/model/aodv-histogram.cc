@@ -0,0 +1,129 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Log-bucketed histogram for latency and count distributions, and the t quantile the
+ * replication of the benchmark runs uses.
+ */
+
+#include "aodv-histogram.h"
+
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+namespace aodv
+{
+
+LogHistogram::LogHistogram()
+    : m_buckets{},
+      m_count(0),
+      m_max(0)
+{
+}
+
+uint32_t
+LogHistogram::GetBucket(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return value;
+    }
+    // Index of the most significant bit, by binary search
+    uint32_t msb = 0;
+    for (uint32_t shift = 32; shift > 0; shift >>= 1)
+    {
+        if (value >> (msb + shift))
+        {
+            msb += shift;
+        }
+    }
+    uint32_t sub = (value >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS + (msb - SUB_BITS) * SUB_BUCKETS + sub;
+}
+
+uint64_t
+LogHistogram::GetUpperBound(uint32_t bucket)
+{
+    if (bucket < SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    uint32_t shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+    uint64_t lower = (SUB_BUCKETS + sub) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+void
+LogHistogram::Add(uint64_t value)
+{
+    m_buckets[GetBucket(value)]++;
+    m_count++;
+    m_max = std::max(m_max, value);
+}
+
+void
+LogHistogram::Merge(const LogHistogram& o)
+{
+    for (uint32_t i = 0; i < BUCKETS; ++i)
+    {
+        m_buckets[i] += o.m_buckets[i];
+    }
+    m_count += o.m_count;
+    m_max = std::max(m_max, o.m_max);
+}
+
+void
+LogHistogram::Clear()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_max = 0;
+}
+
+uint64_t
+LogHistogram::GetQuantile(double q) const
+{
+    NS_ASSERT(q >= 0 && q <= 1);
+    if (m_count == 0)
+    {
+        return 0;
+    }
+    // Rank of the quantile among the recorded values, counting from 1
+    uint64_t rank = std::max<uint64_t>(1, std::ceil(q * m_count));
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKETS; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+        {
+            return std::min(GetUpperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+double
+StudentT95(uint32_t df)
+{
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                   2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                   2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                   2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df == 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (df <= 30)
+    {
+        return table[df - 1];
+    }
+    return df <= 40 ? 2.042 : df <= 60 ? 2.021 : df <= 120 ? 2.000 : 1.980;
+}
+
+} // namespace aodv
+} // namespace ns3
@@ -0,0 +1,112 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Log-bucketed histogram for latency and count distributions, and the t quantile the
+ * replication of the benchmark runs uses.
+ */
+
+#ifndef AODV_HISTOGRAM_H
+#define AODV_HISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+
+namespace ns3
+{
+namespace aodv
+{
+/**
+ * \ingroup aodv
+ *
+ * \brief Histogram of non-negative integers with logarithmically sized buckets.
+ *
+ * Values below 8 have a bucket each. Every larger power of two range is split into 8 equal
+ * buckets, so a quantile is reported with a relative error below 12.5%. Adding a value costs a
+ * handful of shifts and the histogram has a fixed size, which keeps it cheap enough to record
+ * every routed packet.
+ */
+class LogHistogram
+{
+  public:
+    /// constructor
+    LogHistogram();
+
+    /**
+     * Record a value
+     * \param value the value
+     */
+    void Add(uint64_t value);
+    /**
+     * Add the values recorded by another histogram
+     * \param o the other histogram
+     */
+    void Merge(const LogHistogram& o);
+    /// Forget all recorded values
+    void Clear();
+
+    /**
+     * \returns the number of recorded values
+     */
+    uint64_t GetCount() const
+    {
+        return m_count;
+    }
+
+    /**
+     * \returns the largest recorded value, 0 if the histogram is empty
+     */
+    uint64_t GetMax() const
+    {
+        return m_max;
+    }
+
+    /**
+     * Estimate a quantile
+     * \param q the quantile, in [0, 1]
+     * \returns the upper bound of the bucket holding the quantile, capped at the largest recorded
+     *          value; 0 if the histogram is empty
+     */
+    uint64_t GetQuantile(double q) const;
+
+  private:
+    /// Number of buckets per power of two range, and number of exact buckets below it
+    static const uint32_t SUB_BUCKETS = 8;
+    /// log2 (SUB_BUCKETS)
+    static const uint32_t SUB_BITS = 3;
+    /// Number of buckets needed to cover all 64-bit values
+    static const uint32_t BUCKETS = SUB_BUCKETS + (64 - SUB_BITS) * SUB_BUCKETS;
+
+    /**
+     * \param value a value
+     * \returns the index of the bucket holding value
+     */
+    static uint32_t GetBucket(uint64_t value);
+    /**
+     * \param bucket a bucket index
+     * \returns the largest value held by the bucket
+     */
+    static uint64_t GetUpperBound(uint32_t bucket);
+
+    std::array<uint32_t, BUCKETS> m_buckets; ///< Number of values per bucket
+    uint64_t m_count;                        ///< Number of recorded values
+    uint64_t m_max;                          ///< Largest recorded value
+};
+
+/**
+ * \ingroup aodv
+ *
+ * \brief Two-sided 95% quantile of the Student t distribution, t(0.975, df)
+ *
+ * Exact to three decimals up to 30 degrees of freedom. Above that the quantile of the next lower
+ * tabulated df (30, 40, 60 or 120) is returned, which errs on the wide side, so a confidence
+ * interval built from it is never too narrow.
+ *
+ * \param df degrees of freedom
+ * \returns the quantile, infinity for df = 0
+ */
+double StudentT95(uint32_t df);
+
+} // namespace aodv
+} // namespace ns3
+
+#endif /* AODV_HISTOGRAM_H */
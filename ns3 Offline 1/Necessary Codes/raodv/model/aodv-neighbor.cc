@@ -20,6 +20,8 @@
 #include "ns3/wifi-mac-header.h"
 
 #include <algorithm>
+#include <cmath>
+#include <list>
 
 namespace ns3
 {
@@ -29,7 +31,9 @@ NS_LOG_COMPONENT_DEFINE("AodvNeighbors");
 namespace aodv
 {
 Neighbors::Neighbors(Time delay)
-    : m_ntimer(Timer::CANCEL_ON_DESTROY)
+    : m_ntimer(Timer::CANCEL_ON_DESTROY),
+      m_insertions(0),
+      m_expiries(0)
 {
     m_ntimer.SetDelay(delay);
     m_ntimer.SetFunction(&Neighbors::Purge, this);
@@ -83,9 +87,110 @@ Neighbors::Update(Ipv4Address addr, Time expire)
     NS_LOG_LOGIC("Open link to " << addr);
     Neighbor neighbor(addr, LookupMacAddress(addr), expire + Simulator::Now());
     m_nb.push_back(neighbor);
+    m_insertions++;
     Purge();
 }
 
+void
+Neighbors::UpdateHello(Ipv4Address addr, Time lifetime)
+{
+    Update(addr, lifetime);
+    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    {
+        if (i->m_neighborAddress == addr)
+        {
+            i->m_helloLifetime = lifetime;
+            return;
+        }
+    }
+}
+
+void
+Neighbors::Refresh(Ipv4Address addr, Time expire)
+{
+    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    {
+        if (i->m_neighborAddress == addr && !i->m_helloLifetime.IsZero())
+        {
+            Update(addr, i->m_helloLifetime);
+            return;
+        }
+    }
+    Update(addr, expire);
+}
+
+Ipv4Address
+Neighbors::UpdateByMac(Mac48Address mac, Time expire)
+{
+    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    {
+        if (i->m_hardwareAddress == mac)
+        {
+            if (!i->m_helloLifetime.IsZero())
+            {
+                expire = i->m_helloLifetime;
+            }
+            i->m_expireTime = std::max(expire + Simulator::Now(), i->m_expireTime);
+            return i->m_neighborAddress;
+        }
+    }
+
+    Ipv4Address addr = LookupIpAddress(mac);
+    if (addr != Ipv4Address())
+    {
+        Update(addr, expire);
+    }
+    return addr;
+}
+
+void
+Neighbors::RecordHello(Ipv4Address addr, Time interval)
+{
+    // Weight of the newest hello slot in the delivery ratio estimate
+    const double alpha = 0.1;
+    // Upper bound on hello slots accounted for a single gap
+    const uint32_t maxSlots = 16;
+
+    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    {
+        if (i->m_neighborAddress == addr)
+        {
+            Time now = Simulator::Now();
+            if (i->m_lastHello.IsPositive() && interval.IsStrictlyPositive())
+            {
+                auto slots = static_cast<uint32_t>(
+                    std::lround((now - i->m_lastHello).GetSeconds() / interval.GetSeconds()));
+                slots = std::min(std::max(slots, 1U), maxSlots);
+                // slots - 1 hellos were lost, the last one was received
+                for (uint32_t k = 1; k < slots; ++k)
+                {
+                    i->m_deliveryRatio *= (1 - alpha);
+                }
+                i->m_deliveryRatio = (1 - alpha) * i->m_deliveryRatio + alpha;
+            }
+            i->m_lastHello = now;
+            return;
+        }
+    }
+}
+
+double
+Neighbors::GetEtx(Ipv4Address addr) const
+{
+    // Lower bound on the delivery ratio, keeps ETX finite
+    const double minDeliveryRatio = 0.05;
+
+    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    {
+        if (i->m_neighborAddress == addr)
+        {
+            double d = std::max(i->m_deliveryRatio, minDeliveryRatio);
+            return 1 / (d * d);
+        }
+    }
+    return 1;
+}
+
 /**
  * \brief CloseNeighbor structure
  */
@@ -123,7 +228,9 @@ Neighbors::Purge()
             }
         }
     }
-    m_nb.erase(std::remove_if(m_nb.begin(), m_nb.end(), pred), m_nb.end());
+    auto last = std::remove_if(m_nb.begin(), m_nb.end(), pred);
+    m_expiries += std::distance(last, m_nb.end());
+    m_nb.erase(last, m_nb.end());
     m_ntimer.Cancel();
     m_ntimer.Schedule();
 }
@@ -163,6 +270,23 @@ Neighbors::LookupMacAddress(Ipv4Address addr)
     return hwaddr;
 }
 
+Ipv4Address
+Neighbors::LookupIpAddress(Mac48Address mac)
+{
+    for (auto i = m_arp.begin(); i != m_arp.end(); ++i)
+    {
+        std::list<ArpCache::Entry*> entries = (*i)->LookupInverse(mac);
+        for (auto j = entries.begin(); j != entries.end(); ++j)
+        {
+            if (((*j)->IsAlive() || (*j)->IsPermanent()) && !(*j)->IsExpired())
+            {
+                return (*j)->GetIpv4Address();
+            }
+        }
+    }
+    return Ipv4Address();
+}
+
 void
 Neighbors::ProcessTxError(const WifiMacHeader& hdr)
 {
@@ -59,6 +59,12 @@ class Neighbors
         Time m_expireTime;
         /// Neighbor close indicator
         bool close;
+        /// Reception time of the last hello from the neighbor, negative if none was received
+        Time m_lastHello;
+        /// Estimated fraction of the neighbor's hellos that reach us
+        double m_deliveryRatio;
+        /// Hello lifetime the neighbor advertised, zero if UpdateHello was never called for it
+        Time m_helloLifetime;
 
         /**
          * \brief Neighbor structure constructor
@@ -71,7 +77,10 @@ class Neighbors
             : m_neighborAddress(ip),
               m_hardwareAddress(mac),
               m_expireTime(t),
-              close(false)
+              close(false),
+              m_lastHello(Seconds(-1)),
+              m_deliveryRatio(1),
+              m_helloLifetime(Seconds(0))
         {
         }
     };
@@ -94,6 +103,42 @@ class Neighbors
      * \param expire the expire time for the address
      */
     void Update(Ipv4Address addr, Time expire);
+    /**
+     * Update the neighbor with address addr from one of its hellos and remember the hello
+     * lifetime it advertised, which Refresh uses afterwards
+     * \param addr the IP address of the neighbor
+     * \param lifetime the advertised hello lifetime
+     */
+    void UpdateHello(Ipv4Address addr, Time lifetime);
+    /**
+     * Update the neighbor with address addr from a message other than a hello. The neighbor is
+     * kept for the hello lifetime it advertised, as its next hello is due within that time.
+     * \param addr the IP address of the neighbor
+     * \param expire the expire time used if the neighbor advertised no hello lifetime
+     */
+    void Refresh(Ipv4Address addr, Time expire);
+    /**
+     * Refresh the neighbor with hardware address mac, see Refresh. Unknown hardware addresses
+     * are resolved to IP through the ARP caches and added as new entries.
+     * \param mac the MAC address of the neighbor
+     * \param expire the expire time used if the neighbor advertised no hello lifetime
+     * \returns the IP address of the neighbor, or the default Ipv4Address if it is unknown
+     */
+    Ipv4Address UpdateByMac(Mac48Address mac, Time expire);
+    /**
+     * Update the link delivery ratio estimate of neighbor addr from the gap since its previous
+     * hello. Hellos missing from the gap are counted as lost.
+     * \param addr the IP address of the neighbor
+     * \param interval the hello interval of the neighbor
+     */
+    void RecordHello(Ipv4Address addr, Time interval);
+    /**
+     * Get the expected transmission count of the link to neighbor addr. The link is assumed to
+     * be symmetric, so ETX = 1 / d^2 where d is the delivery ratio measured from hellos.
+     * \param addr the IP address of the neighbor
+     * \returns the ETX of the link, 1 for unknown neighbors
+     */
+    double GetEtx(Ipv4Address addr) const;
     /// Remove all expired entries
     void Purge();
     /// Schedule m_ntimer.
@@ -105,6 +150,46 @@ class Neighbors
         m_nb.clear();
     }
 
+    /**
+     * Set the purge timer period
+     * \param delay the delay time for purging the list of neighbors
+     */
+    void SetDelay(Time delay)
+    {
+        m_ntimer.SetDelay(delay);
+    }
+
+    /**
+     * \returns the number of entries in the neighbor list
+     */
+    uint32_t GetNeighborCount() const
+    {
+        return m_nb.size();
+    }
+
+    /**
+     * \returns the number of neighbors added since the last ResetChurnCounters ()
+     */
+    uint32_t GetInsertions() const
+    {
+        return m_insertions;
+    }
+
+    /**
+     * \returns the number of neighbors expired or closed since the last ResetChurnCounters ()
+     */
+    uint32_t GetExpiries() const
+    {
+        return m_expiries;
+    }
+
+    /// Reset neighbor churn counters
+    void ResetChurnCounters()
+    {
+        m_insertions = 0;
+        m_expiries = 0;
+    }
+
     /**
      * Add ARP cache to be used to allow layer 2 notifications processing
      * \param a pointer to the ARP cache to add
@@ -154,6 +239,10 @@ class Neighbors
     std::vector<Neighbor> m_nb;
     /// list of ARP cached to be used for layer 2 notifications processing
     std::vector<Ptr<ArpCache>> m_arp;
+    /// Number of neighbors added since the counters were reset
+    uint32_t m_insertions;
+    /// Number of neighbors removed since the counters were reset
+    uint32_t m_expiries;
 
     /**
      * Find MAC address by IP using list of ARP caches
@@ -162,6 +251,13 @@ class Neighbors
      * \returns the MAC address for the IP address
      */
     Mac48Address LookupMacAddress(Ipv4Address addr);
+    /**
+     * Find IP address by MAC using list of ARP caches
+     *
+     * \param mac the MAC address to lookup
+     * \returns the IP address for the MAC address
+     */
+    Ipv4Address LookupIpAddress(Mac48Address mac);
     /**
      * Process layer 2 TX error notification
      * \param hdr header of the packet
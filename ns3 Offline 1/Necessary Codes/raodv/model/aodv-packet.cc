@@ -18,11 +18,87 @@
 #include "ns3/address-utils.h"
 #include "ns3/packet.h"
 
+#include <limits>
+
 namespace ns3
 {
 namespace aodv
 {
 
+namespace
+{
+/**
+ * \param value the value
+ * \returns the size of value as a varint
+ */
+uint32_t
+VarintSize(uint32_t value)
+{
+    uint32_t size = 1;
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+/**
+ * \brief Write a varint, 7 bits per byte, least significant group first
+ * \param i the buffer iterator
+ * \param value the value
+ */
+void
+WriteVarint(Buffer::Iterator& i, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        i.WriteU8((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    i.WriteU8(value);
+}
+
+/**
+ * \brief Read a varint of at most 5 bytes
+ * \param i the buffer iterator
+ * \returns the value
+ */
+uint32_t
+ReadVarint(Buffer::Iterator& i)
+{
+    uint32_t value = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7)
+    {
+        uint8_t byte = i.ReadU8();
+        value |= uint32_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            break;
+        }
+    }
+    return value;
+}
+
+/**
+ * \param flags the RREQ / REV_RREQ flags
+ * \param requestID the request ID
+ * \param dstSeqNo the destination sequence number
+ * \param originSeqNo the originator sequence number
+ * \returns the size of the compact encoding without extensions
+ */
+uint32_t
+CompactRequestSize(uint8_t flags, uint32_t requestID, uint32_t dstSeqNo, uint32_t originSeqNo)
+{
+    uint32_t size = 2 + VarintSize(requestID) + 4 + 4 + VarintSize(originSeqNo);
+    if (!(flags & (1 << 3)))
+    {
+        size += VarintSize(dstSeqNo);
+    }
+    return size;
+}
+} // namespace
+
 NS_OBJECT_ENSURE_REGISTERED(TypeHeader);
 
 TypeHeader::TypeHeader(MessageType t)
@@ -71,7 +147,9 @@ TypeHeader::Deserialize(Buffer::Iterator start)
     case AODVTYPE_REV_RREQ:
     case AODVTYPE_RREP:
     case AODVTYPE_RERR:
-    case AODVTYPE_RREP_ACK: {
+    case AODVTYPE_RREP_ACK:
+    case AODVTYPE_RREQ_COMPACT:
+    case AODVTYPE_REV_RREQ_COMPACT: {
         m_type = (MessageType)type;
         break;
     }
@@ -108,6 +186,14 @@ TypeHeader::Print(std::ostream& os) const
         os << "RREP_ACK";
         break;
     }
+    case AODVTYPE_RREQ_COMPACT: {
+        os << "RREQ_COMPACT";
+        break;
+    }
+    case AODVTYPE_REV_RREQ_COMPACT: {
+        os << "REV_RREQ_COMPACT";
+        break;
+    }
     default:
         os << "UNKNOWN_TYPE";
     }
@@ -144,7 +230,9 @@ RreqHeader::RreqHeader(uint8_t flags,
       m_dst(dst),
       m_dstSeqNo(dstSeqNo),
       m_origin(origin),
-      m_originSeqNo(originSeqNo)
+      m_originSeqNo(originSeqNo),
+      m_pathEtx(0),
+      m_compact(false)
 {
 }
 
@@ -169,34 +257,105 @@ RreqHeader::GetInstanceTypeId() const
 uint32_t
 RreqHeader::GetSerializedSize() const
 {
-    return 23;
+    uint32_t size = 23;
+    if (m_compact)
+    {
+        size = CompactRequestSize(m_flags, m_requestID, m_dstSeqNo, m_originSeqNo);
+    }
+    if (GetMultiDestination())
+    {
+        size += 1 + 9 * m_destinations.size();
+    }
+    if (HasPathEtx())
+    {
+        size += 2;
+    }
+    return size;
 }
 
 void
 RreqHeader::Serialize(Buffer::Iterator i) const
 {
-    i.WriteU8(m_flags);
-    i.WriteU8(m_reserved);
-    i.WriteU8(m_hopCount);
-    i.WriteHtonU32(m_requestID);
-    WriteTo(i, m_dst);
-    i.WriteHtonU32(m_dstSeqNo);
-    WriteTo(i, m_origin);
-    i.WriteHtonU32(m_originSeqNo);
+    if (m_compact)
+    {
+        i.WriteU8(m_flags);
+        i.WriteU8(m_hopCount);
+        WriteVarint(i, m_requestID);
+        WriteTo(i, m_dst);
+        if (!GetUnknownSeqno())
+        {
+            WriteVarint(i, m_dstSeqNo);
+        }
+        WriteTo(i, m_origin);
+        WriteVarint(i, m_originSeqNo);
+    }
+    else
+    {
+        i.WriteU8(m_flags);
+        i.WriteU8(m_reserved);
+        i.WriteU8(m_hopCount);
+        i.WriteHtonU32(m_requestID);
+        WriteTo(i, m_dst);
+        i.WriteHtonU32(m_dstSeqNo);
+        WriteTo(i, m_origin);
+        i.WriteHtonU32(m_originSeqNo);
+    }
+    if (GetMultiDestination())
+    {
+        i.WriteU8((uint8_t)m_destinations.size());
+        for (auto j = m_destinations.begin(); j != m_destinations.end(); ++j)
+        {
+            i.WriteU8(j->unknownSeqno ? (1 << 7) : 0);
+            WriteTo(i, j->address);
+            i.WriteHtonU32(j->seqNo);
+        }
+    }
+    if (HasPathEtx())
+    {
+        i.WriteHtonU16(m_pathEtx);
+    }
 }
 
 uint32_t
 RreqHeader::Deserialize(Buffer::Iterator start)
 {
     Buffer::Iterator i = start;
-    m_flags = i.ReadU8();
-    m_reserved = i.ReadU8();
-    m_hopCount = i.ReadU8();
-    m_requestID = i.ReadNtohU32();
-    ReadFrom(i, m_dst);
-    m_dstSeqNo = i.ReadNtohU32();
-    ReadFrom(i, m_origin);
-    m_originSeqNo = i.ReadNtohU32();
+    if (m_compact)
+    {
+        m_flags = i.ReadU8();
+        m_reserved = 0;
+        m_hopCount = i.ReadU8();
+        m_requestID = ReadVarint(i);
+        ReadFrom(i, m_dst);
+        m_dstSeqNo = GetUnknownSeqno() ? 0 : ReadVarint(i);
+        ReadFrom(i, m_origin);
+        m_originSeqNo = ReadVarint(i);
+    }
+    else
+    {
+        m_flags = i.ReadU8();
+        m_reserved = i.ReadU8();
+        m_hopCount = i.ReadU8();
+        m_requestID = i.ReadNtohU32();
+        ReadFrom(i, m_dst);
+        m_dstSeqNo = i.ReadNtohU32();
+        ReadFrom(i, m_origin);
+        m_originSeqNo = i.ReadNtohU32();
+    }
+    m_destinations.clear();
+    if (GetMultiDestination())
+    {
+        uint8_t count = i.ReadU8();
+        Destination destination;
+        for (uint8_t k = 0; k < count; ++k)
+        {
+            destination.unknownSeqno = (i.ReadU8() & (1 << 7));
+            ReadFrom(i, destination.address);
+            destination.seqNo = i.ReadNtohU32();
+            m_destinations.push_back(destination);
+        }
+    }
+    m_pathEtx = HasPathEtx() ? i.ReadNtohU16() : 0;
 
     uint32_t dist = i.GetDistanceFrom(start);
     NS_ASSERT(dist == GetSerializedSize());
@@ -211,6 +370,15 @@ RreqHeader::Print(std::ostream& os) const
        << " flags:"
        << " Gratuitous RREP " << (*this).GetGratuitousRrep() << " Destination only "
        << (*this).GetDestinationOnly() << " Unknown sequence number " << (*this).GetUnknownSeqno();
+    for (auto j = m_destinations.begin(); j != m_destinations.end(); ++j)
+    {
+        os << " additional destination: ipv4 " << j->address << " sequence number " << j->seqNo
+           << " Unknown sequence number " << j->unknownSeqno;
+    }
+    if (HasPathEtx())
+    {
+        os << " path ETX " << m_pathEtx / 100.0;
+    }
 }
 
 std::ostream&
@@ -277,12 +445,67 @@ RreqHeader::GetUnknownSeqno() const
     return (m_flags & (1 << 3));
 }
 
+bool
+RreqHeader::AddDestination(Ipv4Address dst, uint32_t dstSeqNo, bool unknownSeqno)
+{
+    if (m_destinations.size() == std::numeric_limits<uint8_t>::max())
+    {
+        return false;
+    }
+    m_destinations.push_back({dst, unknownSeqno ? 0 : dstSeqNo, unknownSeqno});
+    m_flags |= (1 << 2);
+    return true;
+}
+
+void
+RreqHeader::ClearDestinations()
+{
+    m_destinations.clear();
+    m_flags &= ~(1 << 2);
+}
+
+bool
+RreqHeader::GetMultiDestination() const
+{
+    return (m_flags & (1 << 2));
+}
+
+void
+RreqHeader::SetPathEtx(uint16_t etx)
+{
+    m_pathEtx = etx;
+    m_flags |= (1 << 1);
+}
+
+uint16_t
+RreqHeader::GetPathEtx() const
+{
+    return m_pathEtx;
+}
+
+bool
+RreqHeader::HasPathEtx() const
+{
+    return (m_flags & (1 << 1));
+}
+
+int32_t
+RreqHeader::GetCompactSavings() const
+{
+    if (!m_compact)
+    {
+        return 0;
+    }
+    return 23 - int32_t(CompactRequestSize(m_flags, m_requestID, m_dstSeqNo, m_originSeqNo));
+}
+
 bool
 RreqHeader::operator==(const RreqHeader& o) const
 {
     return (m_flags == o.m_flags && m_reserved == o.m_reserved && m_hopCount == o.m_hopCount &&
             m_requestID == o.m_requestID && m_dst == o.m_dst && m_dstSeqNo == o.m_dstSeqNo &&
-            m_origin == o.m_origin && m_originSeqNo == o.m_originSeqNo);
+            m_origin == o.m_origin && m_originSeqNo == o.m_originSeqNo &&
+            m_destinations == o.m_destinations && m_pathEtx == o.m_pathEtx);
 }
 
 //-----------------------------------------------------------------------------
@@ -303,7 +526,9 @@ RrevreqHeader::RrevreqHeader(uint8_t flags,
       m_dst(dst),
       m_dstSeqNo(dstSeqNo),
       m_origin(origin),
-      m_originSeqNo(originSeqNo)
+      m_originSeqNo(originSeqNo),
+      m_pathEtx(0),
+      m_compact(false)
 {
 }
 
@@ -328,34 +553,74 @@ RrevreqHeader::GetInstanceTypeId() const
 uint32_t
 RrevreqHeader::GetSerializedSize() const
 {
-    return 23;
+    uint32_t size = 23;
+    if (m_compact)
+    {
+        size = CompactRequestSize(m_flags, m_requestID, m_dstSeqNo, m_originSeqNo);
+    }
+    return HasPathEtx() ? size + 2 : size;
 }
 
 void
 RrevreqHeader::Serialize(Buffer::Iterator i) const
 {
-    i.WriteU8(m_flags);
-    i.WriteU8(m_reserved);
-    i.WriteU8(m_hopCount);
-    i.WriteHtonU32(m_requestID);
-    WriteTo(i, m_dst);
-    i.WriteHtonU32(m_dstSeqNo);
-    WriteTo(i, m_origin);
-    i.WriteHtonU32(m_originSeqNo);
+    if (m_compact)
+    {
+        i.WriteU8(m_flags);
+        i.WriteU8(m_hopCount);
+        WriteVarint(i, m_requestID);
+        WriteTo(i, m_dst);
+        if (!GetUnknownSeqno())
+        {
+            WriteVarint(i, m_dstSeqNo);
+        }
+        WriteTo(i, m_origin);
+        WriteVarint(i, m_originSeqNo);
+    }
+    else
+    {
+        i.WriteU8(m_flags);
+        i.WriteU8(m_reserved);
+        i.WriteU8(m_hopCount);
+        i.WriteHtonU32(m_requestID);
+        WriteTo(i, m_dst);
+        i.WriteHtonU32(m_dstSeqNo);
+        WriteTo(i, m_origin);
+        i.WriteHtonU32(m_originSeqNo);
+    }
+    if (HasPathEtx())
+    {
+        i.WriteHtonU16(m_pathEtx);
+    }
 }
 
 uint32_t
 RrevreqHeader::Deserialize(Buffer::Iterator start)
 {
     Buffer::Iterator i = start;
-    m_flags = i.ReadU8();
-    m_reserved = i.ReadU8();
-    m_hopCount = i.ReadU8();
-    m_requestID = i.ReadNtohU32();
-    ReadFrom(i, m_dst);
-    m_dstSeqNo = i.ReadNtohU32();
-    ReadFrom(i, m_origin);
-    m_originSeqNo = i.ReadNtohU32();
+    if (m_compact)
+    {
+        m_flags = i.ReadU8();
+        m_reserved = 0;
+        m_hopCount = i.ReadU8();
+        m_requestID = ReadVarint(i);
+        ReadFrom(i, m_dst);
+        m_dstSeqNo = GetUnknownSeqno() ? 0 : ReadVarint(i);
+        ReadFrom(i, m_origin);
+        m_originSeqNo = ReadVarint(i);
+    }
+    else
+    {
+        m_flags = i.ReadU8();
+        m_reserved = i.ReadU8();
+        m_hopCount = i.ReadU8();
+        m_requestID = i.ReadNtohU32();
+        ReadFrom(i, m_dst);
+        m_dstSeqNo = i.ReadNtohU32();
+        ReadFrom(i, m_origin);
+        m_originSeqNo = i.ReadNtohU32();
+    }
+    m_pathEtx = HasPathEtx() ? i.ReadNtohU16() : 0;
 
     uint32_t dist = i.GetDistanceFrom(start);
     NS_ASSERT(dist == GetSerializedSize());
@@ -370,6 +635,10 @@ RrevreqHeader::Print(std::ostream& os) const
        << " flags:"
        << " Gratuitous RREP " << (*this).GetGratuitousRrep() << " Destination only "
        << (*this).GetDestinationOnly() << " Unknown sequence number " << (*this).GetUnknownSeqno();
+    if (HasPathEtx())
+    {
+        os << " path ETX " << m_pathEtx / 100.0;
+    }
 }
 
 std::ostream&
@@ -436,12 +705,331 @@ RrevreqHeader::GetUnknownSeqno() const
     return (m_flags & (1 << 3));
 }
 
+void
+RrevreqHeader::SetPathEtx(uint16_t etx)
+{
+    m_pathEtx = etx;
+    m_flags |= (1 << 1);
+}
+
+uint16_t
+RrevreqHeader::GetPathEtx() const
+{
+    return m_pathEtx;
+}
+
+bool
+RrevreqHeader::HasPathEtx() const
+{
+    return (m_flags & (1 << 1));
+}
+
+int32_t
+RrevreqHeader::GetCompactSavings() const
+{
+    if (!m_compact)
+    {
+        return 0;
+    }
+    return 23 - int32_t(CompactRequestSize(m_flags, m_requestID, m_dstSeqNo, m_originSeqNo));
+}
+
 bool
 RrevreqHeader::operator==(const RrevreqHeader& o) const
 {
     return (m_flags == o.m_flags && m_reserved == o.m_reserved && m_hopCount == o.m_hopCount &&
             m_requestID == o.m_requestID && m_dst == o.m_dst && m_dstSeqNo == o.m_dstSeqNo &&
-            m_origin == o.m_origin && m_originSeqNo == o.m_originSeqNo);
+            m_origin == o.m_origin && m_originSeqNo == o.m_originSeqNo &&
+            m_pathEtx == o.m_pathEtx);
+}
+
+//-----------------------------------------------------------------------------
+// RREQ / REV_RREQ view
+//-----------------------------------------------------------------------------
+
+namespace
+{
+// Offsets into a serialized RREQ or REV_RREQ, type byte included
+const uint32_t VIEW_FLAGS = 1;       ///< Flags
+const uint32_t VIEW_HOP_COUNT = 3;   ///< Hop count
+const uint32_t VIEW_ID = 4;          ///< Request ID
+const uint32_t VIEW_DST = 8;         ///< Destination address
+const uint32_t VIEW_DST_SEQNO = 12;  ///< Destination sequence number
+const uint32_t VIEW_ORIGIN = 16;     ///< Originator address
+const uint32_t VIEW_FIXED_SIZE = 24; ///< Size without extensions
+} // namespace
+
+RequestView::RequestView(Ptr<const Packet> packet)
+    : m_data(packet->GetSize()),
+      m_valid(false),
+      m_hopCountOffset(0),
+      m_dstOffset(0),
+      m_dstSeqNoOffset(0),
+      m_originOffset(0),
+      m_fixedSize(0)
+{
+    packet->CopyData(m_data.data(), m_data.size());
+    Parse();
+}
+
+void
+RequestView::Parse()
+{
+    if (m_data.size() < 2)
+    {
+        return;
+    }
+    MessageType type = GetType();
+    if (type != AODVTYPE_RREQ && type != AODVTYPE_REV_RREQ && type != AODVTYPE_RREQ_COMPACT &&
+        type != AODVTYPE_REV_RREQ_COMPACT)
+    {
+        return;
+    }
+    uint8_t flags = m_data[VIEW_FLAGS];
+    uint32_t offset = VIEW_FIXED_SIZE;
+    if (!IsCompact())
+    {
+        m_hopCountOffset = VIEW_HOP_COUNT;
+        m_dstOffset = VIEW_DST;
+        m_dstSeqNoOffset = VIEW_DST_SEQNO;
+        m_originOffset = VIEW_ORIGIN;
+    }
+    else
+    {
+        m_hopCountOffset = VIEW_FLAGS + 1;
+        offset = m_hopCountOffset + 1;
+        if (!SkipVarint(offset))
+        {
+            return;
+        }
+        m_dstOffset = offset;
+        offset += 4;
+        m_dstSeqNoOffset = 0;
+        if (!(flags & (1 << 3)))
+        {
+            m_dstSeqNoOffset = offset;
+            if (!SkipVarint(offset))
+            {
+                return;
+            }
+        }
+        m_originOffset = offset;
+        offset += 4;
+        if (!SkipVarint(offset))
+        {
+            return;
+        }
+    }
+    uint32_t extensions = 0;
+    if ((type == AODVTYPE_RREQ || type == AODVTYPE_RREQ_COMPACT) && (flags & (1 << 2)))
+    {
+        if (offset >= m_data.size())
+        {
+            return;
+        }
+        extensions += 1 + 9 * m_data[offset];
+    }
+    if (flags & (1 << 1))
+    {
+        extensions += 2;
+    }
+    m_fixedSize = VIEW_FIXED_SIZE + extensions;
+    m_valid = (offset + extensions <= m_data.size());
+}
+
+bool
+RequestView::SkipVarint(uint32_t& offset) const
+{
+    for (uint32_t k = 0; k < 5; ++k)
+    {
+        if (offset >= m_data.size())
+        {
+            return false;
+        }
+        if (!(m_data[offset++] & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+MessageType
+RequestView::GetType() const
+{
+    return (MessageType)m_data[0];
+}
+
+bool
+RequestView::IsCompact() const
+{
+    return GetType() == AODVTYPE_RREQ_COMPACT || GetType() == AODVTYPE_REV_RREQ_COMPACT;
+}
+
+int32_t
+RequestView::GetCompactSavings() const
+{
+    return IsCompact() ? int32_t(m_fixedSize) - int32_t(m_data.size()) : 0;
+}
+
+void
+RequestView::SetHopCount(uint8_t count)
+{
+    m_data[m_hopCountOffset] = count;
+}
+
+uint8_t
+RequestView::GetHopCount() const
+{
+    return m_data[m_hopCountOffset];
+}
+
+uint32_t
+RequestView::GetId() const
+{
+    return ReadU32(IsCompact() ? m_hopCountOffset + 1 : VIEW_ID);
+}
+
+Ipv4Address
+RequestView::GetDst() const
+{
+    return Ipv4Address((uint32_t(m_data[m_dstOffset]) << 24) |
+                       (uint32_t(m_data[m_dstOffset + 1]) << 16) |
+                       (uint32_t(m_data[m_dstOffset + 2]) << 8) | m_data[m_dstOffset + 3]);
+}
+
+bool
+RequestView::SetDstSeqno(uint32_t seqno)
+{
+    if (m_dstSeqNoOffset == 0)
+    {
+        return false;
+    }
+    if (IsCompact())
+    {
+        uint32_t end = m_dstSeqNoOffset;
+        SkipVarint(end);
+        if (end - m_dstSeqNoOffset != VarintSize(seqno))
+        {
+            return false;
+        }
+        for (uint32_t k = m_dstSeqNoOffset; k < end; ++k, seqno >>= 7)
+        {
+            m_data[k] = (seqno & 0x7f) | (k + 1 < end ? 0x80 : 0);
+        }
+    }
+    else
+    {
+        WriteU32(m_dstSeqNoOffset, seqno);
+    }
+    m_data[VIEW_FLAGS] &= ~(1 << 3);
+    return true;
+}
+
+uint32_t
+RequestView::GetDstSeqno() const
+{
+    return m_dstSeqNoOffset == 0 ? 0 : ReadU32(m_dstSeqNoOffset);
+}
+
+Ipv4Address
+RequestView::GetOrigin() const
+{
+    return Ipv4Address((uint32_t(m_data[m_originOffset]) << 24) |
+                       (uint32_t(m_data[m_originOffset + 1]) << 16) |
+                       (uint32_t(m_data[m_originOffset + 2]) << 8) | m_data[m_originOffset + 3]);
+}
+
+bool
+RequestView::HasPathEtx() const
+{
+    return (m_data[VIEW_FLAGS] & (1 << 1));
+}
+
+void
+RequestView::SetPathEtx(uint16_t etx)
+{
+    NS_ASSERT(HasPathEtx());
+    // The path ETX is the trailing extension
+    m_data[m_data.size() - 2] = etx >> 8;
+    m_data[m_data.size() - 1] = etx & 0xff;
+}
+
+uint16_t
+RequestView::GetPathEtx() const
+{
+    if (!HasPathEtx())
+    {
+        return 0;
+    }
+    return (m_data[m_data.size() - 2] << 8) | m_data[m_data.size() - 1];
+}
+
+Ptr<Packet>
+RequestView::CreatePacket() const
+{
+    return Create<Packet>(m_data.data(), m_data.size());
+}
+
+bool
+RequestView::Deserialize(RreqHeader& header) const
+{
+    if (!m_valid || (GetType() != AODVTYPE_RREQ && GetType() != AODVTYPE_RREQ_COMPACT))
+    {
+        return false;
+    }
+    header.SetCompact(IsCompact());
+    return DeserializeHeader(header);
+}
+
+bool
+RequestView::Deserialize(RrevreqHeader& header) const
+{
+    if (!m_valid || (GetType() != AODVTYPE_REV_RREQ && GetType() != AODVTYPE_REV_RREQ_COMPACT))
+    {
+        return false;
+    }
+    header.SetCompact(IsCompact());
+    return DeserializeHeader(header);
+}
+
+bool
+RequestView::DeserializeHeader(Header& header) const
+{
+    Buffer buffer;
+    buffer.AddAtStart(m_data.size() - 1);
+    buffer.Begin().Write(m_data.data() + 1, m_data.size() - 1);
+    return header.Deserialize(buffer.Begin()) == m_data.size() - 1;
+}
+
+uint32_t
+RequestView::ReadU32(uint32_t offset) const
+{
+    if (IsCompact())
+    {
+        uint32_t value = 0;
+        for (uint32_t shift = 0; shift < 35; shift += 7)
+        {
+            uint8_t byte = m_data[offset++];
+            value |= uint32_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+            {
+                break;
+            }
+        }
+        return value;
+    }
+    return (uint32_t(m_data[offset]) << 24) | (uint32_t(m_data[offset + 1]) << 16) |
+           (uint32_t(m_data[offset + 2]) << 8) | m_data[offset + 3];
+}
+
+void
+RequestView::WriteU32(uint32_t offset, uint32_t value)
+{
+    m_data[offset] = value >> 24;
+    m_data[offset + 1] = (value >> 16) & 0xff;
+    m_data[offset + 2] = (value >> 8) & 0xff;
+    m_data[offset + 3] = value & 0xff;
 }
 
 //-----------------------------------------------------------------------------
@@ -774,7 +1362,10 @@ RerrHeader::AddUnDestination(Ipv4Address dst, uint32_t seqNo)
         return true;
     }
 
-    NS_ASSERT(GetDestCount() < 255); // can't support more than 255 destinations in single RERR
+    if (GetDestCount() == std::numeric_limits<uint8_t>::max())
+    {
+        return false;
+    }
     m_unreachableDstSeqNo.insert(std::make_pair(dst, seqNo));
     return true;
 }
@@ -829,5 +1420,177 @@ operator<<(std::ostream& os, const RerrHeader& h)
     h.Print(os);
     return os;
 }
+
+//-----------------------------------------------------------------------------
+// PIGGYBACK
+//-----------------------------------------------------------------------------
+PiggybackHeader::PiggybackHeader()
+    : m_flags(0)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED(PiggybackHeader);
+
+TypeId
+PiggybackHeader::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::aodv::PiggybackHeader")
+                            .SetParent<Header>()
+                            .SetGroupName("Aodv")
+                            .AddConstructor<PiggybackHeader>();
+    return tid;
+}
+
+TypeId
+PiggybackHeader::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+uint32_t
+PiggybackHeader::GetSerializedSize() const
+{
+    uint32_t size = 5;
+    if (HasHello())
+    {
+        size += m_hello.GetSerializedSize();
+    }
+    if (HasRerr())
+    {
+        size += m_rerr.GetSerializedSize();
+    }
+    return size;
+}
+
+void
+PiggybackHeader::Serialize(Buffer::Iterator i) const
+{
+    i.WriteU8(m_flags);
+    WriteTo(i, m_sender);
+    if (HasHello())
+    {
+        m_hello.Serialize(i);
+        i.Next(m_hello.GetSerializedSize());
+    }
+    if (HasRerr())
+    {
+        m_rerr.Serialize(i);
+    }
+}
+
+uint32_t
+PiggybackHeader::Deserialize(Buffer::Iterator start)
+{
+    Buffer::Iterator i = start;
+    m_flags = i.ReadU8();
+    ReadFrom(i, m_sender);
+    if (HasHello())
+    {
+        i.Next(m_hello.Deserialize(i));
+    }
+    if (HasRerr())
+    {
+        i.Next(m_rerr.Deserialize(i));
+    }
+
+    uint32_t dist = i.GetDistanceFrom(start);
+    NS_ASSERT(dist == GetSerializedSize());
+    return dist;
+}
+
+void
+PiggybackHeader::Print(std::ostream& os) const
+{
+    os << "sender " << m_sender;
+    if (HasHello())
+    {
+        os << " hello {" << m_hello << "}";
+    }
+    if (HasRerr())
+    {
+        os << " rerr {" << m_rerr << "}";
+    }
+}
+
+void
+PiggybackHeader::SetHello(const RrepHeader& hello)
+{
+    m_hello = hello;
+    m_flags |= HELLO;
+}
+
+bool
+PiggybackHeader::HasHello() const
+{
+    return (m_flags & HELLO) != 0;
+}
+
+void
+PiggybackHeader::SetRerr(const RerrHeader& rerr)
+{
+    m_rerr = rerr;
+    m_flags |= RERR;
+}
+
+bool
+PiggybackHeader::HasRerr() const
+{
+    return (m_flags & RERR) != 0;
+}
+
+bool
+PiggybackHeader::operator==(const PiggybackHeader& o) const
+{
+    return m_flags == o.m_flags && m_sender == o.m_sender &&
+           (!HasHello() || m_hello == o.m_hello) && (!HasRerr() || m_rerr == o.m_rerr);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const PiggybackHeader& h)
+{
+    h.Print(os);
+    return os;
+}
+
+NS_OBJECT_ENSURE_REGISTERED(PiggybackTag);
+
+TypeId
+PiggybackTag::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::aodv::PiggybackTag")
+                            .SetParent<Tag>()
+                            .SetGroupName("Aodv")
+                            .AddConstructor<PiggybackTag>();
+    return tid;
+}
+
+TypeId
+PiggybackTag::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+uint32_t
+PiggybackTag::GetSerializedSize() const
+{
+    return 0;
+}
+
+void
+PiggybackTag::Serialize(TagBuffer i) const
+{
+}
+
+void
+PiggybackTag::Deserialize(TagBuffer i)
+{
+}
+
+void
+PiggybackTag::Print(std::ostream& os) const
+{
+    os << "PiggybackTag";
+}
+
 } // namespace aodv
 } // namespace ns3
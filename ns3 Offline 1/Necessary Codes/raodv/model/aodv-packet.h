@@ -20,9 +20,12 @@
 #include "ns3/header.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/tag.h"
 
 #include <iostream>
 #include <map>
+#include <vector>
 
 namespace ns3
 {
@@ -40,6 +43,8 @@ enum MessageType
     AODVTYPE_RREP = 3,    //!< AODVTYPE_RREP
     AODVTYPE_RERR = 4,    //!< AODVTYPE_RERR
     AODVTYPE_RREP_ACK = 5, //!< AODVTYPE_RREP_ACK
+    AODVTYPE_RREQ_COMPACT = 6,     //!< AODVTYPE_RREQ_COMPACT
+    AODVTYPE_REV_RREQ_COMPACT = 7, //!< AODVTYPE_REV_RREQ_COMPACT
 };
 
 /**
@@ -110,7 +115,7 @@ std::ostream& operator<<(std::ostream& os, const TypeHeader& h);
   0                   1                   2                   3
   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-  |     Type      |J|R|G|D|U|   Reserved          |   Hop Count   |
+  |     Type      |J|R|G|D|U|M|E|   Reserved      |   Hop Count   |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                            RREQ ID                            |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -123,10 +128,65 @@ std::ostream& operator<<(std::ostream& os, const TypeHeader& h);
   |                  Originator Sequence Number                   |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   \endverbatim
+
+  If the M (multi-destination) flag is set the message carries an extension
+  with further destinations, each with its own sequence number. The U flag of
+  an entry has the meaning of the U flag of the message; the sequence number
+  of such an entry is 0 and must be ignored:
+  \verbatim
+  +-+-+-+-+-+-+-+-+
+  |   DestCount   |
+  +-+-+-+-+-+-+-+-+
+  |U|  Reserved   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |          Additional Destination IP Address (1)                |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |       Additional Destination Sequence Number (1)              |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |  ... (DestCount entries)                                      |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+
+  If the E (ETX) flag is set the accumulated path ETX, in hundredths of an
+  expected transmission, follows the message (after the M extension, if any):
+  \verbatim
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |           Path ETX            |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+
+  The compact encoding (message type AODVTYPE_RREQ_COMPACT) drops the reserved
+  byte, codes the RREQ ID and both sequence numbers as varints (7 bits per byte,
+  least significant group first, high bit set on all but the last byte) and
+  leaves the destination sequence number out when the U flag is set. The
+  extensions are unchanged:
+  \verbatim
+  |J|R|G|D|U|M|E| Hop Count | RREQ ID (1-5) | Destination IP Address (4) |
+  | Destination Sequence Number (0-5) | Originator IP Address (4) |
+  | Originator Sequence Number (1-5) | [extensions] |
+  \endverbatim
 */
 class RreqHeader : public Header
 {
   public:
+    /// An additional destination of the multi-destination extension
+    struct Destination
+    {
+        Ipv4Address address; ///< Destination IP address
+        uint32_t seqNo;      ///< Destination sequence number, 0 if unknownSeqno is set
+        bool unknownSeqno;   ///< No sequence number is known for the destination (U flag)
+
+        /**
+         * \brief Comparison operator
+         * \param o destination to compare
+         * \return true if the destinations are equal
+         */
+        bool operator==(const Destination& o) const
+        {
+            return address == o.address && seqNo == o.seqNo && unknownSeqno == o.unknownSeqno;
+        }
+    };
+
     /**
      * constructor
      *
@@ -300,6 +360,73 @@ class RreqHeader : public Header
      */
     bool GetUnknownSeqno() const;
 
+    // Multi-destination extension
+    /**
+     * \brief Add a destination to the multi-destination extension and set the M flag
+     * \param dst the additional destination IP address
+     * \param dstSeqNo the destination sequence number, ignored if unknownSeqno is set
+     * \param unknownSeqno true if no sequence number is known for the destination
+     * \return false if we already added maximum possible number of additional destinations
+     */
+    bool AddDestination(Ipv4Address dst, uint32_t dstSeqNo, bool unknownSeqno = false);
+    /// Remove all additional destinations and clear the M flag
+    void ClearDestinations();
+    /**
+     * \brief Get the multi-destination flag
+     * \return true if the message carries additional destinations
+     */
+    bool GetMultiDestination() const;
+
+    /**
+     * \returns the additional destinations; the destination stored in the fixed part of the
+     * message is not included
+     */
+    const std::vector<Destination>& GetDestinations() const
+    {
+        return m_destinations;
+    }
+
+    // ETX extension
+    /**
+     * \brief Set the accumulated path ETX and the E flag
+     * \param etx the path ETX in hundredths of an expected transmission
+     */
+    void SetPathEtx(uint16_t etx);
+    /**
+     * \brief Get the accumulated path ETX
+     * \return the path ETX in hundredths of an expected transmission, 0 if the E flag is not set
+     */
+    uint16_t GetPathEtx() const;
+    /**
+     * \brief Get the ETX flag
+     * \return true if the message carries the path ETX
+     */
+    bool HasPathEtx() const;
+
+    /**
+     * \brief Select the compact encoding, used by AODVTYPE_RREQ_COMPACT messages
+     * \param compact true to (de)serialize in the compact encoding
+     */
+    void SetCompact(bool compact)
+    {
+        m_compact = compact;
+    }
+
+    /**
+     * \brief Get the encoding
+     * \return true if the header is (de)serialized in the compact encoding
+     */
+    bool IsCompact() const
+    {
+        return m_compact;
+    }
+
+    /**
+     * \return the bytes the compact encoding saves over the fixed one, 0 if not compact and
+     *         negative if the varints outgrow the fixed fields
+     */
+    int32_t GetCompactSavings() const;
+
     /**
      * \brief Comparison operator
      * \param o RREQ header to compare
@@ -308,7 +435,7 @@ class RreqHeader : public Header
     bool operator==(const RreqHeader& o) const;
 
   private:
-    uint8_t m_flags;        ///< |J|R|G|D|U| bit flags, see RFC
+    uint8_t m_flags;        ///< |J|R|G|D|U|M|E| bit flags, see RFC
     uint8_t m_reserved;     ///< Not used (must be 0)
     uint8_t m_hopCount;     ///< Hop Count
     uint32_t m_requestID;   ///< RREQ ID
@@ -316,6 +443,9 @@ class RreqHeader : public Header
     uint32_t m_dstSeqNo;    ///< Destination Sequence Number
     Ipv4Address m_origin;   ///< Originator IP Address
     uint32_t m_originSeqNo; ///< Source Sequence Number
+    std::vector<Destination> m_destinations; ///< Additional destinations (M flag)
+    uint16_t m_pathEtx; ///< Accumulated path ETX in hundredths (E flag)
+    bool m_compact;     ///< Compact encoding (AODVTYPE_RREQ_COMPACT)
 };
 
 /**
@@ -501,6 +631,47 @@ class RrevreqHeader : public Header
      */
     bool GetUnknownSeqno() const;
 
+    // ETX extension
+    /**
+     * \brief Set the accumulated path ETX and the E flag
+     * \param etx the path ETX in hundredths of an expected transmission
+     */
+    void SetPathEtx(uint16_t etx);
+    /**
+     * \brief Get the accumulated path ETX
+     * \return the path ETX in hundredths of an expected transmission, 0 if the E flag is not set
+     */
+    uint16_t GetPathEtx() const;
+    /**
+     * \brief Get the ETX flag
+     * \return true if the message carries the path ETX
+     */
+    bool HasPathEtx() const;
+
+    /**
+     * \brief Select the compact encoding, used by AODVTYPE_REV_RREQ_COMPACT messages
+     * \param compact true to (de)serialize in the compact encoding
+     */
+    void SetCompact(bool compact)
+    {
+        m_compact = compact;
+    }
+
+    /**
+     * \brief Get the encoding
+     * \return true if the header is (de)serialized in the compact encoding
+     */
+    bool IsCompact() const
+    {
+        return m_compact;
+    }
+
+    /**
+     * \return the bytes the compact encoding saves over the fixed one, 0 if not compact and
+     *         negative if the varints outgrow the fixed fields
+     */
+    int32_t GetCompactSavings() const;
+
     /**
      * \brief Comparison operator
      * \param o RREQ header to compare
@@ -509,7 +680,7 @@ class RrevreqHeader : public Header
     bool operator==(const RrevreqHeader& o) const;
 
   private:
-    uint8_t m_flags;        ///< |J|R|G|D|U| bit flags, see RFC
+    uint8_t m_flags;        ///< |J|R|G|D|U|E| bit flags, see RFC
     uint8_t m_reserved;     ///< Not used (must be 0)
     uint8_t m_hopCount;     ///< Hop Count
     uint32_t m_requestID;   ///< RREQ ID
@@ -517,10 +688,167 @@ class RrevreqHeader : public Header
     uint32_t m_dstSeqNo;    ///< Destination Sequence Number
     Ipv4Address m_origin;   ///< Originator IP Address
     uint32_t m_originSeqNo; ///< Source Sequence Number
+    uint16_t m_pathEtx;     ///< Accumulated path ETX in hundredths (E flag)
+    bool m_compact;         ///< Compact encoding (AODVTYPE_REV_RREQ_COMPACT)
 };
 
 std::ostream& operator<<(std::ostream& os, const RrevreqHeader&);
 
+/**
+ * \ingroup aodv
+ * \brief Read and patch access to a serialized RREQ or REV_RREQ, type byte included
+ *
+ * The message is copied out of the received packet once and the offsets of its fields are
+ * located, so duplicates can be dropped without decoding the whole header. New requests are
+ * decoded from that copy with Deserialize(). The fields a forwarding node changes are
+ * rewritten in place and CreatePacket() hands back the rebroadcast without serializing the
+ * headers again. Both the fixed and the compact encodings are understood.
+ */
+class RequestView
+{
+  public:
+    /**
+     * constructor
+     * \param packet the received packet, starting with the TypeHeader
+     */
+    RequestView(Ptr<const Packet> packet);
+
+    /**
+     * \returns true if the bytes hold a complete RREQ or REV_RREQ
+     */
+    bool IsValid() const
+    {
+        return m_valid;
+    }
+    /**
+     * \returns the message type
+     */
+    MessageType GetType() const;
+    /**
+     * \returns true if the message uses the compact encoding
+     */
+    bool IsCompact() const;
+    /**
+     * \returns the bytes the compact encoding saves over the fixed one, 0 if not compact
+     */
+    int32_t GetCompactSavings() const;
+    /**
+     * \returns the serialized size, type byte included
+     */
+    uint32_t GetSize() const
+    {
+        return m_data.size();
+    }
+
+    /**
+     * \brief Set the hop count
+     * \param count the hop count
+     */
+    void SetHopCount(uint8_t count);
+    /**
+     * \returns the hop count
+     */
+    uint8_t GetHopCount() const;
+    /**
+     * \returns the request ID
+     */
+    uint32_t GetId() const;
+    /**
+     * \returns the destination address
+     */
+    Ipv4Address GetDst() const;
+    /**
+     * \brief Set the destination sequence number and clear the U flag
+     *
+     * Fails if the new value does not fit in place, i.e. in the compact encoding when the
+     * field is absent (U flag) or its varint length would change.
+     *
+     * \param seqno the destination sequence number
+     * \returns true if the message was patched
+     */
+    bool SetDstSeqno(uint32_t seqno);
+    /**
+     * \returns the destination sequence number
+     */
+    uint32_t GetDstSeqno() const;
+    /**
+     * \returns the origin address
+     */
+    Ipv4Address GetOrigin() const;
+    /**
+     * \returns true if the message carries the path ETX extension (E flag)
+     */
+    bool HasPathEtx() const;
+    /**
+     * \brief Set the path ETX, the extension must be present
+     * \param etx the path ETX in hundredths
+     */
+    void SetPathEtx(uint16_t etx);
+    /**
+     * \returns the path ETX in hundredths, 0 without the extension
+     */
+    uint16_t GetPathEtx() const;
+
+    /**
+     * \returns a new packet holding the (patched) message
+     */
+    Ptr<Packet> CreatePacket() const;
+
+    /**
+     * \brief Decode the whole RREQ from the bytes of the view
+     *
+     * The received packet is not parsed a second time. The encoding of the header follows the
+     * message type.
+     *
+     * \param header the header to fill
+     * \returns true if the view holds a RREQ that decodes to exactly its size
+     */
+    bool Deserialize(RreqHeader& header) const;
+    /**
+     * \brief Decode the whole REV_RREQ from the bytes of the view
+     * \param header the header to fill
+     * \returns true if the view holds a REV_RREQ that decodes to exactly its size
+     */
+    bool Deserialize(RrevreqHeader& header) const;
+
+  private:
+    /**
+     * \brief Decode the message with the Deserialize() of its header class
+     * \param header the header to fill, its encoding already set
+     * \returns true if the header consumed every byte after the type byte
+     */
+    bool DeserializeHeader(Header& header) const;
+    /**
+     * \brief Locate the fields and check the message is complete
+     */
+    void Parse();
+    /**
+     * \brief Step over a varint
+     * \param offset byte offset of the varint, moved past it
+     * \returns false if the varint runs past the message or is longer than 5 bytes
+     */
+    bool SkipVarint(uint32_t& offset) const;
+    /**
+     * \param offset byte offset into the message
+     * \returns the 32-bit field at offset, big-endian or varint depending on the encoding
+     */
+    uint32_t ReadU32(uint32_t offset) const;
+    /**
+     * \brief Write a 32-bit value in network order
+     * \param offset byte offset into the message
+     * \param value the value
+     */
+    void WriteU32(uint32_t offset, uint32_t value);
+
+    std::vector<uint8_t> m_data; ///< Message bytes, type byte included
+    bool m_valid;                ///< Message is a complete RREQ or REV_RREQ
+    uint32_t m_hopCountOffset;   ///< Offset of the hop count
+    uint32_t m_dstOffset;        ///< Offset of the destination address
+    uint32_t m_dstSeqNoOffset;   ///< Offset of the destination sequence number, 0 if absent
+    uint32_t m_originOffset;     ///< Offset of the originator address
+    uint32_t m_fixedSize;        ///< Size of the message in the fixed encoding
+};
+
 /**
 * \ingroup aodv
 * \brief Route Reply (RREP) Message Format
@@ -850,6 +1178,142 @@ class RerrHeader : public Header
  */
 std::ostream& operator<<(std::ostream& os, const RerrHeader&);
 
+/**
+* \ingroup aodv
+* \brief Shim header that carries pending hello and RERR state on a unicast data packet
+  \verbatim
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |H|R|  Reserved |            Sender IP address (first 24 bits)  |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |  (last 8 bits)| Hello (RREP, if H) ...  | RERR (if R) ...     |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+*
+* The shim sits between the IP header and the transport header. Its presence is
+* signalled by a PiggybackTag, so it never reaches a node that does not expect it.
+*/
+class PiggybackHeader : public Header
+{
+  public:
+    /// constructor
+    PiggybackHeader();
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+    uint32_t GetSerializedSize() const override;
+    void Serialize(Buffer::Iterator i) const override;
+    uint32_t Deserialize(Buffer::Iterator start) override;
+    void Print(std::ostream& os) const override;
+
+    /**
+     * \brief Set the address of the interface that sent the data packet
+     * \param a the sender address
+     */
+    void SetSender(Ipv4Address a)
+    {
+        m_sender = a;
+    }
+
+    /**
+     * \brief Get the address of the interface that sent the data packet
+     * \return the sender address
+     */
+    Ipv4Address GetSender() const
+    {
+        return m_sender;
+    }
+
+    /**
+     * \brief Attach a hello message
+     * \param hello the hello (RREP) header
+     */
+    void SetHello(const RrepHeader& hello);
+    /**
+     * \brief Check whether a hello message is attached
+     * \return true if the shim carries a hello
+     */
+    bool HasHello() const;
+    /**
+     * \brief Get the attached hello message
+     * \return the hello (RREP) header
+     */
+    const RrepHeader& GetHello() const
+    {
+        return m_hello;
+    }
+
+    /**
+     * \brief Attach a route error
+     * \param rerr the RERR header
+     */
+    void SetRerr(const RerrHeader& rerr);
+    /**
+     * \brief Check whether a route error is attached
+     * \return true if the shim carries a RERR
+     */
+    bool HasRerr() const;
+    /**
+     * \brief Get the attached route error
+     * \return the RERR header
+     */
+    const RerrHeader& GetRerr() const
+    {
+        return m_rerr;
+    }
+
+    /**
+     * \brief Comparison operator
+     * \param o piggyback header to compare
+     * \return true if the headers are equal
+     */
+    bool operator==(const PiggybackHeader& o) const;
+
+  private:
+    /// Flag bits of the shim
+    enum Flags
+    {
+        HELLO = 0x80, ///< a hello follows
+        RERR = 0x40,  ///< a RERR follows
+    };
+
+    uint8_t m_flags;      ///< HELLO and RERR flag bits
+    Ipv4Address m_sender; ///< Address of the sending interface
+    RrepHeader m_hello;   ///< Attached hello, valid if HELLO is set
+    RerrHeader m_rerr;    ///< Attached RERR, valid if RERR is set
+};
+
+/**
+ * \brief Stream output operator
+ * \param os output stream
+ * \return updated stream
+ */
+std::ostream& operator<<(std::ostream& os, const PiggybackHeader&);
+
+/**
+ * \ingroup aodv
+ * \brief Packet tag marking a data packet that carries a PiggybackHeader
+ */
+class PiggybackTag : public Tag
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+    uint32_t GetSerializedSize() const override;
+    void Serialize(TagBuffer i) const override;
+    void Deserialize(TagBuffer i) override;
+    void Print(std::ostream& os) const override;
+};
+
 } // namespace aodv
 } // namespace ns3
 
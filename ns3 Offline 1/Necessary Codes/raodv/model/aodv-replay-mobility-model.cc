@@ -0,0 +1,86 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Mobility model that replays recorded straight-line segments.
+ */
+
+#include "aodv-replay-mobility-model.h"
+
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(AodvReplayMobilityModel);
+
+TypeId
+AodvReplayMobilityModel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::AodvReplayMobilityModel")
+                            .SetParent<MobilityModel>()
+                            .SetGroupName("Aodv")
+                            .AddConstructor<AodvReplayMobilityModel>();
+    return tid;
+}
+
+void
+AodvReplayMobilityModel::AddSegment(const Segment& segment)
+{
+    NS_ABORT_MSG_IF(!m_segments.empty() && segment.start < m_segments.back().start,
+                    "Segments must be added in time order");
+    m_segments.push_back(segment);
+}
+
+const AodvReplayMobilityModel::Segment&
+AodvReplayMobilityModel::GetCurrent() const
+{
+    NS_ABORT_MSG_IF(m_segments.empty(), "Replay mobility model without a trajectory");
+    // Simulation time only moves forward, so the lookup continues from the previous segment
+    Time now = Simulator::Now();
+    if (now < m_segments[m_current].start)
+    {
+        m_current = 0;
+    }
+    while (m_current + 1 < m_segments.size() && m_segments[m_current + 1].start <= now)
+    {
+        m_current++;
+    }
+    return m_segments[m_current];
+}
+
+Vector
+AodvReplayMobilityModel::DoGetPosition() const
+{
+    const Segment& segment = GetCurrent();
+    double t = (Simulator::Now() - segment.start).GetSeconds();
+    if (t <= 0)
+    {
+        return segment.position;
+    }
+    return Vector(segment.position.x + segment.velocity.x * t,
+                  segment.position.y + segment.velocity.y * t,
+                  segment.position.z + segment.velocity.z * t);
+}
+
+void
+AodvReplayMobilityModel::DoSetPosition(const Vector& position)
+{
+    Time now = Simulator::Now();
+    while (!m_segments.empty() && m_segments.back().start >= now)
+    {
+        m_segments.pop_back();
+    }
+    m_segments.push_back({now, position, Vector()});
+    m_current = 0;
+    NotifyCourseChange();
+}
+
+Vector
+AodvReplayMobilityModel::DoGetVelocity() const
+{
+    const Segment& segment = GetCurrent();
+    return Simulator::Now() < segment.start ? Vector() : segment.velocity;
+}
+
+} // namespace ns3
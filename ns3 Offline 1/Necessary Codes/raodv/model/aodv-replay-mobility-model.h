@@ -0,0 +1,74 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Mobility model that replays recorded straight-line segments.
+ */
+
+#ifndef AODV_REPLAY_MOBILITY_MODEL_H
+#define AODV_REPLAY_MOBILITY_MODEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3
+{
+/**
+ * \ingroup aodv
+ * \brief Moves a node along a recorded trajectory of straight-line segments.
+ *
+ * Each segment is the time it starts, the position there and the velocity until the next
+ * segment starts. The position is computed when asked for, so a replay draws no random numbers
+ * and schedules no events; for the same reason no CourseChange is reported while replaying.
+ * Before the first segment the node stands at its starting position. Setting the position
+ * replaces the rest of the trajectory with a standstill there.
+ */
+class AodvReplayMobilityModel : public MobilityModel
+{
+  public:
+    /// A straight-line piece of the trajectory
+    struct Segment
+    {
+        Time start;      ///< time the segment starts
+        Vector position; ///< position at start
+        Vector velocity; ///< velocity until the next segment
+    };
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * Append a segment to the trajectory
+     * \param segment the segment, starting no earlier than the previous one
+     */
+    void AddSegment(const Segment& segment);
+
+    /**
+     * \returns the number of segments of the trajectory
+     */
+    uint32_t GetSegments() const
+    {
+        return m_segments.size();
+    }
+
+  private:
+    Vector DoGetPosition() const override;
+    void DoSetPosition(const Vector& position) override;
+    Vector DoGetVelocity() const override;
+
+    /**
+     * \returns the segment the node is on now
+     */
+    const Segment& GetCurrent() const;
+
+    std::vector<Segment> m_segments; ///< Trajectory, in time order
+    mutable uint32_t m_current{0};   ///< Index of the segment found by the last lookup
+};
+
+} // namespace ns3
+
+#endif /* AODV_REPLAY_MOBILITY_MODEL_H */
@@ -21,6 +21,7 @@
 
 #include "aodv-routing-protocol.h"
 
+#include "ns3/abort.h"
 #include "ns3/adhoc-wifi-mac.h"
 #include "ns3/boolean.h"
 #include "ns3/inet-socket-address.h"
@@ -29,13 +30,17 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/string.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/uinteger.h"
 #include "ns3/udp-header.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/wifi-mac-header.h"
 #include "ns3/wifi-mpdu.h"
 #include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
 namespace ns3
@@ -147,6 +152,10 @@ RoutingProtocol::RoutingProtocol()
       m_myRouteTimeout(Time(2 * std::max(m_pathDiscoveryTime, m_activeRouteTimeout))),
       m_helloInterval(Seconds(1)),
       m_allowedHelloLoss(2),
+      m_adaptiveHello(false),
+      m_minHelloInterval(MilliSeconds(500)),
+      m_maxHelloInterval(Seconds(5)),
+      m_currentHelloInterval(m_helloInterval),
       m_deletePeriod(Time(5 * std::max(m_activeRouteTimeout, m_helloInterval))),
       m_nextHopWait(m_nodeTraversalTime + MilliSeconds(10)),
       m_blackListTimeout(Time(m_rreqRetries * m_netTraversalTime)),
@@ -155,6 +164,13 @@ RoutingProtocol::RoutingProtocol()
       m_destinationOnly(false),
       m_gratuitousReply(true),
       m_enableHello(false),
+      m_enablePassiveSensing(false),
+      m_enableEtx(false),
+      m_compactControlMessages(false),
+      m_rreqAggregationDelay(Seconds(0)),
+      m_rerrAggregationWindow(Seconds(0)),
+      m_enablePiggyback(false),
+      m_enableReverseRequest(true),
       m_routingTable(m_deletePeriod),
       m_queue(m_maxQueueLen, m_maxQueueTime),
       m_requestId(0),
@@ -164,12 +180,35 @@ RoutingProtocol::RoutingProtocol()
       m_nb(m_helloInterval),
       m_rreqCount(0),
       m_rerrCount(0),
+      m_routeDiscoveries(0),
+      m_compactBytesSaved(0),
+      m_rreqSent(0),
+      m_rreqReceived(0),
+      m_rreqForwarded(0),
+      m_revRreqSent(0),
+      m_revRreqReceived(0),
+      m_revRreqForwarded(0),
+      m_rrepSent(0),
+      m_rrepReceived(0),
+      m_rrepForwarded(0),
+      m_rerrSent(0),
+      m_rerrReceived(0),
+      m_rerrForwarded(0),
+      m_duplicateRequests(0),
+      m_rateLimited(0),
+      m_dataForwarded(0),
+      m_dataBytesForwarded(0),
       m_htimer(Timer::CANCEL_ON_DESTROY),
       m_rreqRateLimitTimer(Timer::CANCEL_ON_DESTROY),
       m_rerrRateLimitTimer(Timer::CANCEL_ON_DESTROY),
-      m_lastBcastTime(Seconds(0))
+      m_rreqAggregationTimer(Timer::CANCEL_ON_DESTROY),
+      m_rerrAggregationTimer(Timer::CANCEL_ON_DESTROY),
+      m_lastBcastTime(Seconds(0)),
+      m_lastTxTime(Seconds(0))
 {
     m_nb.SetCallback(MakeCallback(&RoutingProtocol::SendRerrWhenBreaksLinkToNextHop, this));
+    m_routingTable.SetRouteValidCallback(MakeCallback(&RoutingProtocol::RouteBecameValid, this));
+    m_queue.SetDropCallback(MakeCallback(&RoutingProtocol::NotifyQueueDrop, this));
 }
 
 TypeId
@@ -181,7 +220,7 @@ RoutingProtocol::GetTypeId()
             .SetGroupName("Aodv")
             .AddConstructor<RoutingProtocol>()
             .AddAttribute("HelloInterval",
-                          "HELLO messages emission interval.",
+                          "HELLO messages emission interval, the initial one with AdaptiveHello.",
                           TimeValue(Seconds(1)),
                           MakeTimeAccessor(&RoutingProtocol::m_helloInterval),
                           MakeTimeChecker())
@@ -296,6 +335,22 @@ RoutingProtocol::GetTypeId()
                           UintegerValue(2),
                           MakeUintegerAccessor(&RoutingProtocol::m_allowedHelloLoss),
                           MakeUintegerChecker<uint16_t>())
+            .AddAttribute("AdaptiveHello",
+                          "Adjust HelloInterval to the observed neighbor churn, within "
+                          "[MinHelloInterval, MaxHelloInterval].",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_adaptiveHello),
+                          MakeBooleanChecker())
+            .AddAttribute("MinHelloInterval",
+                          "Lower bound of the adaptive hello interval.",
+                          TimeValue(MilliSeconds(500)),
+                          MakeTimeAccessor(&RoutingProtocol::m_minHelloInterval),
+                          MakeTimeChecker())
+            .AddAttribute("MaxHelloInterval",
+                          "Upper bound of the adaptive hello interval.",
+                          TimeValue(Seconds(5)),
+                          MakeTimeAccessor(&RoutingProtocol::m_maxHelloInterval),
+                          MakeTimeChecker())
             .AddAttribute("GratuitousReply",
                           "Indicates whether a gratuitous RREP should be unicast to the node "
                           "originated route discovery.",
@@ -321,11 +376,220 @@ RoutingProtocol::GetTypeId()
                           MakeBooleanAccessor(&RoutingProtocol::SetBroadcastEnable,
                                               &RoutingProtocol::GetBroadcastEnable),
                           MakeBooleanChecker())
+            .AddAttribute("EnablePassiveNeighborSensing",
+                          "Refresh neighbors from any overheard frame and send a hello only "
+                          "when the node has been silent for longer than HelloInterval.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_enablePassiveSensing),
+                          MakeBooleanChecker())
+            .AddAttribute("EnableEtx",
+                          "Estimate link delivery ratios from hello loss and prefer the reverse "
+                          "route with the lowest accumulated ETX instead of the fewest hops. "
+                          "Hellos are never suppressed while enabled.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_enableEtx),
+                          MakeBooleanChecker())
+            .AddAttribute("CompactControlMessages",
+                          "Originate RREQs and REV_RREQs in the compact encoding (varint IDs "
+                          "and sequence numbers, no reserved byte, no unknown destination "
+                          "sequence number). Must be supported by every node of the network; "
+                          "received requests are forwarded in the encoding they arrived in.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_compactControlMessages),
+                          MakeBooleanChecker())
+            .AddAttribute("RreqAggregationDelay",
+                          "Time a locally originated route discovery is held back so that "
+                          "discoveries for other destinations started meanwhile share one "
+                          "multi-destination RREQ. Zero disables aggregation.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_rreqAggregationDelay),
+                          MakeTimeChecker())
+            .AddAttribute("RerrAggregationWindow",
+                          "Time unreachable destinations are collected before they are reported, "
+                          "so that they share as few RERR messages per interface as possible. "
+                          "RERRs over the rate limit are deferred rather than dropped. "
+                          "Zero disables aggregation.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_rerrAggregationWindow),
+                          MakeTimeChecker())
+            .AddAttribute("EnablePiggyback",
+                          "Let a unicast data packet that leaves within the jitter of a pending "
+                          "hello, or the aggregation window of a RERR due to its next hop alone, "
+                          "carry that message in a shim header instead of a separate broadcast.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_enablePiggyback),
+                          MakeBooleanChecker())
+            .AddAttribute("EnableReverseRequest",
+                          "Let the destination of a RREQ answer with a REV_RREQ flooded back to "
+                          "the originator (R-AODV) instead of a unicast RREP along the reverse "
+                          "route (AODV).",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&RoutingProtocol::m_enableReverseRequest),
+                          MakeBooleanChecker())
             .AddAttribute("UniformRv",
                           "Access to the underlying UniformRandomVariable",
                           StringValue("ns3::UniformRandomVariable"),
                           MakePointerAccessor(&RoutingProtocol::m_uniformRandomVariable),
-                          MakePointerChecker<UniformRandomVariable>());
+                          MakePointerChecker<UniformRandomVariable>())
+            .AddAttribute("RreqSent",
+                          "Number of RREQs originated.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_rreqSent),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RreqReceived",
+                          "Number of RREQs received, duplicates included.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_rreqReceived),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RreqForwarded",
+                          "Number of RREQs rebroadcast.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_rreqForwarded),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RevRreqSent",
+                          "Number of REV_RREQs originated.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_revRreqSent),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RevRreqReceived",
+                          "Number of REV_RREQs received, duplicates included.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_revRreqReceived),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RevRreqForwarded",
+                          "Number of REV_RREQs rebroadcast.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_revRreqForwarded),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RrepSent",
+                          "Number of RREPs originated, gratuitous ones included.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_rrepSent),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RrepReceived",
+                          "Number of RREPs received, hellos excluded.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_rrepReceived),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RrepForwarded",
+                          "Number of RREPs forwarded toward the route originator.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_rrepForwarded),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RerrSent",
+                          "Number of RERRs originated.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_rerrSent),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RerrReceived",
+                          "Number of RERRs received, piggybacked ones included.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_rerrReceived),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RerrForwarded",
+                          "Number of RERRs propagated for a received RERR.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_rerrForwarded),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("DuplicateRequests",
+                          "Number of RREQs and REV_RREQs dropped as duplicates.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_duplicateRequests),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RateLimited",
+                          "Number of requests deferred and RERRs deferred or suppressed by "
+                          "RreqRateLimit and RerrRateLimit.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_rateLimited),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("QueueOverflowDrops",
+                          "Number of buffered packets dropped because the queue was full.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::GetQueueOverflowDrops),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("QueueTimeoutDrops",
+                          "Number of buffered packets dropped after MaxQueueTime.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::GetQueueTimeoutDrops),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("QueueNoRouteDrops",
+                          "Number of buffered packets dropped because route discovery failed.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::GetQueueNoRouteDrops),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("DataForwarded",
+                          "Number of data packets relayed for other nodes.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_dataForwarded),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("DataBytesForwarded",
+                          "Number of bytes of relayed data packets, IP header included.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_dataBytesForwarded),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("QueuePeak",
+                          "Largest number of packets buffered at once while waiting for a route.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::GetQueuePeak),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RouteTableSize",
+                          "Number of routing table entries, valid or not.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::GetRouteTableSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddTraceSource("ControlSent",
+                            "A RREQ, REV_RREQ, RREP or RERR was originated.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_controlSentTrace),
+                            "ns3::aodv::RoutingProtocol::ControlTracedCallback")
+            .AddTraceSource("ControlReceived",
+                            "A RREQ, REV_RREQ, RREP or RERR was received.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_controlReceivedTrace),
+                            "ns3::aodv::RoutingProtocol::ControlTracedCallback")
+            .AddTraceSource("ControlForwarded",
+                            "A RREQ, REV_RREQ, RREP or RERR was forwarded.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_controlForwardedTrace),
+                            "ns3::aodv::RoutingProtocol::ControlTracedCallback")
+            .AddTraceSource("DuplicateRequest",
+                            "A RREQ or REV_RREQ was dropped as a duplicate.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_duplicateRequestTrace),
+                            "ns3::aodv::RoutingProtocol::DuplicateTracedCallback")
+            .AddTraceSource("RateLimited",
+                            "The rate limit deferred or suppressed a control message.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_rateLimitedTrace),
+                            "ns3::aodv::RoutingProtocol::ControlTracedCallback")
+            .AddTraceSource("QueueDrop",
+                            "The request queue dropped a buffered packet.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_queueDropTrace),
+                            "ns3::aodv::RoutingProtocol::QueueDropTracedCallback")
+            .AddTraceSource("RouteDiscovery",
+                            "A route discovery started by this node succeeded.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_discoveryTrace),
+                            "ns3::aodv::RoutingProtocol::DiscoveryTracedCallback")
+            .AddTraceSource("QueueResidence",
+                            "A buffered packet left the request queue with a route.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_queueResidenceTrace),
+                            "ns3::aodv::RoutingProtocol::QueueResidenceTracedCallback");
     return tid;
 }
 
@@ -351,6 +615,11 @@ void
 RoutingProtocol::DoDispose()
 {
     m_ipv4 = nullptr;
+    for (auto iter = m_pendingHellos.begin(); iter != m_pendingHellos.end(); iter++)
+    {
+        iter->second.event.Cancel();
+    }
+    m_pendingHellos.clear();
     for (auto iter = m_socketAddresses.begin(); iter != m_socketAddresses.end(); iter++)
     {
         iter->first->Close();
@@ -390,7 +659,9 @@ void
 RoutingProtocol::Start()
 {
     NS_LOG_FUNCTION(this);
-    if (m_enableHello)
+    NS_ABORT_MSG_IF(m_enableEtx && !m_enableHello,
+                    "EnableEtx needs EnableHello: link delivery ratios are measured from hellos");
+    if (m_enableHello || m_enablePassiveSensing)
     {
         m_nb.ScheduleTimer();
     }
@@ -399,6 +670,19 @@ RoutingProtocol::Start()
 
     m_rerrRateLimitTimer.SetFunction(&RoutingProtocol::RerrRateLimitTimerExpire, this);
     m_rerrRateLimitTimer.Schedule(Seconds(1));
+
+    m_rreqAggregationTimer.SetFunction(&RoutingProtocol::RreqAggregationTimerExpire, this);
+    m_rerrAggregationTimer.SetFunction(&RoutingProtocol::RerrAggregationTimerExpire, this);
+
+    m_currentHelloInterval = m_helloInterval;
+    if (m_adaptiveHello)
+    {
+        // DeletePeriod has to cover the hello interval of any neighbor, whose own controller
+        // may have stretched it up to MaxHelloInterval
+        m_deletePeriod =
+            std::max(m_deletePeriod, 5 * std::max(m_activeRouteTimeout, m_maxHelloInterval));
+        m_routingTable.SetBadLinkLifetime(m_deletePeriod);
+    }
 }
 
 Ptr<Ipv4Route>
@@ -438,6 +722,16 @@ RoutingProtocol::RouteOutput(Ptr<Packet> p,
         }
         UpdateRouteLifeTime(dst, m_activeRouteTimeout);
         UpdateRouteLifeTime(route->GetGateway(), m_activeRouteTimeout);
+        if (FindPiggybackSocket(route, header))
+        {
+            // Detour through the loopback, where RouteInput can attach the pending state
+            DeferredRouteOutputTag tag(oif ? m_ipv4->GetInterfaceForDevice(oif) : -1);
+            if (!p->PeekPacketTag(tag))
+            {
+                p->AddPacketTag(tag);
+            }
+            return LoopbackRoute(header, oif);
+        }
         return route;
     }
 
@@ -474,7 +768,14 @@ RoutingProtocol::DeferredRouteOutput(Ptr<const Packet> p,
         if (!result || ((rt.GetFlag() != IN_SEARCH) && result))
         {
             NS_LOG_LOGIC("Send new RREQ for outbound packet to " << header.GetDestination());
-            SendRequest(header.GetDestination());
+            if (m_rreqAggregationDelay.IsStrictlyPositive())
+            {
+                QueueRequest(header.GetDestination());
+            }
+            else
+            {
+                SendRequest(header.GetDestination());
+            }
         }
     }
 }
@@ -500,6 +801,20 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
     NS_ASSERT(m_ipv4->GetInterfaceForDevice(idev) >= 0);
     int32_t iif = m_ipv4->GetInterfaceForDevice(idev);
 
+    // Control state piggybacked by the previous hop
+    PiggybackTag piggybackTag;
+    if (p->PeekPacketTag(piggybackTag))
+    {
+        Ptr<Packet> packet = p->Copy();
+        packet->RemovePacketTag(piggybackTag);
+        PiggybackHeader shim;
+        packet->RemoveHeader(shim);
+        Ipv4Header stripped = header;
+        stripped.SetPayloadSize(packet->GetSize());
+        RecvPiggyback(shim, iif);
+        return RouteInput(packet, stripped, idev, ucb, mcb, lcb, ecb);
+    }
+
     Ipv4Address dst = header.GetDestination();
     Ipv4Address origin = header.GetSource();
 
@@ -509,6 +824,25 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
         DeferredRouteOutputTag tag;
         if (p->PeekPacketTag(tag))
         {
+            RoutingTableEntry toDst;
+            if (m_enablePiggyback && m_routingTable.LookupValidRoute(dst, toDst) &&
+                (tag.GetInterface() == -1 ||
+                 tag.GetInterface() ==
+                     m_ipv4->GetInterfaceForDevice(toDst.GetRoute()->GetOutputDevice())))
+            {
+                // Detoured by RouteOutput to carry piggybacked state
+                Ptr<Ipv4Route> route = toDst.GetRoute();
+                Ptr<Packet> packet = p->Copy();
+                packet->RemovePacketTag(tag);
+                Ipv4Header ipHeader = header;
+                ipHeader.SetSource(route->GetSource());
+                ipHeader.SetTtl(ipHeader.GetTtl() +
+                                1); // compensate extra TTL decrement by fake loopback routing
+                Ptr<const Packet> out = packet;
+                AttachPiggyback(route, out, ipHeader);
+                ucb(route, out, ipHeader);
+                return true;
+            }
             DeferredRouteOutput(p, header, ucb, ecb);
             return true;
         }
@@ -668,7 +1002,12 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
             m_nb.Update(route->GetGateway(), m_activeRouteTimeout);
             m_nb.Update(toOrigin.GetNextHop(), m_activeRouteTimeout);
 
-            ucb(route, p, header);
+            m_dataForwarded++;
+            m_dataBytesForwarded += p->GetSize() + header.GetSerializedSize();
+            Ptr<const Packet> packet = p;
+            Ipv4Header ipHeader = header;
+            AttachPiggyback(route, packet, ipHeader);
+            ucb(route, packet, ipHeader);
             return true;
         }
         else
@@ -781,6 +1120,15 @@ RoutingProtocol::NotifyInterfaceUp(uint32_t i)
 
     mac->TraceConnectWithoutContext("DroppedMpdu",
                                     MakeCallback(&RoutingProtocol::NotifyTxError, this));
+
+    if (m_enablePassiveSensing)
+    {
+        Ptr<WifiPhy> phy = wifi->GetPhy();
+        phy->TraceConnectWithoutContext("PhyRxEnd",
+                                        MakeCallback(&RoutingProtocol::NotifyPhyRxEnd, this));
+        phy->TraceConnectWithoutContext("PhyTxBegin",
+                                        MakeCallback(&RoutingProtocol::NotifyPhyTxBegin, this));
+    }
 }
 
 void
@@ -789,6 +1137,33 @@ RoutingProtocol::NotifyTxError(WifiMacDropReason reason, Ptr<const WifiMpdu> mpd
     m_nb.GetTxErrorCallback()(mpdu->GetHeader());
 }
 
+void
+RoutingProtocol::NotifyPhyRxEnd(Ptr<const Packet> packet)
+{
+    WifiMacHeader header;
+    packet->PeekHeader(header);
+    // Control frames such as ACK and CTS carry no transmitter address
+    if (!header.IsData() && !header.IsMgt())
+    {
+        return;
+    }
+    Ipv4Address neighbor =
+        m_nb.UpdateByMac(header.GetAddr2(), Time(m_allowedHelloLoss * m_currentHelloInterval));
+    NS_LOG_LOGIC("Overheard frame from " << header.GetAddr2() << " (" << neighbor << ")");
+}
+
+void
+RoutingProtocol::NotifyPhyTxBegin(Ptr<const Packet> packet, double txPowerW)
+{
+    WifiMacHeader header;
+    packet->PeekHeader(header);
+    // A unicast frame may be sent at a rate the other neighbors cannot decode
+    if (header.IsData() && header.GetAddr1().IsGroup())
+    {
+        m_lastTxTime = Simulator::Now();
+    }
+}
+
 void
 RoutingProtocol::NotifyInterfaceDown(uint32_t i)
 {
@@ -805,6 +1180,16 @@ RoutingProtocol::NotifyInterfaceDown(uint32_t i)
         {
             mac->TraceDisconnectWithoutContext("DroppedMpdu",
                                                MakeCallback(&RoutingProtocol::NotifyTxError, this));
+            if (m_enablePassiveSensing)
+            {
+                Ptr<WifiPhy> phy = wifi->GetPhy();
+                phy->TraceDisconnectWithoutContext(
+                    "PhyRxEnd",
+                    MakeCallback(&RoutingProtocol::NotifyPhyRxEnd, this));
+                phy->TraceDisconnectWithoutContext(
+                    "PhyTxBegin",
+                    MakeCallback(&RoutingProtocol::NotifyPhyTxBegin, this));
+            }
             m_nb.DelArpCache(l3->GetInterface(i)->GetArpCache());
         }
     }
@@ -812,6 +1197,12 @@ RoutingProtocol::NotifyInterfaceDown(uint32_t i)
     // Close socket
     Ptr<Socket> socket = FindSocketWithInterfaceAddress(m_ipv4->GetAddress(i, 0));
     NS_ASSERT(socket);
+    auto hello = m_pendingHellos.find(socket);
+    if (hello != m_pendingHellos.end())
+    {
+        hello->second.event.Cancel();
+        m_pendingHellos.erase(hello);
+    }
     socket->Close();
     m_socketAddresses.erase(socket);
 
@@ -1034,6 +1425,7 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
     // A node SHOULD NOT originate more than RREQ_RATELIMIT RREQ messages per second.
     if (m_rreqCount == m_rreqRateLimit)
     {
+        CountRateLimited(AODVTYPE_RREQ);
         Simulator::Schedule(m_rreqRateLimitTimer.GetDelayLeft() + MicroSeconds(100),
                             &RoutingProtocol::SendRequest,
                             this,
@@ -1048,6 +1440,177 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
     RreqHeader rreqHeader;
     rreqHeader.SetDst(dst);
 
+    uint32_t dstSeqNo = 0;
+    bool unknownSeqNo = true;
+    uint16_t ttl = PrepareRouteSearch(dst, dstSeqNo, unknownSeqNo);
+    if (unknownSeqNo)
+    {
+        rreqHeader.SetUnknownSeqno(true);
+    }
+    else
+    {
+        rreqHeader.SetDstSeqno(dstSeqNo);
+    }
+
+    if (m_gratuitousReply)
+    {
+        rreqHeader.SetGratuitousRrep(true);
+    }
+    if (m_destinationOnly)
+    {
+        rreqHeader.SetDestinationOnly(true);
+    }
+
+    // poupulating more fields of the rreq header
+    m_seqNo++;
+    rreqHeader.SetOriginSeqno(m_seqNo);
+    m_requestId++;
+    rreqHeader.SetId(m_requestId);
+    if (m_enableEtx)
+    {
+        rreqHeader.SetPathEtx(0);
+    }
+
+    BroadcastRequest(rreqHeader, ttl);
+    ScheduleRreqRetry(dst);
+}
+
+void
+RoutingProtocol::SendMultiDestinationRequest(std::vector<Ipv4Address> dsts)
+{
+    NS_LOG_FUNCTION(this << dsts.size());
+    NS_ASSERT(!dsts.empty());
+    // A node SHOULD NOT originate more than RREQ_RATELIMIT RREQ messages per second.
+    if (m_rreqCount == m_rreqRateLimit)
+    {
+        CountRateLimited(AODVTYPE_RREQ);
+        Simulator::Schedule(m_rreqRateLimitTimer.GetDelayLeft() + MicroSeconds(100),
+                            &RoutingProtocol::SendMultiDestinationRequest,
+                            this,
+                            dsts);
+        return;
+    }
+    else
+    {
+        m_rreqCount++;
+    }
+
+    // The first destination goes into the fixed part of the RREQ, the others into the
+    // multi-destination extension. The request travels as far as the widest ring among them.
+    RreqHeader rreqHeader;
+    uint16_t ttl = 0;
+    for (auto i = dsts.begin(); i != dsts.end(); ++i)
+    {
+        uint32_t dstSeqNo = 0;
+        bool unknownSeqNo = true;
+        ttl = std::max(ttl, PrepareRouteSearch(*i, dstSeqNo, unknownSeqNo));
+        if (i == dsts.begin())
+        {
+            rreqHeader.SetDst(*i);
+            if (unknownSeqNo)
+            {
+                rreqHeader.SetUnknownSeqno(true);
+            }
+            else
+            {
+                rreqHeader.SetDstSeqno(dstSeqNo);
+            }
+        }
+        else
+        {
+            bool added = rreqHeader.AddDestination(*i, dstSeqNo, unknownSeqNo);
+            NS_ASSERT_MSG(added, "Too many destinations for one RREQ");
+        }
+    }
+
+    if (m_gratuitousReply)
+    {
+        rreqHeader.SetGratuitousRrep(true);
+    }
+    if (m_destinationOnly)
+    {
+        rreqHeader.SetDestinationOnly(true);
+    }
+
+    m_seqNo++;
+    rreqHeader.SetOriginSeqno(m_seqNo);
+    m_requestId++;
+    rreqHeader.SetId(m_requestId);
+    if (m_enableEtx)
+    {
+        rreqHeader.SetPathEtx(0);
+    }
+
+    BroadcastRequest(rreqHeader, ttl);
+    for (auto i = dsts.begin(); i != dsts.end(); ++i)
+    {
+        ScheduleRreqRetry(*i);
+    }
+}
+
+void
+RoutingProtocol::QueueRequest(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    if (std::find(m_pendingRreqDsts.begin(), m_pendingRreqDsts.end(), dst) !=
+        m_pendingRreqDsts.end())
+    {
+        return;
+    }
+    m_pendingRreqDsts.push_back(dst);
+    if (!m_rreqAggregationTimer.IsRunning())
+    {
+        m_rreqAggregationTimer.Schedule(m_rreqAggregationDelay);
+    }
+}
+
+void
+RoutingProtocol::RreqAggregationTimerExpire()
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<Ipv4Address> dsts;
+    dsts.swap(m_pendingRreqDsts);
+    RoutingTableEntry rt;
+    for (auto i = dsts.begin(); i != dsts.end();)
+    {
+        if (m_routingTable.LookupValidRoute(*i, rt))
+        {
+            NS_LOG_LOGIC("Route to " << *i << " found while waiting for aggregation");
+            SendPacketFromQueue(*i, rt.GetRoute());
+            i = dsts.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    // One destination in the fixed part plus at most 255 in the extension per RREQ
+    auto i = dsts.begin();
+    while (i != dsts.end())
+    {
+        auto last = (dsts.end() - i > 256) ? i + 256 : dsts.end();
+        if (last - i == 1)
+        {
+            SendRequest(*i);
+        }
+        else
+        {
+            SendMultiDestinationRequest(std::vector<Ipv4Address>(i, last));
+        }
+        i = last;
+    }
+}
+
+uint16_t
+RoutingProtocol::PrepareRouteSearch(Ipv4Address dst, uint32_t& dstSeqNo, bool& unknownSeqNo)
+{
+    NS_LOG_FUNCTION(this << dst);
+    auto discovery = m_discoveries.find(dst);
+    if (discovery == m_discoveries.end())
+    {
+        discovery = m_discoveries.insert({dst, {Simulator::Now(), 0}}).first;
+    }
+    discovery->second.rings++;
     RoutingTableEntry rt;
     // Using the Hop field in Routing Table to manage the expanding ring search
     uint16_t ttl = m_ttlStart;
@@ -1072,11 +1635,12 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
         }
         if (rt.GetValidSeqNo())
         {
-            rreqHeader.SetDstSeqno(rt.GetSeqNo());
+            dstSeqNo = rt.GetSeqNo();
+            unknownSeqNo = false;
         }
         else
         {
-            rreqHeader.SetUnknownSeqno(true);
+            unknownSeqNo = true;
         }
         rt.SetHop(ttl);
         rt.SetFlag(IN_SEARCH);
@@ -1087,7 +1651,7 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
     // routing table
     else
     {
-        rreqHeader.SetUnknownSeqno(true);
+        unknownSeqNo = true;
         Ptr<NetDevice> dev = nullptr;
         // dummy routing table entry
         RoutingTableEntry newEntry(/*dev=*/dev,
@@ -1107,21 +1671,15 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
         m_routingTable.AddRoute(newEntry);
     }
 
-    if (m_gratuitousReply)
-    {
-        rreqHeader.SetGratuitousRrep(true);
-    }
-    if (m_destinationOnly)
-    {
-        rreqHeader.SetDestinationOnly(true);
-    }
-
-    // poupulating more fields of the rreq header
-    m_seqNo++;
-    rreqHeader.SetOriginSeqno(m_seqNo);
-    m_requestId++;
-    rreqHeader.SetId(m_requestId);
+    return ttl;
+}
 
+void
+RoutingProtocol::BroadcastRequest(RreqHeader& rreqHeader, uint16_t ttl)
+{
+    NS_LOG_FUNCTION(this << ttl);
+    m_routeDiscoveries++;
+    rreqHeader.SetCompact(m_compactControlMessages);
     // Send RREQ as subnet directed broadcast from each interface used by aodv
     for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
     {
@@ -1129,15 +1687,16 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
         Ipv4InterfaceAddress iface = j->second;
 
         rreqHeader.SetOrigin(iface.GetLocal());
-        m_rreqIdCache.IsDuplicate(iface.GetLocal(), m_requestId);
+        m_rreqIdCache.IsDuplicate(iface.GetLocal(), rreqHeader.GetId());
 
         Ptr<Packet> packet = Create<Packet>();
         SocketIpTtlTag tag;
         tag.SetTtl(ttl);
         packet->AddPacketTag(tag);
         packet->AddHeader(rreqHeader);
-        TypeHeader tHeader(AODVTYPE_RREQ);
+        TypeHeader tHeader(m_compactControlMessages ? AODVTYPE_RREQ_COMPACT : AODVTYPE_RREQ);
         packet->AddHeader(tHeader);
+        m_compactBytesSaved += rreqHeader.GetCompactSavings();
         // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
         Ipv4Address destination;
         if (iface.GetMask() == Ipv4Mask::GetOnes())
@@ -1149,6 +1708,7 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
             destination = iface.GetBroadcast();
         }
         NS_LOG_DEBUG("Send RREQ with id " << rreqHeader.GetId() << " to socket");
+        CountControl(CONTROL_SENT, tHeader.Get());
         m_lastBcastTime = Simulator::Now();
         Simulator::Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
                             &RoutingProtocol::SendTo,
@@ -1157,7 +1717,6 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
                             packet,
                             destination);
     }
-    ScheduleRreqRetry(dst);
 }
 
 void
@@ -1228,23 +1787,34 @@ RoutingProtocol::RecvAodv(Ptr<Socket> socket)
                    // example : B will update dest C nexthop C and hopcount =1 and C will update
                    // dest B nexthop B and hopcount =1
     TypeHeader tHeader(AODVTYPE_RREQ);
-    packet->RemoveHeader(tHeader);
+    packet->PeekHeader(tHeader);
     if (!tHeader.IsValid())
     {
         NS_LOG_DEBUG("AODV message " << packet->GetUid() << " with unknown type received: "
                                      << tHeader.Get() << ". Drop");
         return; // drop
     }
-    //std::cout<<"Header type :"<< tHeader.Get()<<std::endl;
+    if (tHeader.Get() != AODVTYPE_RREP)
+    {
+        // Hellos are RREPs too, RecvReply counts the other ones
+        CountControl(CONTROL_RECEIVED, tHeader.Get());
+    }
+    // Requests are read through a RequestView and keep their type header for forwarding
+    if (tHeader.Get() != AODVTYPE_RREQ && tHeader.Get() != AODVTYPE_REV_RREQ &&
+        tHeader.Get() != AODVTYPE_RREQ_COMPACT && tHeader.Get() != AODVTYPE_REV_RREQ_COMPACT)
+    {
+        packet->RemoveHeader(tHeader);
+    }
     switch (tHeader.Get())
     {
         
-    case AODVTYPE_RREQ: {
+    case AODVTYPE_RREQ:
+    case AODVTYPE_RREQ_COMPACT: {
         RecvRequest(packet, receiver, sender);
         break;
     }
-    case AODVTYPE_REV_RREQ: {
-       // std::cout<<"rev req e dhuktsi"<<std::endl;
+    case AODVTYPE_REV_RREQ:
+    case AODVTYPE_REV_RREQ_COMPACT: {
         RecvRevRequest(packet, receiver, sender);
         break;
     }
@@ -1271,6 +1841,7 @@ RoutingProtocol::SendRevRequest(Ipv4Address dst, Ipv4Address source)
     //it was commented out
     if (m_rreqCount == m_rreqRateLimit)
     {
+        CountRateLimited(AODVTYPE_REV_RREQ);
         Simulator::Schedule(m_rreqRateLimitTimer.GetDelayLeft() + MicroSeconds(100),
                             &RoutingProtocol::SendRevRequest,
                             this,
@@ -1324,7 +1895,6 @@ RoutingProtocol::SendRevRequest(Ipv4Address dst, Ipv4Address source)
         rt.SetFlag(IN_SEARCH);
         rt.SetLifeTime(m_pathDiscoveryTime);
         m_routingTable.Update(rt);
-        //std::cout<<"dhuksi in if(m_routingTable.LookupRoute(dst, rt)) "<<std::endl;
     //}
    
     // poupulating more fields of the rreq header
@@ -1332,6 +1902,11 @@ RoutingProtocol::SendRevRequest(Ipv4Address dst, Ipv4Address source)
     revreqHeader.SetOriginSeqno(m_seqNo);
     m_requestId++;
     revreqHeader.SetId(m_requestId);
+    if (m_enableEtx)
+    {
+        revreqHeader.SetPathEtx(0);
+    }
+    revreqHeader.SetCompact(m_compactControlMessages);
 
     
 
@@ -1350,9 +1925,10 @@ RoutingProtocol::SendRevRequest(Ipv4Address dst, Ipv4Address source)
         tag.SetTtl(ttl);
         packet->AddPacketTag(tag);
         packet->AddHeader(revreqHeader);
-        TypeHeader tHeader(AODVTYPE_REV_RREQ);
-       // std::cout<<"packet header : "<<tHeader.Get()<<std::endl;
+        TypeHeader tHeader(m_compactControlMessages ? AODVTYPE_REV_RREQ_COMPACT
+                                                    : AODVTYPE_REV_RREQ);
         packet->AddHeader(tHeader);
+        m_compactBytesSaved += revreqHeader.GetCompactSavings();
         // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
         Ipv4Address destination;
         if (iface.GetMask() == Ipv4Mask::GetOnes())
@@ -1363,8 +1939,8 @@ RoutingProtocol::SendRevRequest(Ipv4Address dst, Ipv4Address source)
         {
             destination = iface.GetBroadcast();
         }
-        //std::cout<<"packet getting broadcasted from sendrevrequest"<<std::endl;
-        // NS_LOG_DEBUG("Send RREQ with id " << rreqHeader.GetId() << " to socket");
+        NS_LOG_DEBUG("Send REV_RREQ with id " << revreqHeader.GetId() << " to socket");
+        CountControl(CONTROL_SENT, tHeader.Get());
         m_lastBcastTime = Simulator::Now();
         Simulator::Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
                             &RoutingProtocol::SendTo,
@@ -1378,11 +1954,13 @@ RoutingProtocol::SendRevRequest(Ipv4Address dst, Ipv4Address source)
 void
 RoutingProtocol::RecvRevRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
 {
-    // previously we removed type header from the packet
-    RrevreqHeader rrevreqHeader;
-    p->RemoveHeader(rrevreqHeader);
-
-    //std::cout<<"recvrevreq e aschi"<<std::endl;
+    // the type header is still in place, the duplicate check only reads the view
+    RequestView view(p);
+    if (!view.IsValid())
+    {
+        NS_LOG_DEBUG("Truncated REVREQ. Drop");
+        return;
+    }
 
     // A node ignores all REVREQs received from any node in its blacklist
     RoutingTableEntry toPrev;
@@ -1395,23 +1973,39 @@ RoutingProtocol::RecvRevRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
         }
     }
 
-    uint32_t id = rrevreqHeader.GetId();
-    Ipv4Address origin = rrevreqHeader.GetOrigin();
+    uint32_t id = view.GetId();
+    Ipv4Address origin = view.GetOrigin();
 
     /*
      *  Node checks to determine whether it has received a REVREQ with the same Originator IP Address
      * and REVREQ ID. If such a RREQ has been received, the node silently discards the newly received
      * REVREQ.
      */
-    if (m_rreqIdCache.IsDuplicate(origin, id) && !IsMyOwnAddress(rrevreqHeader.GetDst()))
+    if (m_rreqIdCache.IsDuplicate(origin, id) && !IsMyOwnAddress(view.GetDst()))
     {
         NS_LOG_DEBUG("Ignoring REVREQ due to duplicate");
+        m_duplicateRequests++;
+        m_duplicateRequestTrace(origin, id);
+        return;
+    }
+
+    // decode from the bytes the view already copied, the packet is not parsed again
+    RrevreqHeader rrevreqHeader;
+    if (!view.Deserialize(rrevreqHeader))
+    {
+        NS_LOG_DEBUG("Malformed REVREQ. Drop");
         return;
     }
 
     // Increment REV_REQ hop count
     uint8_t hop = rrevreqHeader.GetHopCount() + 1;
     rrevreqHeader.SetHopCount(hop);
+    view.SetHopCount(hop);
+    if (rrevreqHeader.HasPathEtx())
+    {
+        rrevreqHeader.SetPathEtx(AccumulateEtx(rrevreqHeader.GetPathEtx(), src));
+        view.SetPathEtx(rrevreqHeader.GetPathEtx());
+    }
 
     /*
      *  When the reverse route is created or updated, the following actions on the route are also
@@ -1427,7 +2021,6 @@ RoutingProtocol::RecvRevRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
     RoutingTableEntry toOrigin;
     if (!m_routingTable.LookupRoute(origin, toOrigin))
     {
-        //std::cout<<"origin er modhe asi"<<std::endl;
         Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
         RoutingTableEntry newEntry(
             /*dev=*/dev,
@@ -1438,21 +2031,29 @@ RoutingProtocol::RecvRevRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
             /*hops=*/hop,
             /*nextHop=*/src,
             /*lifetime=*/Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime));
+        newEntry.SetPathEtx(rrevreqHeader.GetPathEtx());
         m_routingTable.AddRoute(newEntry);
     }
+    else if (m_enableEtx && IsMyOwnAddress(rrevreqHeader.GetDst()) && toOrigin.GetFlag() == VALID &&
+             toOrigin.GetValidSeqNo() &&
+             int32_t(rrevreqHeader.GetOriginSeqno()) - int32_t(toOrigin.GetSeqNo()) <= 0 &&
+             !IsBetterPath(toOrigin, hop, rrevreqHeader.GetPathEtx()))
+    {
+        // Every copy of the REV_RREQ reaches the source; keep the best path of a discovery
+        NS_LOG_DEBUG("Keep current route to " << origin << ", REV_RREQ copy is not better");
+        return;
+    }
     else
     {
         if (toOrigin.GetValidSeqNo())
         {
             if (int32_t(rrevreqHeader.GetOriginSeqno()) - int32_t(toOrigin.GetSeqNo()) > 0)
             {
-                //std::cout<<"seqno update hoche"<<std::endl;
                 toOrigin.SetSeqNo(rrevreqHeader.GetOriginSeqno());
             }
         }
         else
         {
-            //std::cout<<"seqno update hoche in else"<<std::endl;
             toOrigin.SetSeqNo(rrevreqHeader.GetOriginSeqno());
         }
         toOrigin.SetValidSeqNo(true);
@@ -1460,19 +2061,34 @@ RoutingProtocol::RecvRevRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
         toOrigin.SetOutputDevice(m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver)));
         toOrigin.SetInterface(m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0));
         toOrigin.SetHop(hop);
+        toOrigin.SetPathEtx(rrevreqHeader.GetPathEtx());
         toOrigin.SetLifeTime(std::max(Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime),
                                       toOrigin.GetLifeTime()));
-        if(IsMyOwnAddress(rrevreqHeader.GetDst()))
-        m_routingTable.AddRoute(toOrigin);
+        if (m_enableEtx)
+        {
+            // The source picks among all copies, so the accepted copy becomes the route
+            toOrigin.SetFlag(VALID);
+            m_routingTable.Update(toOrigin);
+        }
+        else if (IsMyOwnAddress(rrevreqHeader.GetDst()))
+        {
+            // The entry is still IN_SEARCH, so the first copy to arrive becomes the route
+            if (toOrigin.GetFlag() != VALID)
+            {
+                toOrigin.SetFlag(VALID);
+                m_routingTable.Update(toOrigin);
+            }
+        }
         else
-        m_routingTable.Update(toOrigin);
+        {
+            m_routingTable.Update(toOrigin);
+        }
         // m_nb.Update (src, Time (AllowedHelloLoss * HelloInterval));
     }
 
     //checking if the destination is the current node and then send the packet
     if (IsMyOwnAddress(rrevreqHeader.GetDst()))
     { 
-        //std::cout<<"ekhon route established so packet pathabe"<<std::endl;
         m_routingTable.LookupRoute(rrevreqHeader.GetOrigin(), toOrigin);
         
         SendPacketFromQueue(rrevreqHeader.GetOrigin(), toOrigin.GetRoute()); // here we will call our newly created
@@ -1480,53 +2096,16 @@ RoutingProtocol::RecvRevRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
         return;
     }
 
-    SocketIpTtlTag tag;
-    p->RemovePacketTag(tag);
-    if (tag.GetTtl() < 2)
-    {
-        // NS_LOG_DEBUG("TTL exceeded. Drop RREQ origin " << src << " destination " << dst);
-        return;
-    }
+    // braodcast the received bytes with hop count and path ETX patched
+    ForwardRequest(p, view.CreatePacket(), view.GetCompactSavings());
+}
 
-    // braodcast
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
-    {
-        //std::cout<<"now broadcast from int node"<<std::endl;
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
-        Ptr<Packet> packet = Create<Packet>();
-        SocketIpTtlTag ttl;
-        ttl.SetTtl(tag.GetTtl() - 1);
-        packet->AddPacketTag(ttl);
-        packet->AddHeader(rrevreqHeader);
-        TypeHeader tHeader(AODVTYPE_REV_RREQ);
-        packet->AddHeader(tHeader);
-        // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
-        Ipv4Address destination;
-        if (iface.GetMask() == Ipv4Mask::GetOnes())
-        {
-            destination = Ipv4Address("255.255.255.255");
-        }
-        else
-        {
-            destination = iface.GetBroadcast();
-        }
-        m_lastBcastTime = Simulator::Now();
-        Simulator::Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
-                            &RoutingProtocol::SendTo,
-                            this,
-                            socket,
-                            packet,
-                            destination);
-    }
-}
-
-bool
-RoutingProtocol::UpdateRouteLifeTime(Ipv4Address addr, Time lifetime)
-{
-    NS_LOG_FUNCTION(this << addr << lifetime);
-    RoutingTableEntry rt;
-    if (m_routingTable.LookupRoute(addr, rt))
+bool
+RoutingProtocol::UpdateRouteLifeTime(Ipv4Address addr, Time lifetime)
+{
+    NS_LOG_FUNCTION(this << addr << lifetime);
+    RoutingTableEntry rt;
+    if (m_routingTable.LookupRoute(addr, rt))
     {
         if (rt.GetFlag() == VALID)
         {
@@ -1587,9 +2166,13 @@ void
 RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
 {
     NS_LOG_FUNCTION(this);
-    // previously we removed type header from the packet
-    RreqHeader rreqHeader;
-    p->RemoveHeader(rreqHeader);
+    // the type header is still in place, the duplicate check only reads the view
+    RequestView view(p);
+    if (!view.IsValid())
+    {
+        NS_LOG_DEBUG("Truncated RREQ. Drop");
+        return;
+    }
 
     // A node ignores all RREQs received from any node in its blacklist
     RoutingTableEntry toPrev;
@@ -1602,8 +2185,8 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
         }
     }
 
-    uint32_t id = rreqHeader.GetId();
-    Ipv4Address origin = rreqHeader.GetOrigin();
+    uint32_t id = view.GetId();
+    Ipv4Address origin = view.GetOrigin();
 
     /*
      *  Node checks to determine whether it has received a RREQ with the same Originator IP Address
@@ -1613,12 +2196,28 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
     if (m_rreqIdCache.IsDuplicate(origin, id))
     {
         NS_LOG_DEBUG("Ignoring RREQ due to duplicate");
+        m_duplicateRequests++;
+        m_duplicateRequestTrace(origin, id);
+        return;
+    }
+
+    // decode from the bytes the view already copied, the packet is not parsed again
+    RreqHeader rreqHeader;
+    if (!view.Deserialize(rreqHeader))
+    {
+        NS_LOG_DEBUG("Malformed RREQ. Drop");
         return;
     }
 
     // Increment RREQ hop count
     uint8_t hop = rreqHeader.GetHopCount() + 1;
     rreqHeader.SetHopCount(hop);
+    view.SetHopCount(hop);
+    if (rreqHeader.HasPathEtx())
+    {
+        rreqHeader.SetPathEtx(AccumulateEtx(rreqHeader.GetPathEtx(), src));
+        view.SetPathEtx(rreqHeader.GetPathEtx());
+    }
 
     /*
      *  When the reverse route is created or updated, the following actions on the route are also
@@ -1644,6 +2243,7 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
             /*hops=*/hop,
             /*nextHop=*/src,
             /*lifetime=*/Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime));
+        newEntry.SetPathEtx(rreqHeader.GetPathEtx());
         m_routingTable.AddRoute(newEntry);
     }
     else
@@ -1664,6 +2264,7 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
         toOrigin.SetOutputDevice(m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver)));
         toOrigin.SetInterface(m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0));
         toOrigin.SetHop(hop);
+        toOrigin.SetPathEtx(rreqHeader.GetPathEtx());
         toOrigin.SetLifeTime(std::max(Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime),
                                       toOrigin.GetLifeTime()));
         m_routingTable.Update(toOrigin);
@@ -1697,12 +2298,26 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
         toNeighbor.SetNextHop(src);
         m_routingTable.Update(toNeighbor);
     }
-    m_nb.Update(src, Time(m_allowedHelloLoss * m_helloInterval));
+    m_nb.Refresh(src, Time(m_allowedHelloLoss * m_currentHelloInterval));
 
     NS_LOG_LOGIC(receiver << " receive RREQ with hop count "
                           << static_cast<uint32_t>(rreqHeader.GetHopCount()) << " ID "
                           << rreqHeader.GetId() << " to destination " << rreqHeader.GetDst());
 
+    // A multi-destination RREQ is answered per destination and forwarded for the rest
+    if (rreqHeader.GetMultiDestination())
+    {
+        if (ProcessMultiDestinationRequest(rreqHeader, src))
+        {
+            // The destination list changed, the message has to be serialized again
+            Ptr<Packet> message = Create<Packet>();
+            message->AddHeader(rreqHeader);
+            message->AddHeader(TypeHeader(view.GetType()));
+            ForwardRequest(p, message, rreqHeader.GetCompactSavings());
+        }
+        return;
+    }
+
     //  A node generates a RREP if either:
     //  (i)  it is itself the destination,
     if (IsMyOwnAddress(rreqHeader.GetDst()))
@@ -1710,6 +2325,11 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
         
         m_routingTable.LookupRoute(origin, toOrigin);
         NS_LOG_DEBUG("Send reply since I am the destination");
+        if (!m_enableReverseRequest)
+        {
+            SendReply(rreqHeader, toOrigin);
+            return;
+        }
         
         SendRevRequest(rreqHeader.GetOrigin(),
                        rreqHeader.GetDst()); // here we will call our newly created broadcast
@@ -1753,29 +2373,46 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
             }
             rreqHeader.SetDstSeqno(toDst.GetSeqNo());
             rreqHeader.SetUnknownSeqno(false);
+            if (!view.SetDstSeqno(toDst.GetSeqNo()))
+            {
+                // A compact sequence number that changed its length cannot be patched
+                Ptr<Packet> message = Create<Packet>();
+                message->AddHeader(rreqHeader);
+                message->AddHeader(TypeHeader(view.GetType()));
+                ForwardRequest(p, message, rreqHeader.GetCompactSavings());
+                return;
+            }
         }
     }
 
+    ForwardRequest(p, view.CreatePacket(), view.GetCompactSavings());
+}
+
+void
+RoutingProtocol::ForwardRequest(Ptr<Packet> p, Ptr<const Packet> message, int32_t compactSavings)
+{
+    NS_LOG_FUNCTION(this << message->GetSize());
     SocketIpTtlTag tag;
     p->RemovePacketTag(tag);
     if (tag.GetTtl() < 2)
     {
-        NS_LOG_DEBUG("TTL exceeded. Drop RREQ origin " << src << " destination " << dst);
+        NS_LOG_DEBUG("TTL exceeded. Drop request " << p->GetUid());
         return;
     }
 
+    TypeHeader tHeader(AODVTYPE_RREQ);
+    message->PeekHeader(tHeader);
     // braodcast
     for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
     {
         Ptr<Socket> socket = j->first;
         Ipv4InterfaceAddress iface = j->second;
-        Ptr<Packet> packet = Create<Packet>();
+        Ptr<Packet> packet = message->Copy();
         SocketIpTtlTag ttl;
         ttl.SetTtl(tag.GetTtl() - 1);
         packet->AddPacketTag(ttl);
-        packet->AddHeader(rreqHeader);
-        TypeHeader tHeader(AODVTYPE_RREQ);
-        packet->AddHeader(tHeader);
+        m_compactBytesSaved += compactSavings;
+        CountControl(CONTROL_FORWARDED, tHeader.Get());
         // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
         Ipv4Address destination;
         if (iface.GetMask() == Ipv4Mask::GetOnes())
@@ -1796,6 +2433,79 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
     }
 }
 
+bool
+RoutingProtocol::ProcessMultiDestinationRequest(RreqHeader& rreqHeader, Ipv4Address src)
+{
+    NS_LOG_FUNCTION(this << src);
+    // Every destination is handled as if it came in its own RREQ; the ones still unanswered are
+    // forwarded together.
+    std::vector<RreqHeader::Destination> dsts = rreqHeader.GetDestinations();
+    dsts.insert(dsts.begin(),
+                RreqHeader::Destination{rreqHeader.GetDst(),
+                                        rreqHeader.GetDstSeqno(),
+                                        rreqHeader.GetUnknownSeqno()});
+    std::vector<RreqHeader::Destination> remaining;
+    for (auto i = dsts.begin(); i != dsts.end(); ++i)
+    {
+        if (IsMyOwnAddress(i->address))
+        {
+            if (!m_enableReverseRequest)
+            {
+                NS_LOG_DEBUG("Send reply since I am the destination " << i->address);
+                RreqHeader single = rreqHeader;
+                single.SetDst(i->address);
+                single.SetDstSeqno(i->seqNo);
+                single.SetUnknownSeqno(i->unknownSeqno);
+                RoutingTableEntry toOrigin;
+                m_routingTable.LookupRoute(rreqHeader.GetOrigin(), toOrigin);
+                SendReply(single, toOrigin);
+                continue;
+            }
+            NS_LOG_DEBUG("Send reverse request since I am the destination " << i->address);
+            SendRevRequest(rreqHeader.GetOrigin(), i->address);
+            continue;
+        }
+        RoutingTableEntry toDst;
+        if (m_routingTable.LookupRoute(i->address, toDst))
+        {
+            if (toDst.GetNextHop() == src)
+            {
+                NS_LOG_DEBUG("Drop destination " << i->address << " from RREQ, dest next hop "
+                                                 << toDst.GetNextHop());
+                continue;
+            }
+            if ((i->unknownSeqno || (int32_t(toDst.GetSeqNo()) - int32_t(i->seqNo) >= 0)) &&
+                toDst.GetValidSeqNo())
+            {
+                if (!rreqHeader.GetDestinationOnly() && toDst.GetFlag() == VALID)
+                {
+                    RoutingTableEntry toOrigin;
+                    m_routingTable.LookupRoute(rreqHeader.GetOrigin(), toOrigin);
+                    SendReplyByIntermediateNode(toDst, toOrigin, rreqHeader.GetGratuitousRrep());
+                    continue;
+                }
+                i->seqNo = toDst.GetSeqNo();
+                i->unknownSeqno = false;
+            }
+        }
+        remaining.push_back(*i);
+    }
+    if (remaining.empty())
+    {
+        return false;
+    }
+
+    rreqHeader.ClearDestinations();
+    rreqHeader.SetDst(remaining.front().address);
+    rreqHeader.SetDstSeqno(remaining.front().seqNo);
+    rreqHeader.SetUnknownSeqno(remaining.front().unknownSeqno);
+    for (auto i = remaining.begin() + 1; i != remaining.end(); ++i)
+    {
+        rreqHeader.AddDestination(i->address, i->seqNo, i->unknownSeqno);
+    }
+    return true;
+}
+
 void
 RoutingProtocol::SendReply(const RreqHeader& rreqHeader, const RoutingTableEntry& toOrigin)
 {
@@ -1826,6 +2536,7 @@ RoutingProtocol::SendReply(const RreqHeader& rreqHeader, const RoutingTableEntry
     NS_ASSERT(socket);
     // unicast
     socket->SendTo(packet, 0, InetSocketAddress(toOrigin.GetNextHop(), AODV_PORT));
+    CountControl(CONTROL_SENT, AODVTYPE_RREP);
 }
 
 void
@@ -1868,6 +2579,7 @@ RoutingProtocol::SendReplyByIntermediateNode(RoutingTableEntry& toDst,
     Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin.GetInterface());
     NS_ASSERT(socket);
     socket->SendTo(packet, 0, InetSocketAddress(toOrigin.GetNextHop(), AODV_PORT));
+    CountControl(CONTROL_SENT, AODVTYPE_RREP);
 
     // Generating gratuitous RREPs
     if (gratRep)
@@ -1889,6 +2601,7 @@ RoutingProtocol::SendReplyByIntermediateNode(RoutingTableEntry& toDst,
         NS_ASSERT(socket);
         NS_LOG_LOGIC("Send gratuitous RREP " << packet->GetUid());
         socket->SendTo(packetToDst, 0, InetSocketAddress(toDst.GetNextHop(), AODV_PORT));
+        CountControl(CONTROL_SENT, AODVTYPE_RREP);
     }
 }
 
@@ -1929,6 +2642,7 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
         ProcessHello(rrepHeader, receiver);
         return;
     }
+    CountControl(CONTROL_RECEIVED, AODVTYPE_RREP);
 
     /*
      * If the route table entry to the destination is created or updated, then the following actions
@@ -2051,6 +2765,7 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
     Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin.GetInterface());
     NS_ASSERT(socket);
     socket->SendTo(packet, 0, InetSocketAddress(toOrigin.GetNextHop(), AODV_PORT));
+    CountControl(CONTROL_FORWARDED, AODVTYPE_RREP);
 }
 
 void
@@ -2092,8 +2807,7 @@ RoutingProtocol::ProcessHello(const RrepHeader& rrepHeader, Ipv4Address receiver
     }
     else
     {
-        toNeighbor.SetLifeTime(
-            std::max(Time(m_allowedHelloLoss * m_helloInterval), toNeighbor.GetLifeTime()));
+        toNeighbor.SetLifeTime(std::max(rrepHeader.GetLifeTime(), toNeighbor.GetLifeTime()));
         toNeighbor.SetSeqNo(rrepHeader.GetDstSeqno());
         toNeighbor.SetValidSeqNo(true);
         toNeighbor.SetFlag(VALID);
@@ -2103,9 +2817,24 @@ RoutingProtocol::ProcessHello(const RrepHeader& rrepHeader, Ipv4Address receiver
         toNeighbor.SetNextHop(rrepHeader.GetDst());
         m_routingTable.Update(toNeighbor);
     }
-    if (m_enableHello)
+    if (m_enableHello || m_enablePassiveSensing)
     {
-        m_nb.Update(rrepHeader.GetDst(), Time(m_allowedHelloLoss * m_helloInterval));
+        Time helloInterval = m_helloInterval;
+        if (m_adaptiveHello)
+        {
+            // The sender may run a different hello interval; trust the lifetime it advertises,
+            // which is AllowedHelloLoss times its own interval.
+            m_nb.UpdateHello(rrepHeader.GetDst(), rrepHeader.GetLifeTime());
+            helloInterval = rrepHeader.GetLifeTime() / m_allowedHelloLoss;
+        }
+        else
+        {
+            m_nb.Update(rrepHeader.GetDst(), Time(m_allowedHelloLoss * m_helloInterval));
+        }
+        if (m_enableEtx)
+        {
+            m_nb.RecordHello(rrepHeader.GetDst(), helloInterval);
+        }
     }
 }
 
@@ -2131,6 +2860,13 @@ RoutingProtocol::RecvError(Ptr<Packet> p, Ipv4Address src)
     }
 
     std::vector<Ipv4Address> precursors;
+    m_routingTable.GetPrecursors(unreachable, precursors);
+    if (m_rerrAggregationWindow.IsStrictlyPositive())
+    {
+        QueueRerr(unreachable, precursors);
+        m_routingTable.InvalidateRoutesWithDst(unreachable);
+        return;
+    }
     for (auto i = unreachable.begin(); i != unreachable.end();)
     {
         if (!rerrHeader.AddUnDestination(i->first, i->second))
@@ -2142,14 +2878,11 @@ RoutingProtocol::RecvError(Ptr<Packet> p, Ipv4Address src)
             packet->AddPacketTag(tag);
             packet->AddHeader(rerrHeader);
             packet->AddHeader(typeHeader);
-            SendRerrMessage(packet, precursors);
+            SendRerrMessage(packet, precursors, true);
             rerrHeader.Clear();
         }
         else
         {
-            RoutingTableEntry toDst;
-            m_routingTable.LookupRoute(i->first, toDst);
-            toDst.GetPrecursors(precursors);
             ++i;
         }
     }
@@ -2162,7 +2895,7 @@ RoutingProtocol::RecvError(Ptr<Packet> p, Ipv4Address src)
         packet->AddPacketTag(tag);
         packet->AddHeader(rerrHeader);
         packet->AddHeader(typeHeader);
-        SendRerrMessage(packet, precursors);
+        SendRerrMessage(packet, precursors, true);
     }
     m_routingTable.InvalidateRoutesWithDst(unreachable);
 }
@@ -2191,6 +2924,7 @@ RoutingProtocol::RouteRequestTimerExpire(Ipv4Address dst)
                                            << m_netDiameter);
         m_addressReqTimer.erase(dst);
         m_routingTable.DeleteRoute(dst);
+        m_discoveries.erase(dst);
         NS_LOG_DEBUG("Route not found. Drop all packets with dst " << dst);
         m_queue.DropPacketWithDst(dst);
         return;
@@ -2206,6 +2940,7 @@ RoutingProtocol::RouteRequestTimerExpire(Ipv4Address dst)
         NS_LOG_DEBUG("Route down. Stop search. Drop packet with destination " << dst);
         m_addressReqTimer.erase(dst);
         m_routingTable.DeleteRoute(dst);
+        m_discoveries.erase(dst);
         m_queue.DropPacketWithDst(dst);
     }
 }
@@ -2214,8 +2949,30 @@ void
 RoutingProtocol::HelloTimerExpire()
 {
     NS_LOG_FUNCTION(this);
+    if (m_adaptiveHello)
+    {
+        AdaptHelloInterval();
+    }
+    if (m_enablePassiveSensing && !m_enableEtx)
+    {
+        // Neighbors hear every broadcast we send, so a hello is needed only after silence.
+        Time silence = Simulator::Now() - m_lastTxTime;
+        if (m_lastTxTime.IsZero() || silence >= m_currentHelloInterval)
+        {
+            SendHello();
+            silence = Seconds(0);
+        }
+        else
+        {
+            NS_LOG_DEBUG("Hello suppressed, last broadcast at " << m_lastTxTime);
+        }
+        m_htimer.Cancel();
+        m_htimer.Schedule(m_currentHelloInterval - silence);
+        return;
+    }
     Time offset = Time(Seconds(0));
-    if (m_lastBcastTime > Time(Seconds(0)))
+    // With ETX hellos are link probes, a missing one would be counted as lost
+    if (m_lastBcastTime > Time(Seconds(0)) && !m_enableEtx)
     {
         offset = Simulator::Now() - m_lastBcastTime;
         NS_LOG_DEBUG("Hello deferred due to last bcast at:" << m_lastBcastTime);
@@ -2225,11 +2982,75 @@ RoutingProtocol::HelloTimerExpire()
         SendHello();
     }
     m_htimer.Cancel();
-    Time diff = m_helloInterval - offset;
+    Time diff = m_currentHelloInterval - offset;
     m_htimer.Schedule(std::max(Time(Seconds(0)), diff));
     m_lastBcastTime = Time(Seconds(0));
 }
 
+uint16_t
+RoutingProtocol::AccumulateEtx(uint16_t pathEtx, Ipv4Address neighbor) const
+{
+    double etx = pathEtx + std::round(100 * m_nb.GetEtx(neighbor));
+    return static_cast<uint16_t>(std::min<double>(etx, std::numeric_limits<uint16_t>::max()));
+}
+
+bool
+RoutingProtocol::IsBetterPath(const RoutingTableEntry& rt, uint16_t hops, uint16_t pathEtx) const
+{
+    if (rt.GetPathEtx() != 0 && pathEtx != 0)
+    {
+        return pathEtx < rt.GetPathEtx();
+    }
+    return hops < rt.GetHop();
+}
+
+Time
+RoutingProtocol::NextHelloInterval(Time interval,
+                                   uint32_t churn,
+                                   uint32_t neighbors,
+                                   Time minInterval,
+                                   Time maxInterval)
+{
+    /*
+     * Neighbor churn is the number of neighbors that appeared or expired during the last hello
+     * period, relative to the neighborhood size. A quiet neighborhood lets the interval grow by a
+     * quarter per period; once a sizeable share of the neighborhood changes within one period the
+     * interval is halved so that link breaks are noticed sooner.
+     */
+    double ratio = double(churn) / std::max<uint32_t>(1, neighbors);
+    if (churn == 0)
+    {
+        interval = Seconds(interval.GetSeconds() * 1.25);
+    }
+    else if (ratio >= 0.5)
+    {
+        interval = Seconds(interval.GetSeconds() / 2);
+    }
+    return std::min(std::max(interval, minInterval), maxInterval);
+}
+
+void
+RoutingProtocol::AdaptHelloInterval()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t churn = m_nb.GetInsertions() + m_nb.GetExpiries();
+    m_nb.ResetChurnCounters();
+    Time interval = NextHelloInterval(m_currentHelloInterval,
+                                      churn,
+                                      m_nb.GetNeighborCount(),
+                                      m_minHelloInterval,
+                                      m_maxHelloInterval);
+    if (interval != m_currentHelloInterval)
+    {
+        NS_LOG_DEBUG("Neighbor churn " << churn << ", hello interval "
+                                       << m_currentHelloInterval.As(Time::S) << " -> "
+                                       << interval.As(Time::S));
+        // The advertised hello lifetime and the neighbor purge period follow the interval
+        m_currentHelloInterval = interval;
+        m_nb.SetDelay(interval);
+    }
+}
+
 void
 RoutingProtocol::RreqRateLimitTimerExpire()
 {
@@ -2272,7 +3093,7 @@ RoutingProtocol::SendHello()
                                /*dst=*/iface.GetLocal(),
                                /*dstSeqNo=*/m_seqNo,
                                /*origin=*/iface.GetLocal(),
-                               /*lifetime=*/Time(m_allowedHelloLoss * m_helloInterval));
+                               /*lifetime=*/Time(m_allowedHelloLoss * m_currentHelloInterval));
         Ptr<Packet> packet = Create<Packet>();
         SocketIpTtlTag tag;
         tag.SetTtl(1);
@@ -2291,7 +3112,153 @@ RoutingProtocol::SendHello()
             destination = iface.GetBroadcast();
         }
         Time jitter = Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10)));
-        Simulator::Schedule(jitter, &RoutingProtocol::SendTo, this, socket, packet, destination);
+        // With ETX every neighbor has to hear the hello, it is a link probe
+        if (m_enablePiggyback && !m_enableEtx)
+        {
+            // A unicast data packet leaving during the jitter carries the hello instead
+            PendingHello& pending = m_pendingHellos[socket];
+            pending.event.Cancel();
+            pending.hello = helloHeader;
+            pending.event = Simulator::Schedule(jitter,
+                                                &RoutingProtocol::SendPendingHello,
+                                                this,
+                                                socket,
+                                                packet,
+                                                destination);
+        }
+        else
+        {
+            Simulator::Schedule(jitter,
+                                &RoutingProtocol::SendTo,
+                                this,
+                                socket,
+                                packet,
+                                destination);
+        }
+    }
+}
+
+void
+RoutingProtocol::SendPendingHello(Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination)
+{
+    NS_LOG_FUNCTION(this << destination);
+    m_pendingHellos.erase(socket);
+    SendTo(socket, packet, destination);
+}
+
+bool
+RoutingProtocol::CanPiggybackRerr(Ptr<Socket> socket, Ipv4Address nextHop) const
+{
+    auto i = m_pendingRerrs.find(socket);
+    if (i == m_pendingRerrs.end())
+    {
+        return false;
+    }
+    const PendingRerr& pending = i->second;
+    return !pending.broadcast && pending.receivers.size() == 1 &&
+           *pending.receivers.begin() == nextHop && !pending.unreachable.empty() &&
+           pending.unreachable.size() <= std::numeric_limits<uint8_t>::max() &&
+           m_rerrCount < m_rerrRateLimit;
+}
+
+bool
+RoutingProtocol::CanPiggybackHello(Ptr<Socket> socket, Ipv4Address nextHop)
+{
+    // The broadcast reaches every neighbor, a data packet only its next hop
+    return m_pendingHellos.find(socket) != m_pendingHellos.end() &&
+           m_nb.GetNeighborCount() == 1 && m_nb.IsNeighbor(nextHop);
+}
+
+Ptr<Socket>
+RoutingProtocol::FindPiggybackSocket(Ptr<Ipv4Route> route, const Ipv4Header& header)
+{
+    // Ipv4ListRouting delivers to the destination without asking AODV, which would leave the
+    // shim in front of the transport header. The last hop therefore never carries one.
+    if (!m_enablePiggyback || route->GetGateway() == header.GetDestination())
+    {
+        return nullptr;
+    }
+    int32_t ifIndex = m_ipv4->GetInterfaceForDevice(route->GetOutputDevice());
+    Ptr<Socket> socket = FindSocketWithInterfaceAddress(m_ipv4->GetAddress(ifIndex, 0));
+    if (socket && (CanPiggybackHello(socket, route->GetGateway()) ||
+                   CanPiggybackRerr(socket, route->GetGateway())))
+    {
+        return socket;
+    }
+    return nullptr;
+}
+
+void
+RoutingProtocol::AttachPiggyback(Ptr<Ipv4Route> route, Ptr<const Packet>& p, Ipv4Header& header)
+{
+    Ptr<Socket> socket = FindPiggybackSocket(route, header);
+    if (!socket)
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this << p->GetUid() << route->GetGateway());
+    PiggybackHeader shim;
+    shim.SetSender(route->GetSource());
+    auto hello = m_pendingHellos.end();
+    if (CanPiggybackHello(socket, route->GetGateway()))
+    {
+        hello = m_pendingHellos.find(socket);
+        shim.SetHello(hello->second.hello);
+    }
+    bool rerr = CanPiggybackRerr(socket, route->GetGateway());
+    if (rerr)
+    {
+        RerrHeader rerrHeader;
+        const std::map<Ipv4Address, uint32_t>& unreachable = m_pendingRerrs[socket].unreachable;
+        for (auto i = unreachable.begin(); i != unreachable.end(); ++i)
+        {
+            rerrHeader.AddUnDestination(i->first, i->second);
+        }
+        shim.SetRerr(rerrHeader);
+    }
+    // A fragmented packet would leave the shim in the first fragment only
+    int32_t ifIndex = m_ipv4->GetInterfaceForDevice(route->GetOutputDevice());
+    if (header.GetSerializedSize() + p->GetSize() + shim.GetSerializedSize() >
+        m_ipv4->GetMtu(ifIndex))
+    {
+        NS_LOG_LOGIC("No room to piggyback on packet " << p->GetUid());
+        return;
+    }
+    if (hello != m_pendingHellos.end())
+    {
+        hello->second.event.Cancel();
+        m_pendingHellos.erase(hello);
+    }
+    if (rerr)
+    {
+        m_pendingRerrs.erase(socket);
+        m_rerrCount++;
+        CountControl(CONTROL_SENT, AODVTYPE_RERR);
+    }
+    Ptr<Packet> packet = p->Copy();
+    packet->AddHeader(shim);
+    packet->AddPacketTag(PiggybackTag());
+    header.SetPayloadSize(packet->GetSize());
+    p = packet;
+}
+
+void
+RoutingProtocol::RecvPiggyback(const PiggybackHeader& shim, int32_t iif)
+{
+    Ipv4Address sender = shim.GetSender();
+    Ipv4Address receiver = m_ipv4->GetAddress(iif, 0).GetLocal();
+    NS_LOG_FUNCTION(this << sender << receiver);
+    UpdateRouteToNeighbor(sender, receiver);
+    if (shim.HasHello())
+    {
+        ProcessHello(shim.GetHello(), receiver);
+    }
+    if (shim.HasRerr())
+    {
+        CountControl(CONTROL_RECEIVED, AODVTYPE_RERR);
+        Ptr<Packet> packet = Create<Packet>();
+        packet->AddHeader(shim.GetRerr());
+        RecvError(packet, sender);
     }
 }
 
@@ -2299,6 +3266,15 @@ void
 RoutingProtocol::SendPacketFromQueue(Ipv4Address dst, Ptr<Ipv4Route> route)
 {
     NS_LOG_FUNCTION(this);
+    auto discovery = m_discoveries.find(dst);
+    if (discovery != m_discoveries.end())
+    {
+        Time latency = Simulator::Now() - discovery->second.start;
+        m_discoveryLatency.Add(latency.GetMicroSeconds());
+        m_discoveryRings.Add(discovery->second.rings);
+        m_discoveryTrace(dst, latency, discovery->second.rings);
+        m_discoveries.erase(discovery);
+    }
     QueueEntry queueEntry;
     while (m_queue.Dequeue(dst, queueEntry))
     {
@@ -2315,7 +3291,35 @@ RoutingProtocol::SendPacketFromQueue(Ipv4Address dst, Ptr<Ipv4Route> route)
         header.SetSource(route->GetSource());
         header.SetTtl(header.GetTtl() +
                       1); // compensate extra TTL decrement by fake loopback routing
-        ucb(route, p, header);
+        Ptr<const Packet> packet = p;
+        Time residence = Simulator::Now() - queueEntry.GetQueuedTime();
+        m_queueResidence.Add(residence.GetMicroSeconds());
+        m_queueResidenceTrace(packet, residence);
+        AttachPiggyback(route, packet, header);
+        ucb(route, packet, header);
+    }
+}
+
+void
+RoutingProtocol::RouteBecameValid(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    // Drain from a fresh event: the caller is still in the middle of updating the routing table.
+    if (m_queue.Find(dst))
+    {
+        Simulator::ScheduleNow(&RoutingProtocol::DrainQueue, this, dst);
+    }
+}
+
+void
+RoutingProtocol::DrainQueue(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    RoutingTableEntry toDst;
+    if (m_routingTable.LookupValidRoute(dst, toDst))
+    {
+        NS_LOG_LOGIC("Route to " << dst << " became valid, forwarding buffered packets");
+        SendPacketFromQueue(dst, toDst.GetRoute());
     }
 }
 
@@ -2332,9 +3336,16 @@ RoutingProtocol::SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop)
     {
         return;
     }
-    toNextHop.GetPrecursors(precursors);
-    rerrHeader.AddUnDestination(nextHop, toNextHop.GetSeqNo());
     m_routingTable.GetListOfDestinationWithNextHop(nextHop, unreachable);
+    unreachable.insert(std::make_pair(nextHop, toNextHop.GetSeqNo()));
+    // Union of the precursor bitsets of all broken routes
+    m_routingTable.GetPrecursors(unreachable, precursors);
+    if (m_rerrAggregationWindow.IsStrictlyPositive())
+    {
+        QueueRerr(unreachable, precursors);
+        m_routingTable.InvalidateRoutesWithDst(unreachable);
+        return;
+    }
     for (auto i = unreachable.begin(); i != unreachable.end();)
     {
         if (!rerrHeader.AddUnDestination(i->first, i->second))
@@ -2347,14 +3358,11 @@ RoutingProtocol::SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop)
             packet->AddPacketTag(tag);
             packet->AddHeader(rerrHeader);
             packet->AddHeader(typeHeader);
-            SendRerrMessage(packet, precursors);
+            SendRerrMessage(packet, precursors, false);
             rerrHeader.Clear();
         }
         else
         {
-            RoutingTableEntry toDst;
-            m_routingTable.LookupRoute(i->first, toDst);
-            toDst.GetPrecursors(precursors);
             ++i;
         }
     }
@@ -2367,9 +3375,8 @@ RoutingProtocol::SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop)
         packet->AddPacketTag(tag);
         packet->AddHeader(rerrHeader);
         packet->AddHeader(typeHeader);
-        SendRerrMessage(packet, precursors);
+        SendRerrMessage(packet, precursors, false);
     }
-    unreachable.insert(std::make_pair(nextHop, toNextHop.GetSeqNo()));
     m_routingTable.InvalidateRoutesWithDst(unreachable);
 }
 
@@ -2379,6 +3386,32 @@ RoutingProtocol::SendRerrWhenNoRouteToForward(Ipv4Address dst,
                                               Ipv4Address origin)
 {
     NS_LOG_FUNCTION(this);
+    if (m_rerrAggregationWindow.IsStrictlyPositive())
+    {
+        RoutingTableEntry toOrigin;
+        if (m_routingTable.LookupValidRoute(origin, toOrigin))
+        {
+            Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin.GetInterface());
+            NS_ASSERT(socket);
+            PendingRerr& pending = m_pendingRerrs[socket];
+            pending.unreachable[dst] = dstSeqNo;
+            pending.receivers.insert(toOrigin.GetNextHop());
+        }
+        else
+        {
+            for (auto i = m_socketAddresses.begin(); i != m_socketAddresses.end(); ++i)
+            {
+                PendingRerr& pending = m_pendingRerrs[i->first];
+                pending.unreachable[dst] = dstSeqNo;
+                pending.broadcast = true;
+            }
+        }
+        if (!m_rerrAggregationTimer.IsRunning())
+        {
+            m_rerrAggregationTimer.Schedule(m_rerrAggregationWindow);
+        }
+        return;
+    }
     // A node SHOULD NOT originate more than RERR_RATELIMIT RERR messages per second.
     if (m_rerrCount == m_rerrRateLimit)
     {
@@ -2388,6 +3421,7 @@ RoutingProtocol::SendRerrWhenNoRouteToForward(Ipv4Address dst,
         NS_LOG_LOGIC("RerrRateLimit reached at "
                      << Simulator::Now().As(Time::S) << " with timer delay left "
                      << m_rerrRateLimitTimer.GetDelayLeft().As(Time::S) << "; suppressing RERR");
+        CountRateLimited(AODVTYPE_RERR);
         return;
     }
     RerrHeader rerrHeader;
@@ -2405,6 +3439,7 @@ RoutingProtocol::SendRerrWhenNoRouteToForward(Ipv4Address dst,
         NS_ASSERT(socket);
         NS_LOG_LOGIC("Unicast RERR to the source of the data transmission");
         socket->SendTo(packet, 0, InetSocketAddress(toOrigin.GetNextHop(), AODV_PORT));
+        CountControl(CONTROL_SENT, AODVTYPE_RERR);
     }
     else
     {
@@ -2425,12 +3460,15 @@ RoutingProtocol::SendRerrWhenNoRouteToForward(Ipv4Address dst,
                 destination = iface.GetBroadcast();
             }
             socket->SendTo(packet->Copy(), 0, InetSocketAddress(destination, AODV_PORT));
+            CountControl(CONTROL_SENT, AODVTYPE_RERR);
         }
     }
 }
 
 void
-RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> precursors)
+RoutingProtocol::SendRerrMessage(Ptr<Packet> packet,
+                                 std::vector<Ipv4Address> precursors,
+                                 bool forwarded)
 {
     NS_LOG_FUNCTION(this);
 
@@ -2448,8 +3486,10 @@ RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> pr
         NS_LOG_LOGIC("RerrRateLimit reached at "
                      << Simulator::Now().As(Time::S) << " with timer delay left "
                      << m_rerrRateLimitTimer.GetDelayLeft().As(Time::S) << "; suppressing RERR");
+        CountRateLimited(AODVTYPE_RERR);
         return;
     }
+    ControlEvent event = forwarded ? CONTROL_FORWARDED : CONTROL_SENT;
     // If there is only one precursor, RERR SHOULD be unicast toward that precursor
     if (precursors.size() == 1)
     {
@@ -2468,6 +3508,7 @@ RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> pr
                                 packet,
                                 precursors.front());
             m_rerrCount++;
+            CountControl(event, AODVTYPE_RERR);
         }
         return;
     }
@@ -2508,9 +3549,167 @@ RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> pr
                             socket,
                             p,
                             destination);
+        CountControl(event, AODVTYPE_RERR);
+    }
+}
+
+void
+RoutingProtocol::QueueRerr(const std::map<Ipv4Address, uint32_t>& unreachable,
+                           const std::vector<Ipv4Address>& precursors)
+{
+    NS_LOG_FUNCTION(this);
+    RoutingTableEntry toPrecursor;
+    for (auto i = precursors.begin(); i != precursors.end(); ++i)
+    {
+        if (!m_routingTable.LookupValidRoute(*i, toPrecursor))
+        {
+            continue;
+        }
+        Ptr<Socket> socket = FindSocketWithInterfaceAddress(toPrecursor.GetInterface());
+        NS_ASSERT(socket);
+        PendingRerr& pending = m_pendingRerrs[socket];
+        pending.receivers.insert(*i);
+        for (auto j = unreachable.begin(); j != unreachable.end(); ++j)
+        {
+            pending.unreachable[j->first] = j->second;
+        }
+    }
+    if (!m_pendingRerrs.empty() && !m_rerrAggregationTimer.IsRunning())
+    {
+        m_rerrAggregationTimer.Schedule(m_rerrAggregationWindow);
     }
 }
 
+void
+RoutingProtocol::RerrAggregationTimerExpire()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto i = m_pendingRerrs.begin(); i != m_pendingRerrs.end();)
+    {
+        auto iface = m_socketAddresses.find(i->first);
+        if (iface == m_socketAddresses.end())
+        {
+            NS_LOG_LOGIC("Interface is down, drop pending RERR");
+            i = m_pendingRerrs.erase(i);
+            continue;
+        }
+        PendingRerr& pending = i->second;
+        while (!pending.unreachable.empty())
+        {
+            // A node SHOULD NOT originate more than RERR_RATELIMIT RERR messages per second.
+            if (m_rerrCount == m_rerrRateLimit)
+            {
+                NS_ASSERT(m_rerrRateLimitTimer.IsRunning());
+                NS_LOG_LOGIC("RerrRateLimit reached at "
+                             << Simulator::Now().As(Time::S) << "; deferring RERR by "
+                             << m_rerrRateLimitTimer.GetDelayLeft().As(Time::S));
+                CountRateLimited(AODVTYPE_RERR);
+                m_rerrAggregationTimer.Schedule(m_rerrRateLimitTimer.GetDelayLeft());
+                return;
+            }
+            RerrHeader rerrHeader;
+            auto j = pending.unreachable.begin();
+            while (j != pending.unreachable.end() &&
+                   rerrHeader.AddUnDestination(j->first, j->second))
+            {
+                j = pending.unreachable.erase(j);
+            }
+            Ptr<Packet> packet = Create<Packet>();
+            SocketIpTtlTag tag;
+            tag.SetTtl(1);
+            packet->AddPacketTag(tag);
+            packet->AddHeader(rerrHeader);
+            packet->AddHeader(TypeHeader(AODVTYPE_RERR));
+
+            // If there is only one receiver, RERR SHOULD be unicast toward it
+            Ipv4Address destination;
+            if (!pending.broadcast && pending.receivers.size() == 1)
+            {
+                destination = *pending.receivers.begin();
+            }
+            else if (iface->second.GetMask() == Ipv4Mask::GetOnes())
+            {
+                destination = Ipv4Address("255.255.255.255");
+            }
+            else
+            {
+                destination = iface->second.GetBroadcast();
+            }
+            NS_LOG_LOGIC("Send RERR with " << static_cast<uint32_t>(rerrHeader.GetDestCount())
+                                           << " destinations to " << destination);
+            Simulator::Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
+                                &RoutingProtocol::SendTo,
+                                this,
+                                i->first,
+                                packet,
+                                destination);
+            m_rerrCount++;
+            CountControl(CONTROL_SENT, AODVTYPE_RERR);
+        }
+        i = m_pendingRerrs.erase(i);
+    }
+}
+
+void
+RoutingProtocol::CountControl(ControlEvent event, MessageType type)
+{
+    // Rows follow the message types, columns the events
+    uint32_t* counters[4][3] = {
+        {&m_rreqSent, &m_rreqReceived, &m_rreqForwarded},
+        {&m_revRreqSent, &m_revRreqReceived, &m_revRreqForwarded},
+        {&m_rrepSent, &m_rrepReceived, &m_rrepForwarded},
+        {&m_rerrSent, &m_rerrReceived, &m_rerrForwarded},
+    };
+    uint32_t row;
+    switch (type)
+    {
+    case AODVTYPE_RREQ:
+    case AODVTYPE_RREQ_COMPACT:
+        row = 0;
+        break;
+    case AODVTYPE_REV_RREQ:
+    case AODVTYPE_REV_RREQ_COMPACT:
+        row = 1;
+        break;
+    case AODVTYPE_RREP:
+        row = 2;
+        break;
+    case AODVTYPE_RERR:
+        row = 3;
+        break;
+    default:
+        return;
+    }
+    (*counters[row][event])++;
+    switch (event)
+    {
+    case CONTROL_SENT:
+        m_controlSentTrace(type);
+        break;
+    case CONTROL_RECEIVED:
+        m_controlReceivedTrace(type);
+        break;
+    case CONTROL_FORWARDED:
+        m_controlForwardedTrace(type);
+        break;
+    }
+}
+
+void
+RoutingProtocol::CountRateLimited(MessageType type)
+{
+    m_rateLimited++;
+    m_rateLimitedTrace(type);
+}
+
+void
+RoutingProtocol::NotifyQueueDrop(Ptr<const Packet> packet,
+                                 const Ipv4Header& header,
+                                 RequestQueue::DropReason reason)
+{
+    m_queueDropTrace(packet, header, reason);
+}
+
 Ptr<Socket>
 RoutingProtocol::FindSocketWithInterfaceAddress(Ipv4InterfaceAddress addr) const
 {
@@ -2552,7 +3751,7 @@ RoutingProtocol::DoInitialize()
 {
     NS_LOG_FUNCTION(this);
     uint32_t startTime;
-    if (m_enableHello)
+    if (m_enableHello || m_enablePassiveSensing)
     {
         m_htimer.SetFunction(&RoutingProtocol::HelloTimerExpire, this);
         startTime = m_uniformRandomVariable->GetInteger(0, 100);
@@ -17,19 +17,23 @@
 #define AODVROUTINGPROTOCOL_H
 
 #include "aodv-dpd.h"
+#include "aodv-histogram.h"
 #include "aodv-neighbor.h"
 #include "aodv-packet.h"
 #include "aodv-rqueue.h"
 #include "aodv-rtable.h"
 
+#include "ns3/event-id.h"
 #include "ns3/ipv4-interface.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/node.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
 
 #include <map>
+#include <set>
 
 namespace ns3
 {
@@ -54,6 +58,23 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     static TypeId GetTypeId();
     static const uint32_t AODV_PORT;
 
+    /**
+     * Adaptive hello controller: a quiet neighborhood stretches the interval by a quarter, one
+     * where at least half of the entries changed halves it.
+     *
+     * \param interval the current hello interval
+     * \param churn the neighbors added or expired during the last hello period
+     * \param neighbors the number of neighbors
+     * \param minInterval the lower bound of the interval
+     * \param maxInterval the upper bound of the interval
+     * \returns the next hello interval
+     */
+    static Time NextHelloInterval(Time interval,
+                                  uint32_t churn,
+                                  uint32_t neighbors,
+                                  Time minInterval,
+                                  Time maxInterval);
+
     /// constructor
     RoutingProtocol();
     ~RoutingProtocol() override;
@@ -182,6 +203,150 @@ class RoutingProtocol : public Ipv4RoutingProtocol
         return m_enableBroadcast;
     }
 
+    /**
+     * Get the number of route discoveries
+     * \returns the number of RREQ floods this node originated, retries included
+     */
+    uint32_t GetRouteDiscoveries() const
+    {
+        return m_routeDiscoveries;
+    }
+
+    /**
+     * Get the bytes saved by the compact RREQ / REV_RREQ encoding
+     * \returns the bytes saved over the fixed encoding on every request this node sent or
+     *          forwarded, counted per interface
+     */
+    int64_t GetCompactBytesSaved() const
+    {
+        return m_compactBytesSaved;
+    }
+
+    /**
+     * Get the number of routing table entries
+     * \returns the number of entries, valid or not
+     */
+    uint32_t GetRouteTableSize() const
+    {
+        return m_routingTable.GetSize();
+    }
+
+    /**
+     * Get the number of packets buffered while waiting for a route
+     * \returns the request queue length
+     */
+    uint32_t GetQueueSize()
+    {
+        return m_queue.GetSize();
+    }
+
+    /**
+     * Get the peak request queue occupancy
+     * \returns the largest number of packets buffered at once
+     */
+    uint32_t GetQueuePeak() const
+    {
+        return m_queue.GetPeakSize();
+    }
+
+    /**
+     * Get the number of buffered packets dropped because the request queue was full
+     * \returns the number of dropped packets
+     */
+    uint32_t GetQueueOverflowDrops() const
+    {
+        return m_queue.GetDropCount(RequestQueue::DROP_OVERFLOW);
+    }
+
+    /**
+     * Get the number of buffered packets dropped after MaxQueueTime
+     * \returns the number of dropped packets
+     */
+    uint32_t GetQueueTimeoutDrops() const
+    {
+        return m_queue.GetDropCount(RequestQueue::DROP_TIMEOUT);
+    }
+
+    /**
+     * Get the number of buffered packets dropped because route discovery failed
+     * \returns the number of dropped packets
+     */
+    uint32_t GetQueueNoRouteDrops() const
+    {
+        return m_queue.GetDropCount(RequestQueue::DROP_NO_ROUTE);
+    }
+
+    /**
+     * Get the route discovery latency histogram
+     * \returns the time in microseconds from the first RREQ to the route becoming usable, for
+     *          every discovery that succeeded
+     */
+    const LogHistogram& GetDiscoveryLatency() const
+    {
+        return m_discoveryLatency;
+    }
+
+    /**
+     * Get the route discovery ring histogram
+     * \returns the number of RREQ floods, retries included, per successful discovery
+     */
+    const LogHistogram& GetDiscoveryRings() const
+    {
+        return m_discoveryRings;
+    }
+
+    /**
+     * Get the request queue residence histogram
+     * \returns the time in microseconds each packet released from the request queue was buffered
+     */
+    const LogHistogram& GetQueueResidence() const
+    {
+        return m_queueResidence;
+    }
+
+    /**
+     * TracedCallback signature for control message events.
+     *
+     * \param [in] type The message type.
+     */
+    typedef void (*ControlTracedCallback)(MessageType type);
+
+    /**
+     * TracedCallback signature for suppressed duplicate RREQs and REV_RREQs.
+     *
+     * \param [in] origin The originator of the request.
+     * \param [in] id The request ID.
+     */
+    typedef void (*DuplicateTracedCallback)(Ipv4Address origin, uint32_t id);
+
+    /**
+     * TracedCallback signature for request queue drops.
+     *
+     * \param [in] packet The dropped packet.
+     * \param [in] header The IP header of the packet.
+     * \param [in] reason The drop reason.
+     */
+    typedef void (*QueueDropTracedCallback)(Ptr<const Packet> packet,
+                                            const Ipv4Header& header,
+                                            RequestQueue::DropReason reason);
+
+    /**
+     * TracedCallback signature for completed route discoveries.
+     *
+     * \param [in] dst The destination.
+     * \param [in] latency The time from the first RREQ to the route becoming usable.
+     * \param [in] rings The number of RREQ floods, retries included.
+     */
+    typedef void (*DiscoveryTracedCallback)(Ipv4Address dst, Time latency, uint32_t rings);
+
+    /**
+     * TracedCallback signature for packets released from the request queue.
+     *
+     * \param [in] packet The packet.
+     * \param [in] residence The time the packet was buffered.
+     */
+    typedef void (*QueueResidenceTracedCallback)(Ptr<const Packet> packet, Time residence);
+
     /**
      * Assign a fixed random variable stream number to the random variables
      * used by this model.  Return the number of streams (possibly zero) that
@@ -203,6 +368,22 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param mpdu the dropped MPDU
      */
     void NotifyTxError(WifiMacDropReason reason, Ptr<const WifiMpdu> mpdu);
+    /**
+     * PHY receive trace used for passive neighbor sensing: any data or management frame decoded
+     * from a neighbor refreshes its entry in the neighbor list, including unicast frames
+     * addressed to other stations, which the MAC would drop before a promiscuous handler.
+     *
+     * \param packet the received MPDU, MAC header included
+     */
+    void NotifyPhyRxEnd(Ptr<const Packet> packet);
+    /**
+     * PHY transmit trace used for passive neighbor sensing: a group addressed frame is heard by
+     * every neighbor and makes the next hello unnecessary.
+     *
+     * \param packet the transmitted MPDU, MAC header included
+     * \param txPowerW the transmit power in Watts
+     */
+    void NotifyPhyTxBegin(Ptr<const Packet> packet, double txPowerW);
 
     // Protocol parameters.
     uint32_t m_rreqRetries; ///< Maximum number of retransmissions of RREQ with TTL = NetDiameter to
@@ -232,6 +413,11 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     Time m_helloInterval;
     uint32_t m_allowedHelloLoss; ///< Number of hello messages which may be loss for valid link
+    bool m_adaptiveHello;        ///< Indicates whether the hello interval follows neighbor churn
+    Time m_minHelloInterval;     ///< Lower bound of the adaptive hello interval
+    Time m_maxHelloInterval;     ///< Upper bound of the adaptive hello interval
+    /// Hello interval in use; starts at HelloInterval and only changes with AdaptiveHello
+    Time m_currentHelloInterval;
     /**
      * DeletePeriod is intended to provide an upper bound on the time for which an upstream node A
      * can have a neighbor B as an active next hop for destination D, while B has invalidated the
@@ -249,6 +435,26 @@ class RoutingProtocol : public Ipv4RoutingProtocol
                              ///< originated route discovery.
     bool m_enableHello;      ///< Indicates whether a hello messages enable
     bool m_enableBroadcast;  ///< Indicates whether a a broadcast data packets forwarding enable
+    /// Indicates whether neighbors are sensed from overheard frames, with hellos only after silence
+    bool m_enablePassiveSensing;
+    /// Indicates whether routes are selected by accumulated ETX rather than by hop count
+    bool m_enableEtx;
+    /// Indicates whether originated RREQs and REV_RREQs use the compact encoding
+    bool m_compactControlMessages;
+    /**
+     * Time a locally originated route discovery is held back so that discoveries for other
+     * destinations started meanwhile can share one multi-destination RREQ. Zero disables it.
+     */
+    Time m_rreqAggregationDelay;
+    /**
+     * Time unreachable destinations are collected before they are reported, so that link breaks
+     * and forwarding failures in a burst share as few RERRs as possible. Zero disables it.
+     */
+    Time m_rerrAggregationWindow;
+    /// Indicates whether pending hellos and RERRs ride on unicast data packets to the next hop
+    bool m_enablePiggyback;
+    /// Indicates whether a destination answers a RREQ with a REV_RREQ flood instead of a RREP
+    bool m_enableReverseRequest;
 
     /// IP protocol
     Ptr<Ipv4> m_ipv4;
@@ -279,6 +485,97 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     uint16_t m_rreqCount;
     /// Number of RERRs used for RERR rate control
     uint16_t m_rerrCount;
+    /// Number of RREQ floods originated
+    uint32_t m_routeDiscoveries;
+    /// Bytes saved by the compact encoding on sent and forwarded requests
+    int64_t m_compactBytesSaved;
+
+    /**
+     * \name Protocol counters
+     * Control messages are counted per transmission, i.e. once per interface for broadcasts.
+     * Hellos are not counted.
+     * @{
+     */
+    uint32_t m_rreqSent;           ///< RREQs originated
+    uint32_t m_rreqReceived;       ///< RREQs received, duplicates included
+    uint32_t m_rreqForwarded;      ///< RREQs rebroadcast
+    uint32_t m_revRreqSent;        ///< REV_RREQs originated
+    uint32_t m_revRreqReceived;    ///< REV_RREQs received, duplicates included
+    uint32_t m_revRreqForwarded;   ///< REV_RREQs rebroadcast
+    uint32_t m_rrepSent;           ///< RREPs originated by a destination or intermediate node
+    uint32_t m_rrepReceived;       ///< RREPs received
+    uint32_t m_rrepForwarded;      ///< RREPs forwarded toward the originator
+    uint32_t m_rerrSent;           ///< RERRs originated
+    uint32_t m_rerrReceived;       ///< RERRs received, piggybacked ones included
+    uint32_t m_rerrForwarded;      ///< RERRs propagated for a received RERR
+    uint32_t m_duplicateRequests;  ///< RREQs and REV_RREQs dropped by the ID cache
+    uint32_t m_rateLimited;        ///< Requests deferred and RERRs deferred or suppressed
+    uint32_t m_dataForwarded;      ///< Data packets relayed for other nodes
+    uint64_t m_dataBytesForwarded; ///< Bytes of relayed data packets, IP header included
+    /** @} */
+
+    /// Trace fired when a control message is originated
+    TracedCallback<MessageType> m_controlSentTrace;
+    /// Trace fired when a control message is received
+    TracedCallback<MessageType> m_controlReceivedTrace;
+    /// Trace fired when a control message is forwarded
+    TracedCallback<MessageType> m_controlForwardedTrace;
+    /// Trace fired when a request is dropped as a duplicate
+    TracedCallback<Ipv4Address, uint32_t> m_duplicateRequestTrace;
+    /// Trace fired when the rate limit defers or suppresses a message
+    TracedCallback<MessageType> m_rateLimitedTrace;
+    /// Trace fired when the request queue drops a packet
+    TracedCallback<Ptr<const Packet>, const Ipv4Header&, RequestQueue::DropReason>
+        m_queueDropTrace;
+
+    /// Route discovery in progress
+    struct Discovery
+    {
+        Time start;     ///< Time the first RREQ was prepared
+        uint32_t rings; ///< RREQ floods so far, retries included
+    };
+
+    /// Route discoveries in progress, by destination
+    std::map<Ipv4Address, Discovery> m_discoveries;
+    /// Latency of successful route discoveries, in microseconds
+    LogHistogram m_discoveryLatency;
+    /// RREQ floods per successful route discovery
+    LogHistogram m_discoveryRings;
+    /// Time packets spent in the request queue, in microseconds
+    LogHistogram m_queueResidence;
+    /// Trace fired when a route discovery succeeds
+    TracedCallback<Ipv4Address, Time, uint32_t> m_discoveryTrace;
+    /// Trace fired when a packet leaves the request queue with a route
+    TracedCallback<Ptr<const Packet>, Time> m_queueResidenceTrace;
+
+    /// Events counted per control message type
+    enum ControlEvent
+    {
+        CONTROL_SENT,      ///< message originated
+        CONTROL_RECEIVED,  ///< message received
+        CONTROL_FORWARDED, ///< message forwarded
+    };
+
+    /**
+     * Count a control message event and fire the matching trace source
+     * \param event the event
+     * \param type the message type, RREP_ACKs are ignored
+     */
+    void CountControl(ControlEvent event, MessageType type);
+    /**
+     * Count a message the rate limit deferred or suppressed
+     * \param type the message type
+     */
+    void CountRateLimited(MessageType type);
+    /**
+     * Forward request queue drops to the QueueDrop trace source
+     * \param packet the dropped packet
+     * \param header the IP header of the packet
+     * \param reason the drop reason
+     */
+    void NotifyQueueDrop(Ptr<const Packet> packet,
+                         const Ipv4Header& header,
+                         RequestQueue::DropReason reason);
 
   private:
     /// Start protocol operation
@@ -412,12 +709,62 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param route route to use
      */
     void SendPacketFromQueue(Ipv4Address dst, Ptr<Ipv4Route> route);
+    /**
+     * Routing table notification that the route to dst became valid. Schedules the release of
+     * packets buffered for dst, whichever message made the route valid.
+     * \param dst destination address
+     */
+    void RouteBecameValid(Ipv4Address dst);
+    /**
+     * Forward packets buffered for dst if the route to dst is still valid
+     * \param dst destination address
+     */
+    void DrainQueue(Ipv4Address dst);
     /// Send hello
     void SendHello();
     /** Send RREQ
      * \param dst destination address
      */
     void SendRequest(Ipv4Address dst);
+    /** Send one RREQ carrying several destinations in the multi-destination extension
+     * \param dsts destination addresses, at most 256
+     */
+    void SendMultiDestinationRequest(std::vector<Ipv4Address> dsts);
+    /**
+     * Hold back route discovery for dst for RreqAggregationDelay so that it can be merged with
+     * other discoveries into a multi-destination RREQ
+     * \param dst destination address
+     */
+    void QueueRequest(Ipv4Address dst);
+    /**
+     * Start or continue the expanding ring search for dst in the routing table
+     * \param dst destination address
+     * \param dstSeqNo last known destination sequence number
+     * \param unknownSeqNo true if no valid sequence number is known for dst
+     * \returns the TTL to use for this attempt
+     */
+    uint16_t PrepareRouteSearch(Ipv4Address dst, uint32_t& dstSeqNo, bool& unknownSeqNo);
+    /**
+     * Broadcast a locally originated RREQ from each interface used by aodv
+     * \param rreqHeader route request header
+     * \param ttl IP TTL of the request
+     */
+    void BroadcastRequest(RreqHeader& rreqHeader, uint16_t ttl);
+    /**
+     * Answer or prune every destination of a received multi-destination RREQ
+     * \param rreqHeader route request header, rewritten to the destinations left to search
+     * \param src sender address
+     * \returns true if the RREQ must still be forwarded
+     */
+    bool ProcessMultiDestinationRequest(RreqHeader& rreqHeader, Ipv4Address src);
+    /**
+     * Rebroadcast a received RREQ or REV_RREQ with the IP TTL decremented
+     * \param p received packet, carrying the SocketIpTtlTag
+     * \param message the message to forward, type header included; every interface sends a
+     *        copy sharing its buffer
+     * \param compactSavings bytes the message saves by its compact encoding
+     */
+    void ForwardRequest(Ptr<Packet> p, Ptr<const Packet> message, int32_t compactSavings);
     /** Send RREP
      * \param rreqHeader route request header
      * \param toOrigin routing table entry to originator
@@ -443,8 +790,9 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     /** Forward RERR
      * \param packet packet
      * \param precursors list of addresses of the visited nodes
+     * \param forwarded true if the RERR propagates a received one
      */
-    void SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> precursors);
+    void SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> precursors, bool forwarded);
     /**
      * Send RERR message when no route to forward input packet. Unicast if there is reverse route to
      * originating node, broadcast otherwise.
@@ -463,10 +811,79 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void SendTo(Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination);
 
+    /// Hello held for its broadcast jitter so that a unicast data packet can carry it instead
+    struct PendingHello
+    {
+        RrepHeader hello; ///< The hello message
+        EventId event;    ///< Broadcast of the hello if no data packet carries it first
+    };
+
+    /// Hellos waiting out their broadcast jitter, per interface socket
+    std::map<Ptr<Socket>, PendingHello> m_pendingHellos;
+    /**
+     * Broadcast a hello that no data packet carried during its jitter
+     * \param socket the interface socket
+     * \param packet the hello packet
+     * \param destination the broadcast address
+     */
+    void SendPendingHello(Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination);
+    /**
+     * Test whether the pending RERR of an interface can ride on a data packet to a neighbor
+     * \param socket the interface socket
+     * \param nextHop the next hop of the data packet
+     * \returns true if the RERR is due to nextHop alone and the rate limit allows it
+     */
+    bool CanPiggybackRerr(Ptr<Socket> socket, Ipv4Address nextHop) const;
+    /**
+     * Test whether the pending hello of an interface can ride on a data packet to a neighbor
+     * \param socket the interface socket
+     * \param nextHop the next hop of the data packet
+     * \returns true if a hello is pending and nextHop is the only neighbor
+     */
+    bool CanPiggybackHello(Ptr<Socket> socket, Ipv4Address nextHop);
+    /**
+     * Find the interface whose pending control state a unicast data packet can carry
+     * \param route the route the packet leaves on
+     * \param header the IP header of the packet
+     * \returns the interface socket, or null if nothing can be piggybacked
+     */
+    Ptr<Socket> FindPiggybackSocket(Ptr<Ipv4Route> route, const Ipv4Header& header);
+    /**
+     * Move pending hello and RERR state for the next hop of a unicast data packet into a
+     * PiggybackHeader on the packet
+     * \param route the route the packet leaves on
+     * \param p the packet, replaced by a copy carrying the shim if anything was attached
+     * \param header the IP header, its payload size grown by the shim
+     */
+    void AttachPiggyback(Ptr<Ipv4Route> route, Ptr<const Packet>& p, Ipv4Header& header);
+    /**
+     * Process the hello and RERR carried by a data packet
+     * \param shim the piggyback header
+     * \param iif the interface the packet was received on
+     */
+    void RecvPiggyback(const PiggybackHeader& shim, int32_t iif);
+
     /// Hello timer
     Timer m_htimer;
     /// Schedule next send of hello message
     void HelloTimerExpire();
+    /// Adjust the current hello interval to the neighbor churn seen since the last hello period
+    void AdaptHelloInterval();
+    /**
+     * Add the ETX of the link to a neighbor to a path ETX
+     * \param pathEtx the path ETX in hundredths of an expected transmission
+     * \param neighbor the neighbor the message was received from
+     * \returns the accumulated path ETX, saturated at its maximum value
+     */
+    uint16_t AccumulateEtx(uint16_t pathEtx, Ipv4Address neighbor) const;
+    /**
+     * Test whether a newly learnt path should replace an existing route
+     * \param rt the existing route
+     * \param hops the hop count of the new path
+     * \param pathEtx the ETX of the new path in hundredths, 0 if unknown
+     * \returns true if the new path is shorter, by ETX if both paths carry it, else by hop count
+     */
+    bool IsBetterPath(const RoutingTableEntry& rt, uint16_t hops, uint16_t pathEtx) const;
     /// RREQ rate limit timer
     Timer m_rreqRateLimitTimer;
     /// Reset RREQ count and schedule RREQ rate limit timer with delay 1 sec.
@@ -477,6 +894,37 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     void RerrRateLimitTimerExpire();
     /// Map IP address + RREQ timer.
     std::map<Ipv4Address, Timer> m_addressReqTimer;
+    /// Destinations waiting for the RREQ aggregation timer
+    std::vector<Ipv4Address> m_pendingRreqDsts;
+    /// RREQ aggregation timer
+    Timer m_rreqAggregationTimer;
+    /// Send the route requests collected during RreqAggregationDelay
+    void RreqAggregationTimerExpire();
+
+    /// Unreachable destinations waiting to be reported on one interface
+    struct PendingRerr
+    {
+        /// Unreachable destinations and their sequence numbers
+        std::map<Ipv4Address, uint32_t> unreachable;
+        /// Neighbors on the interface that have to learn about the destinations
+        std::set<Ipv4Address> receivers;
+        /// Indicates whether the RERR must be broadcast even to a single receiver
+        bool broadcast{false};
+    };
+
+    /// RERRs waiting for the aggregation window, per interface socket
+    std::map<Ptr<Socket>, PendingRerr> m_pendingRerrs;
+    /// RERR aggregation timer
+    Timer m_rerrAggregationTimer;
+    /**
+     * Queue unreachable destinations for the RERR aggregation window
+     * \param unreachable the unreachable destinations and their sequence numbers
+     * \param precursors the neighbors that use routes to the destinations
+     */
+    void QueueRerr(const std::map<Ipv4Address, uint32_t>& unreachable,
+                   const std::vector<Ipv4Address>& precursors);
+    /// Send the RERRs collected during RerrAggregationWindow, deferring those over the rate limit
+    void RerrAggregationTimerExpire();
     /**
      * Handle route discovery process
      * \param dst the destination IP address
@@ -494,6 +942,8 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     Ptr<UniformRandomVariable> m_uniformRandomVariable;
     /// Keep track of the last bcast time
     Time m_lastBcastTime;
+    /// Time of the last group addressed frame sent, used by passive neighbor sensing
+    Time m_lastTxTime;
 };
 
 } // namespace aodv
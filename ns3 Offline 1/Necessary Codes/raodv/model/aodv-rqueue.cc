@@ -51,10 +51,11 @@ RequestQueue::Enqueue(QueueEntry& entry)
     entry.SetExpireTime(m_queueTimeout);
     if (m_queue.size() == m_maxLen)
     {
-        Drop(m_queue.front(), "Drop the most aged packet"); // Drop the most aged packet
+        Drop(m_queue.front(), DROP_OVERFLOW); // Drop the most aged packet
         m_queue.erase(m_queue.begin());
     }
     m_queue.push_back(entry);
+    m_peak = std::max<uint32_t>(m_peak, m_queue.size());
     return true;
 }
 
@@ -67,7 +68,7 @@ RequestQueue::DropPacketWithDst(Ipv4Address dst)
     {
         if (i->GetIpv4Header().GetDestination() == dst)
         {
-            Drop(*i, "DropPacketWithDst ");
+            Drop(*i, DROP_NO_ROUTE);
         }
     }
     auto new_end = std::remove_if(m_queue.begin(), m_queue.end(), [&](const QueueEntry& en) {
@@ -130,16 +131,23 @@ RequestQueue::Purge()
     {
         if (pred(*i))
         {
-            Drop(*i, "Drop outdated packet ");
+            Drop(*i, DROP_TIMEOUT);
         }
     }
     m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), pred), m_queue.end());
 }
 
 void
-RequestQueue::Drop(QueueEntry en, std::string reason)
+RequestQueue::Drop(QueueEntry en, DropReason reason)
 {
-    NS_LOG_LOGIC(reason << en.GetPacket()->GetUid() << " " << en.GetIpv4Header().GetDestination());
+    NS_LOG_LOGIC("Drop packet " << en.GetPacket()->GetUid() << " to "
+                                << en.GetIpv4Header().GetDestination() << ", reason "
+                                << static_cast<uint32_t>(reason));
+    m_drops[reason]++;
+    if (!m_dropCallback.IsNull())
+    {
+        m_dropCallback(en.GetPacket(), en.GetIpv4Header(), reason);
+    }
     en.GetErrorCallback()(en.GetPacket(), en.GetIpv4Header(), Socket::ERROR_NOROUTETOHOST);
 }
 
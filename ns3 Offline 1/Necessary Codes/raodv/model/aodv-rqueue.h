@@ -19,6 +19,7 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/simulator.h"
 
+#include <array>
 #include <vector>
 
 namespace ns3
@@ -56,7 +57,8 @@ class QueueEntry
           m_header(h),
           m_ucb(ucb),
           m_ecb(ecb),
-          m_expire(exp + Simulator::Now())
+          m_expire(exp + Simulator::Now()),
+          m_queued(Simulator::Now())
     {
     }
 
@@ -163,6 +165,15 @@ class QueueEntry
         return m_expire - Simulator::Now();
     }
 
+    /**
+     * Get the time the entry was created, i.e. the packet was buffered
+     * \returns the queueing time
+     */
+    Time GetQueuedTime() const
+    {
+        return m_queued;
+    }
+
   private:
     /// Data packet
     Ptr<const Packet> m_packet;
@@ -174,6 +185,8 @@ class QueueEntry
     ErrorCallback m_ecb;
     /// Expire time for queue entry
     Time m_expire;
+    /// Time the entry was created
+    Time m_queued;
 };
 
 /**
@@ -185,6 +198,18 @@ class QueueEntry
 class RequestQueue
 {
   public:
+    /// Reasons for dropping a buffered packet
+    enum DropReason
+    {
+        DROP_OVERFLOW, ///< The queue was full and the most aged packet made room
+        DROP_TIMEOUT,  ///< The packet was buffered longer than the queue timeout
+        DROP_NO_ROUTE, ///< Route discovery for the destination failed
+        DROP_REASONS,  ///< Number of drop reasons
+    };
+
+    /// Callback invoked for every dropped packet
+    typedef Callback<void, Ptr<const Packet>, const Ipv4Header&, DropReason> DropCallback;
+
     /**
      * constructor
      *
@@ -193,7 +218,9 @@ class RequestQueue
      */
     RequestQueue(uint32_t maxLen, Time routeToQueueTimeout)
         : m_maxLen(maxLen),
-          m_queueTimeout(routeToQueueTimeout)
+          m_queueTimeout(routeToQueueTimeout),
+          m_peak(0),
+          m_drops{}
     {
     }
 
@@ -229,6 +256,14 @@ class RequestQueue
      */
     uint32_t GetSize();
 
+    /**
+     * \returns the largest number of entries the queue has held
+     */
+    uint32_t GetPeakSize() const
+    {
+        return m_peak;
+    }
+
     // Fields
     /**
      * Get maximum queue length
@@ -266,22 +301,47 @@ class RequestQueue
         m_queueTimeout = t;
     }
 
+    /**
+     * Get the number of packets dropped for a reason
+     * \param reason the drop reason
+     * \returns the number of packets dropped for reason so far
+     */
+    uint32_t GetDropCount(DropReason reason) const
+    {
+        return m_drops[reason];
+    }
+
+    /**
+     * Set the callback invoked for every dropped packet
+     * \param cb the callback
+     */
+    void SetDropCallback(DropCallback cb)
+    {
+        m_dropCallback = cb;
+    }
+
   private:
     /// The queue
     std::vector<QueueEntry> m_queue;
     /// Remove all expired entries
     void Purge();
     /**
-     * Notify that packet is dropped from queue by timeout
+     * Notify that packet is dropped from queue
      * \param en the queue entry to drop
      * \param reason the reason to drop the entry
      */
-    void Drop(QueueEntry en, std::string reason);
+    void Drop(QueueEntry en, DropReason reason);
     /// The maximum number of packets that we allow a routing protocol to buffer.
     uint32_t m_maxLen;
     /// The maximum period of time that a routing protocol is allowed to buffer a packet for,
     /// seconds.
     Time m_queueTimeout;
+    /// Largest number of entries held
+    uint32_t m_peak;
+    /// Number of dropped packets per drop reason
+    std::array<uint32_t, DROP_REASONS> m_drops;
+    /// Callback invoked for every dropped packet
+    DropCallback m_dropCallback;
 };
 
 } // namespace aodv
@@ -20,6 +20,7 @@
 #include "ns3/simulator.h"
 
 #include <algorithm>
+#include <bitset>
 #include <iomanip>
 
 namespace ns3
@@ -30,6 +31,134 @@ NS_LOG_COMPONENT_DEFINE("AodvRoutingTable");
 namespace aodv
 {
 
+/*
+ Precursor slots and sets
+ */
+
+uint32_t
+PrecursorSlots::GetSlot(Ipv4Address addr)
+{
+    auto result = m_slots.insert(std::make_pair(addr, m_addresses.size()));
+    if (result.second)
+    {
+        m_addresses.push_back(addr);
+    }
+    return result.first->second;
+}
+
+bool
+PrecursorSlots::LookupSlot(Ipv4Address addr, uint32_t& slot) const
+{
+    auto i = m_slots.find(addr);
+    if (i == m_slots.end())
+    {
+        return false;
+    }
+    slot = i->second;
+    return true;
+}
+
+bool
+PrecursorSet::Insert(uint32_t slot)
+{
+    uint32_t word = slot / 64;
+    uint64_t bit = uint64_t(1) << (slot % 64);
+    if (word >= m_words.size())
+    {
+        m_words.resize(word + 1, 0);
+    }
+    if (m_words[word] & bit)
+    {
+        return false;
+    }
+    m_words[word] |= bit;
+    return true;
+}
+
+bool
+PrecursorSet::Erase(uint32_t slot)
+{
+    if (!Contains(slot))
+    {
+        return false;
+    }
+    m_words[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    return true;
+}
+
+bool
+PrecursorSet::Contains(uint32_t slot) const
+{
+    uint32_t word = slot / 64;
+    return word < m_words.size() && (m_words[word] & (uint64_t(1) << (slot % 64)));
+}
+
+bool
+PrecursorSet::IsEmpty() const
+{
+    for (auto i = m_words.begin(); i != m_words.end(); ++i)
+    {
+        if (*i != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t
+PrecursorSet::GetCount() const
+{
+    uint32_t count = 0;
+    for (auto i = m_words.begin(); i != m_words.end(); ++i)
+    {
+        count += std::bitset<64>(*i).count();
+    }
+    return count;
+}
+
+void
+PrecursorSet::Union(const PrecursorSet& o)
+{
+    if (o.m_words.size() > m_words.size())
+    {
+        m_words.resize(o.m_words.size(), 0);
+    }
+    for (std::size_t w = 0; w < o.m_words.size(); ++w)
+    {
+        m_words[w] |= o.m_words[w];
+    }
+}
+
+void
+PrecursorSet::Intersect(const PrecursorSet& o)
+{
+    if (m_words.size() > o.m_words.size())
+    {
+        m_words.resize(o.m_words.size());
+    }
+    for (std::size_t w = 0; w < m_words.size(); ++w)
+    {
+        m_words[w] &= o.m_words[w];
+    }
+}
+
+void
+PrecursorSet::GetSlots(std::vector<uint32_t>& slots) const
+{
+    for (std::size_t w = 0; w < m_words.size(); ++w)
+    {
+        uint32_t slot = w * 64;
+        for (uint64_t bits = m_words[w]; bits != 0; bits >>= 1, ++slot)
+        {
+            if (bits & 1)
+            {
+                slots.push_back(slot);
+            }
+        }
+    }
+}
+
 /*
  The Routing Table
  */
@@ -46,6 +175,7 @@ RoutingTableEntry::RoutingTableEntry(Ptr<NetDevice> dev,
       m_validSeqNo(vSeqNo),
       m_seqNo(seqNo),
       m_hops(hops),
+      m_pathEtx(0),
       m_lifeTime(lifetime + Simulator::Now()),
       m_iface(iface),
       m_flag(VALID),
@@ -68,28 +198,22 @@ bool
 RoutingTableEntry::InsertPrecursor(Ipv4Address id)
 {
     NS_LOG_FUNCTION(this << id);
-    if (!LookupPrecursor(id))
-    {
-        m_precursorList.push_back(id);
-        return true;
-    }
-    else
+    if (!m_precursorSlots)
     {
-        return false;
+        m_precursorSlots = std::make_shared<PrecursorSlots>();
     }
+    return m_precursors.Insert(m_precursorSlots->GetSlot(id));
 }
 
 bool
 RoutingTableEntry::LookupPrecursor(Ipv4Address id)
 {
     NS_LOG_FUNCTION(this << id);
-    for (auto i = m_precursorList.begin(); i != m_precursorList.end(); ++i)
+    uint32_t slot;
+    if (m_precursorSlots && m_precursorSlots->LookupSlot(id, slot) && m_precursors.Contains(slot))
     {
-        if (*i == id)
-        {
-            NS_LOG_LOGIC("Precursor " << id << " found");
-            return true;
-        }
+        NS_LOG_LOGIC("Precursor " << id << " found");
+        return true;
     }
     NS_LOG_LOGIC("Precursor " << id << " not found");
     return false;
@@ -99,31 +223,27 @@ bool
 RoutingTableEntry::DeletePrecursor(Ipv4Address id)
 {
     NS_LOG_FUNCTION(this << id);
-    auto i = std::remove(m_precursorList.begin(), m_precursorList.end(), id);
-    if (i == m_precursorList.end())
-    {
-        NS_LOG_LOGIC("Precursor " << id << " not found");
-        return false;
-    }
-    else
+    uint32_t slot;
+    if (m_precursorSlots && m_precursorSlots->LookupSlot(id, slot) && m_precursors.Erase(slot))
     {
         NS_LOG_LOGIC("Precursor " << id << " found");
-        m_precursorList.erase(i, m_precursorList.end());
+        return true;
     }
-    return true;
+    NS_LOG_LOGIC("Precursor " << id << " not found");
+    return false;
 }
 
 void
 RoutingTableEntry::DeleteAllPrecursors()
 {
     NS_LOG_FUNCTION(this);
-    m_precursorList.clear();
+    m_precursors.Clear();
 }
 
 bool
 RoutingTableEntry::IsPrecursorListEmpty() const
 {
-    return m_precursorList.empty();
+    return m_precursors.IsEmpty();
 }
 
 void
@@ -134,22 +254,36 @@ RoutingTableEntry::GetPrecursors(std::vector<Ipv4Address>& prec) const
     {
         return;
     }
-    for (auto i = m_precursorList.begin(); i != m_precursorList.end(); ++i)
+    std::vector<uint32_t> slots;
+    m_precursors.GetSlots(slots);
+    for (auto i = slots.begin(); i != slots.end(); ++i)
     {
-        bool result = true;
-        for (auto j = prec.begin(); j != prec.end(); ++j)
+        Ipv4Address addr = m_precursorSlots->GetAddress(*i);
+        if (std::find(prec.begin(), prec.end(), addr) == prec.end())
         {
-            if (*j == *i)
-            {
-                result = false;
-                break;
-            }
+            prec.push_back(addr);
         }
-        if (result)
+    }
+}
+
+void
+RoutingTableEntry::SetPrecursorSlots(std::shared_ptr<PrecursorSlots> slots)
+{
+    if (m_precursorSlots == slots)
+    {
+        return;
+    }
+    if (m_precursorSlots && !m_precursors.IsEmpty())
+    {
+        std::vector<uint32_t> old;
+        m_precursors.GetSlots(old);
+        m_precursors.Clear();
+        for (auto i = old.begin(); i != old.end(); ++i)
         {
-            prec.push_back(*i);
+            m_precursors.Insert(slots->GetSlot(m_precursorSlots->GetAddress(*i)));
         }
     }
+    m_precursorSlots = slots;
 }
 
 void
@@ -214,7 +348,8 @@ RoutingTableEntry::Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit /* = T
  */
 
 RoutingTable::RoutingTable(Time t)
-    : m_badLinkLifetime(t)
+    : m_badLinkLifetime(t),
+      m_precursorSlots(std::make_shared<PrecursorSlots>())
 {
 }
 
@@ -276,7 +411,12 @@ RoutingTable::AddRoute(RoutingTableEntry& rt)
     {
         rt.SetRreqCnt(0);
     }
+    rt.SetPrecursorSlots(m_precursorSlots);
     auto result = m_ipv4AddressEntry.insert(std::make_pair(rt.GetDestination(), rt));
+    if (result.second && rt.GetFlag() == VALID)
+    {
+        NotifyRouteValid(rt.GetDestination());
+    }
     return result.second;
 }
 
@@ -290,12 +430,18 @@ RoutingTable::Update(RoutingTableEntry& rt)
         NS_LOG_LOGIC("Route update to " << rt.GetDestination() << " fails; not found");
         return false;
     }
+    bool wasValid = (i->second.GetFlag() == VALID);
+    rt.SetPrecursorSlots(m_precursorSlots);
     i->second = rt;
     if (i->second.GetFlag() != IN_SEARCH)
     {
         NS_LOG_LOGIC("Route update to " << rt.GetDestination() << " set RreqCnt to 0");
         i->second.SetRreqCnt(0);
     }
+    if (!wasValid && rt.GetFlag() == VALID)
+    {
+        NotifyRouteValid(rt.GetDestination());
+    }
     return true;
 }
 
@@ -309,12 +455,27 @@ RoutingTable::SetEntryState(Ipv4Address id, RouteFlags state)
         NS_LOG_LOGIC("Route set entry state to " << id << " fails; not found");
         return false;
     }
+    bool wasValid = (i->second.GetFlag() == VALID);
     i->second.SetFlag(state);
     i->second.SetRreqCnt(0);
     NS_LOG_LOGIC("Route set entry state to " << id << ": new state is " << state);
+    if (!wasValid && state == VALID)
+    {
+        NotifyRouteValid(id);
+    }
     return true;
 }
 
+void
+RoutingTable::NotifyRouteValid(Ipv4Address dst) const
+{
+    if (!m_routeValidCallback.IsNull())
+    {
+        NS_LOG_LOGIC("Route to " << dst << " became valid");
+        m_routeValidCallback(dst);
+    }
+}
+
 void
 RoutingTable::GetListOfDestinationWithNextHop(Ipv4Address nextHop,
                                               std::map<Ipv4Address, uint32_t>& unreachable)
@@ -332,6 +493,30 @@ RoutingTable::GetListOfDestinationWithNextHop(Ipv4Address nextHop,
     }
 }
 
+void
+RoutingTable::GetPrecursors(const std::map<Ipv4Address, uint32_t>& dsts,
+                            std::vector<Ipv4Address>& precursors) const
+{
+    NS_LOG_FUNCTION(this);
+    PrecursorSet all;
+    for (auto i = dsts.begin(); i != dsts.end(); ++i)
+    {
+        auto j = m_ipv4AddressEntry.find(i->first);
+        if (j != m_ipv4AddressEntry.end())
+        {
+            all.Union(j->second.GetPrecursorSet());
+        }
+    }
+    std::vector<uint32_t> slots;
+    all.GetSlots(slots);
+    precursors.clear();
+    precursors.reserve(slots.size());
+    for (auto i = slots.begin(); i != slots.end(); ++i)
+    {
+        precursors.push_back(m_precursorSlots->GetAddress(*i));
+    }
+}
+
 void
 RoutingTable::InvalidateRoutesWithDst(const std::map<Ipv4Address, uint32_t>& unreachable)
 {
@@ -16,6 +16,8 @@
 #ifndef AODV_RTABLE_H
 #define AODV_RTABLE_H
 
+#include "ns3/callback.h"
+#include "ns3/ipv4-address.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4.h"
 #include "ns3/net-device.h"
@@ -24,8 +26,11 @@
 
 #include <cassert>
 #include <map>
+#include <memory>
 #include <stdint.h>
 #include <sys/types.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -43,6 +48,114 @@ enum RouteFlags
     IN_SEARCH = 2, //!< IN_SEARCH
 };
 
+/**
+ * \ingroup aodv
+ * \brief Dense slot numbers for the neighbors that appear as precursors
+ *
+ * Slots are handed out in order of first use and never reused, so a node has at most as many
+ * slots as distinct neighbors it has forwarded for.
+ */
+class PrecursorSlots
+{
+  public:
+    /**
+     * Get the slot of a precursor, assigning the next slot to an unknown address
+     * \param addr the precursor address
+     * \returns the slot number
+     */
+    uint32_t GetSlot(Ipv4Address addr);
+    /**
+     * Lookup the slot of a precursor
+     * \param addr the precursor address
+     * \param slot the slot number, if the address has one
+     * \returns true if the address has a slot
+     */
+    bool LookupSlot(Ipv4Address addr, uint32_t& slot) const;
+
+    /**
+     * Get the precursor address of a slot
+     * \param slot the slot number
+     * \returns the precursor address
+     */
+    Ipv4Address GetAddress(uint32_t slot) const
+    {
+        return m_addresses[slot];
+    }
+
+    /**
+     * \returns the number of assigned slots
+     */
+    uint32_t GetSize() const
+    {
+        return m_addresses.size();
+    }
+
+  private:
+    /// Slot of each precursor address
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_slots;
+    /// Precursor address of each slot
+    std::vector<Ipv4Address> m_addresses;
+};
+
+/**
+ * \ingroup aodv
+ * \brief Set of precursor slots stored as a bitset, bit k of word w stands for slot 64 w + k
+ */
+class PrecursorSet
+{
+  public:
+    /**
+     * Insert a slot
+     * \param slot the slot number
+     * \returns true if the slot was not in the set
+     */
+    bool Insert(uint32_t slot);
+    /**
+     * Erase a slot
+     * \param slot the slot number
+     * \returns true if the slot was in the set
+     */
+    bool Erase(uint32_t slot);
+    /**
+     * \param slot the slot number
+     * \returns true if the slot is in the set
+     */
+    bool Contains(uint32_t slot) const;
+    /**
+     * \returns true if no slot is in the set
+     */
+    bool IsEmpty() const;
+    /**
+     * \returns the number of slots in the set
+     */
+    uint32_t GetCount() const;
+    /**
+     * Add all slots of another set to this one
+     * \param o the other set
+     */
+    void Union(const PrecursorSet& o);
+    /**
+     * Keep only the slots that are also in another set
+     * \param o the other set
+     */
+    void Intersect(const PrecursorSet& o);
+    /**
+     * Append the slots of the set in increasing order
+     * \param slots the vector to append to
+     */
+    void GetSlots(std::vector<uint32_t>& slots) const;
+
+    /// Remove all slots
+    void Clear()
+    {
+        m_words.clear();
+    }
+
+  private:
+    /// Bitset words
+    std::vector<uint64_t> m_words;
+};
+
 /**
  * \ingroup aodv
  * \brief Routing table entry
@@ -105,6 +218,30 @@ class RoutingTableEntry
      * \param prec vector of precursor addresses
      */
     void GetPrecursors(std::vector<Ipv4Address>& prec) const;
+
+    /**
+     * Get the precursors as a set of slots of GetPrecursorSlots ()
+     * \returns the precursor set
+     */
+    const PrecursorSet& GetPrecursorSet() const
+    {
+        return m_precursors;
+    }
+
+    /**
+     * Get the slot numbering of the precursor set
+     * \returns the precursor slots, null if no precursor was ever inserted
+     */
+    std::shared_ptr<PrecursorSlots> GetPrecursorSlots() const
+    {
+        return m_precursorSlots;
+    }
+
+    /**
+     * Switch the precursor set to another slot numbering, keeping its precursors
+     * \param slots the precursor slots to use
+     */
+    void SetPrecursorSlots(std::shared_ptr<PrecursorSlots> slots);
     //\}
 
     /**
@@ -249,6 +386,24 @@ class RoutingTableEntry
         return m_hops;
     }
 
+    /**
+     * Set the path ETX
+     * \param etx the path ETX in hundredths of an expected transmission, 0 if unknown
+     */
+    void SetPathEtx(uint16_t etx)
+    {
+        m_pathEtx = etx;
+    }
+
+    /**
+     * Get the path ETX
+     * \returns the path ETX in hundredths of an expected transmission, 0 if unknown
+     */
+    uint16_t GetPathEtx() const
+    {
+        return m_pathEtx;
+    }
+
     /**
      * Set the lifetime
      * \param lt The lifetime
@@ -374,6 +529,8 @@ class RoutingTableEntry
     uint32_t m_seqNo;
     /// Hop Count (number of hops needed to reach destination)
     uint16_t m_hops;
+    /// Path ETX in hundredths of an expected transmission, 0 if the route was not learnt with ETX
+    uint16_t m_pathEtx;
     /**
      * \brief Expiration or deletion time of the route
      * Lifetime field in the routing table plays dual role:
@@ -393,8 +550,10 @@ class RoutingTableEntry
     /// Routing flags: valid, invalid or in search
     RouteFlags m_flag;
 
-    /// List of precursors
-    std::vector<Ipv4Address> m_precursorList;
+    /// Slot numbering of the precursor set, shared by all entries of a routing table
+    std::shared_ptr<PrecursorSlots> m_precursorSlots;
+    /// Set of precursors
+    PrecursorSet m_precursors;
     /// When I can send another request
     Time m_routeRequestTimeout;
     /// Number of route requests
@@ -488,6 +647,14 @@ class RoutingTable
      */
     void GetListOfDestinationWithNextHop(Ipv4Address nextHop,
                                          std::map<Ipv4Address, uint32_t>& unreachable);
+    /**
+     * Get the union of the precursors of the routes to a set of destinations
+     *
+     * \param dsts the destinations, e.g. unreachable destinations with their sequence numbers
+     * \param precursors the precursors of the routes, without duplicates
+     */
+    void GetPrecursors(const std::map<Ipv4Address, uint32_t>& dsts,
+                       std::vector<Ipv4Address>& precursors) const;
     /**
      * Update routing entries with this destination as follows:
      * 1. The destination sequence number of this routing entry, if it
@@ -509,6 +676,14 @@ class RoutingTable
         m_ipv4AddressEntry.clear();
     }
 
+    /**
+     * \returns the number of entries, valid or not
+     */
+    uint32_t GetSize() const
+    {
+        return m_ipv4AddressEntry.size();
+    }
+
     /// Delete all outdated entries and invalidate valid entry if Lifetime is expired
     void Purge();
     /** Mark entry as unidirectional (e.g. add this neighbor to "blacklist" for blacklistTimeout
@@ -525,11 +700,30 @@ class RoutingTable
      */
     void Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
 
+    /**
+     * Set the callback invoked with the destination address whenever AddRoute, Update or
+     * SetEntryState leave an entry VALID that was not VALID (or did not exist) before
+     * \param cb the callback function
+     */
+    void SetRouteValidCallback(Callback<void, Ipv4Address> cb)
+    {
+        m_routeValidCallback = cb;
+    }
+
   private:
     /// The routing table
     std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
     /// Deletion time for invalid routes
     Time m_badLinkLifetime;
+    /// Route became valid callback
+    Callback<void, Ipv4Address> m_routeValidCallback;
+    /// Precursor slot numbering shared by all entries
+    std::shared_ptr<PrecursorSlots> m_precursorSlots;
+    /**
+     * Invoke the route valid callback, if set
+     * \param dst destination address of the entry that became VALID
+     */
+    void NotifyRouteValid(Ipv4Address dst) const;
     /**
      * const version of Purge, for use by Print() method
      * \param table the routing table entry to purge
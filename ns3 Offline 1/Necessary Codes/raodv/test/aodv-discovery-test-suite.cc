@@ -0,0 +1,694 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * System tests of AODV route discovery.
+ */
+
+#include "ns3/aodv-helper.h"
+#include "ns3/aodv-packet.h"
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/yans-wifi-helper.h"
+
+#include <cmath>
+#include <limits>
+#include <set>
+#include <vector>
+
+namespace ns3
+{
+namespace aodv
+{
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Base class for route discovery tests
+ *
+ * Builds a static 802.11a network, records every AODV control message the nodes send and counts
+ * the UDP datagrams each node receives on DISCARD_PORT.
+ */
+class DiscoveryTestCase : public TestCase
+{
+  public:
+    /**
+     * constructor
+     * \param name the test case name
+     */
+    DiscoveryTestCase(std::string name);
+
+  protected:
+    /// An AODV control message that left a node
+    struct ControlMessage
+    {
+        uint32_t node;           ///< Sending node
+        MessageType type;        ///< Message type
+        Ipv4Address destination; ///< IP destination, a broadcast address or the next hop
+        Time time;               ///< Send time
+        Ptr<Packet> message;     ///< The message without its type header
+    };
+
+    /**
+     * \brief Create the nodes with AODV, one UDP sink per node and the control message trace
+     * \param positions the node positions, in meters
+     * \param aodv the AODV helper carrying the attributes under test
+     */
+    void CreateNetwork(const std::vector<Vector>& positions, AodvHelper& aodv);
+    /**
+     * \brief Schedule a UDP datagram
+     * \param at send time
+     * \param from sending node
+     * \param to receiving node
+     */
+    void ScheduleSend(Time at, uint32_t from, uint32_t to);
+    /**
+     * \param node node index
+     * \returns the routing protocol of the node
+     */
+    Ptr<RoutingProtocol> GetRouting(uint32_t node) const;
+    /**
+     * \param node node index
+     * \param type message type
+     * \returns the messages of a type sent by a node, in order
+     */
+    std::vector<Ptr<Packet>> GetSent(uint32_t node, MessageType type) const;
+    /**
+     * \param node node index
+     * \param type message type
+     * \returns the messages of a type sent by a node with their destination and time, in order
+     */
+    std::vector<ControlMessage> GetSentMessages(uint32_t node, MessageType type) const;
+    /**
+     * \param message a RERR without its type header
+     * \returns the unreachable destinations it reports
+     */
+    static std::set<Ipv4Address> GetUnreachable(Ptr<Packet> message);
+
+    static const uint16_t DISCARD_PORT = 9; ///< Port of the UDP sinks
+    NodeContainer m_nodes;                  ///< Nodes under test
+    Ipv4InterfaceContainer m_interfaces;    ///< Node interfaces
+    std::vector<ControlMessage> m_sent;     ///< Control messages sent, in order
+    std::vector<uint32_t> m_received;       ///< Datagrams received per node
+
+  private:
+    /**
+     * \brief Record an AODV control message leaving a node
+     * \param packet the IP packet
+     * \param ipv4 the sending IP stack
+     * \param interface the interface index
+     */
+    void IpTx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+    /**
+     * \brief Count a received datagram
+     * \param socket the receiving socket
+     */
+    void ReceivePkt(Ptr<Socket> socket);
+    /**
+     * \brief Send one datagram
+     * \param from sending node
+     * \param to receiving node
+     */
+    void Send(uint32_t from, uint32_t to);
+
+    std::vector<Ptr<Socket>> m_sockets; ///< One UDP socket per node
+};
+
+DiscoveryTestCase::DiscoveryTestCase(std::string name)
+    : TestCase(name)
+{
+}
+
+void
+DiscoveryTestCase::CreateNetwork(const std::vector<Vector>& positions, AodvHelper& aodv)
+{
+    m_nodes.Create(positions.size());
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator>();
+    for (auto i = positions.begin(); i != positions.end(); ++i)
+    {
+        allocator->Add(*i);
+    }
+    mobility.SetPositionAllocator(allocator);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(m_nodes);
+
+    WifiMacHelper wifiMac;
+    wifiMac.SetType("ns3::AdhocWifiMac");
+    YansWifiPhyHelper wifiPhy;
+    wifiPhy.DisablePreambleDetectionModel();
+    YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default();
+    wifiPhy.SetChannel(wifiChannel.Create());
+    wifiPhy.SetErrorRateModel("ns3::YansErrorRateModel");
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211a);
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                 "DataMode",
+                                 StringValue("OfdmRate6Mbps"),
+                                 "RtsCtsThreshold",
+                                 StringValue("2200"));
+    NetDeviceContainer devices = wifi.Install(wifiPhy, wifiMac, m_nodes);
+    WifiHelper::AssignStreams(devices, 0);
+
+    InternetStackHelper internetStack;
+    internetStack.SetRoutingHelper(aodv);
+    internetStack.Install(m_nodes);
+    aodv.AssignStreams(m_nodes, 100);
+    Ipv4AddressHelper address;
+    address.SetBase("10.1.1.0", "255.255.255.0");
+    m_interfaces = address.Assign(devices);
+
+    m_received.assign(m_nodes.GetN(), 0);
+    for (uint32_t i = 0; i < m_nodes.GetN(); ++i)
+    {
+        m_nodes.Get(i)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+            "Tx",
+            MakeCallback(&DiscoveryTestCase::IpTx, this));
+        Ptr<Socket> socket = Socket::CreateSocket(m_nodes.Get(i), UdpSocketFactory::GetTypeId());
+        socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), DISCARD_PORT));
+        socket->SetRecvCallback(MakeCallback(&DiscoveryTestCase::ReceivePkt, this));
+        m_sockets.push_back(socket);
+    }
+}
+
+void
+DiscoveryTestCase::ScheduleSend(Time at, uint32_t from, uint32_t to)
+{
+    Simulator::ScheduleWithContext(m_nodes.Get(from)->GetId(),
+                                   at,
+                                   &DiscoveryTestCase::Send,
+                                   this,
+                                   from,
+                                   to);
+}
+
+void
+DiscoveryTestCase::Send(uint32_t from, uint32_t to)
+{
+    m_sockets[from]->SendTo(Create<Packet>(64),
+                            0,
+                            InetSocketAddress(m_interfaces.GetAddress(to), DISCARD_PORT));
+}
+
+void
+DiscoveryTestCase::ReceivePkt(Ptr<Socket> socket)
+{
+    while (socket->Recv(std::numeric_limits<uint32_t>::max(), 0))
+    {
+        m_received[socket->GetNode()->GetId()]++;
+    }
+}
+
+void
+DiscoveryTestCase::IpTx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+    Ptr<Packet> p = packet->Copy();
+    Ipv4Header ipHeader;
+    p->RemoveHeader(ipHeader);
+    if (ipHeader.GetProtocol() != UdpL4Protocol::PROT_NUMBER)
+    {
+        return;
+    }
+    UdpHeader udpHeader;
+    p->RemoveHeader(udpHeader);
+    if (udpHeader.GetDestinationPort() != RoutingProtocol::AODV_PORT)
+    {
+        return;
+    }
+    TypeHeader typeHeader;
+    p->RemoveHeader(typeHeader);
+    if (typeHeader.IsValid())
+    {
+        m_sent.push_back({ipv4->GetObject<Node>()->GetId(),
+                          typeHeader.Get(),
+                          ipHeader.GetDestination(),
+                          Simulator::Now(),
+                          p});
+    }
+}
+
+Ptr<RoutingProtocol>
+DiscoveryTestCase::GetRouting(uint32_t node) const
+{
+    return AodvHelper::GetAodv(m_nodes.Get(node));
+}
+
+std::vector<Ptr<Packet>>
+DiscoveryTestCase::GetSent(uint32_t node, MessageType type) const
+{
+    std::vector<Ptr<Packet>> messages;
+    for (auto i = m_sent.begin(); i != m_sent.end(); ++i)
+    {
+        if (i->node == node && i->type == type)
+        {
+            messages.push_back(i->message);
+        }
+    }
+    return messages;
+}
+
+std::vector<DiscoveryTestCase::ControlMessage>
+DiscoveryTestCase::GetSentMessages(uint32_t node, MessageType type) const
+{
+    std::vector<ControlMessage> messages;
+    for (auto i = m_sent.begin(); i != m_sent.end(); ++i)
+    {
+        if (i->node == node && i->type == type)
+        {
+            messages.push_back(*i);
+        }
+    }
+    return messages;
+}
+
+std::set<Ipv4Address>
+DiscoveryTestCase::GetUnreachable(Ptr<Packet> message)
+{
+    RerrHeader rerr;
+    message->Copy()->RemoveHeader(rerr);
+    std::set<Ipv4Address> unreachable;
+    std::pair<Ipv4Address, uint32_t> un;
+    while (rerr.RemoveUnDestination(un))
+    {
+        unreachable.insert(un.first);
+    }
+    return unreachable;
+}
+
+/**
+ * \brief Node positions of the RERR aggregation tests
+ *
+ * Node 1 relays for node 0 into two branches 120 degrees apart, nodes 2, 3 and 4 on one and
+ * nodes 5 and 6 on the other, every hop 120 m long. Nodes of different branches are more than
+ * 200 m apart and out of range of each other.
+ *
+ * \returns the positions of the seven nodes
+ */
+static std::vector<Vector>
+GetBranchPositions()
+{
+    const double hop = 120;
+    const double x = hop / 2;
+    const double y = hop * std::sqrt(3.0) / 2;
+    return {Vector(-hop, 0, 0),
+            Vector(0, 0, 0),
+            Vector(x, y, 0),
+            Vector(2 * x, 2 * y, 0),
+            Vector(3 * x, 3 * y, 0),
+            Vector(x, -y, 0),
+            Vector(2 * x, -2 * y, 0)};
+}
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief An aggregated RREQ keeps a known sequence number of 0 apart from an unknown one
+ *
+ * Node 0 learns node 1 from its hellos, whose sequence number is still 0, and loses it when
+ * node 1 moves away. Node 2 was never heard of. Discoveries for both are aggregated into one
+ * RREQ, which must carry sequence number 0 for node 1 and the U flag for node 2.
+ */
+class MultiDestinationSeqnoTest : public DiscoveryTestCase
+{
+  public:
+    MultiDestinationSeqnoTest()
+        : DiscoveryTestCase("Multi-destination RREQ keeps known and unknown sequence numbers apart")
+    {
+    }
+
+    void DoRun() override
+    {
+        AodvHelper aodv;
+        aodv.Set("RreqAggregationDelay", TimeValue(MilliSeconds(100)));
+        CreateNetwork({Vector(0, 0, 0), Vector(100, 0, 0), Vector(1e5, 0, 0)}, aodv);
+
+        Ptr<MobilityModel> mob = m_nodes.Get(1)->GetObject<MobilityModel>();
+        Simulator::Schedule(Seconds(3), &MobilityModel::SetPosition, mob, Vector(0, 1e5, 0));
+        ScheduleSend(Seconds(8), 0, 2);
+        ScheduleSend(Seconds(8.01), 0, 1);
+        Simulator::Stop(Seconds(9));
+        Simulator::Run();
+
+        std::vector<Ptr<Packet>> requests = GetSent(0, AODVTYPE_RREQ);
+        NS_TEST_ASSERT_MSG_EQ(requests.empty(), false, "Node 0 searched for routes");
+        RreqHeader rreq;
+        requests.front()->RemoveHeader(rreq);
+        NS_TEST_EXPECT_MSG_EQ(rreq.GetMultiDestination(), true, "Discoveries were aggregated");
+        NS_TEST_EXPECT_MSG_EQ(rreq.GetDst(), m_interfaces.GetAddress(2), "First destination");
+        NS_TEST_EXPECT_MSG_EQ(rreq.GetUnknownSeqno(), true, "Node 2 was never heard of");
+        NS_TEST_ASSERT_MSG_EQ(rreq.GetDestinations().size(), 1, "One additional destination");
+        const RreqHeader::Destination& extra = rreq.GetDestinations().front();
+        NS_TEST_EXPECT_MSG_EQ(extra.address, m_interfaces.GetAddress(1), "Second destination");
+        NS_TEST_EXPECT_MSG_EQ(extra.unknownSeqno, false, "The hellos of node 1 told its seqno");
+        NS_TEST_EXPECT_MSG_EQ(extra.seqNo, 0, "Node 1 never incremented its seqno");
+
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Discoveries queued within the aggregation delay share one RREQ and are all answered
+ *
+ * Node 0 has no route to either of its two neighbors, which hear no hellos, when it sends to
+ * both within RreqAggregationDelay. It must flood a single multi-destination RREQ, both
+ * destinations must answer it and both queued datagrams must be delivered.
+ */
+class MultiDestinationAnswerTest : public DiscoveryTestCase
+{
+  public:
+    MultiDestinationAnswerTest()
+        : DiscoveryTestCase("Multi-destination RREQ is answered by every destination")
+    {
+    }
+
+    void DoRun() override
+    {
+        AodvHelper aodv;
+        aodv.Set("RreqAggregationDelay", TimeValue(MilliSeconds(100)));
+        aodv.Set("EnableHello", BooleanValue(false));
+        CreateNetwork({Vector(0, 0, 0), Vector(120, 0, 0), Vector(-120, 0, 0)}, aodv);
+
+        ScheduleSend(Seconds(1), 0, 2);
+        ScheduleSend(Seconds(1.05), 0, 1);
+        Simulator::Stop(Seconds(3));
+        Simulator::Run();
+
+        std::vector<Ptr<Packet>> requests = GetSent(0, AODVTYPE_RREQ);
+        NS_TEST_ASSERT_MSG_EQ(requests.size(), 1, "Node 0 sent one RREQ for both destinations");
+        RreqHeader rreq;
+        requests.front()->RemoveHeader(rreq);
+        NS_TEST_EXPECT_MSG_EQ(rreq.GetMultiDestination(), true, "Discoveries were aggregated");
+        NS_TEST_EXPECT_MSG_EQ(rreq.GetDst(), m_interfaces.GetAddress(2), "First destination");
+        NS_TEST_ASSERT_MSG_EQ(rreq.GetDestinations().size(), 1, "One additional destination");
+        NS_TEST_EXPECT_MSG_EQ(rreq.GetDestinations().front().address,
+                              m_interfaces.GetAddress(1),
+                              "Second destination");
+
+        NS_TEST_EXPECT_MSG_EQ(GetSent(1, AODVTYPE_REV_RREQ).empty(), false, "Node 1 answered");
+        NS_TEST_EXPECT_MSG_EQ(GetSent(2, AODVTYPE_REV_RREQ).empty(), false, "Node 2 answered");
+        NS_TEST_EXPECT_MSG_EQ(m_received[1], 1, "Datagram to node 1 delivered");
+        NS_TEST_EXPECT_MSG_EQ(m_received[2], 1, "Datagram to node 2 delivered");
+
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief With passive neighbor sensing, unicast traffic does not suppress hellos
+ *
+ * Node 0 sends only unicast datagrams to node 1 for nine seconds. Node 2 cannot rely on having
+ * decoded them, so node 0 must keep sending hellos and node 2 must still reach it without a
+ * route discovery afterwards.
+ */
+class PassiveSensingUnicastTest : public DiscoveryTestCase
+{
+  public:
+    PassiveSensingUnicastTest()
+        : DiscoveryTestCase("Passive sensing keeps neighbors of a node sending only unicast")
+    {
+    }
+
+    void DoRun() override
+    {
+        AodvHelper aodv;
+        aodv.Set("EnablePassiveNeighborSensing", BooleanValue(true));
+        CreateNetwork({Vector(0, 0, 0), Vector(100, 0, 0), Vector(0, 100, 0)}, aodv);
+
+        for (uint32_t k = 10; k < 100; ++k)
+        {
+            ScheduleSend(MilliSeconds(100 * k), 0, 1);
+        }
+        ScheduleSend(Seconds(10), 2, 0);
+        Simulator::Stop(Seconds(11));
+        Simulator::Run();
+
+        NS_TEST_EXPECT_MSG_EQ(m_received[1], 90, "Unicast stream delivered");
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(GetSent(0, AODVTYPE_RREP).size(),
+                                    9,
+                                    "Unicast frames did not suppress the hellos of node 0");
+        NS_TEST_EXPECT_MSG_EQ(GetSent(2, AODVTYPE_RREQ).size(), 0, "Node 2 kept node 0");
+        NS_TEST_EXPECT_MSG_EQ(m_received[0], 1, "Node 2 reached node 0");
+
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief A data packet does not take the hello away from the other neighbors
+ *
+ * With piggybacking on, node 0 forwards a stream through node 1 while node 2 is a neighbor of
+ * node 0 that hears only broadcasts. Node 0 has two neighbors, so its hellos must still be
+ * broadcast and node 2 must reach node 0 without a route discovery afterwards.
+ */
+class PiggybackHelloTest : public DiscoveryTestCase
+{
+  public:
+    PiggybackHelloTest()
+        : DiscoveryTestCase("Piggybacking keeps the hello broadcast with several neighbors")
+    {
+    }
+
+    void DoRun() override
+    {
+        AodvHelper aodv;
+        aodv.Set("EnablePiggyback", BooleanValue(true));
+        CreateNetwork({Vector(0, 0, 0), Vector(120, 0, 0), Vector(0, 120, 0), Vector(240, 0, 0)},
+                      aodv);
+
+        for (uint32_t k = 10; k < 100; ++k)
+        {
+            ScheduleSend(MilliSeconds(100 * k), 0, 3);
+        }
+        ScheduleSend(Seconds(10), 2, 0);
+        Simulator::Stop(Seconds(11));
+        Simulator::Run();
+
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(GetSent(0, AODVTYPE_RREP).size(),
+                                    9,
+                                    "Data packets did not replace the hellos of node 0");
+        NS_TEST_EXPECT_MSG_EQ(GetSent(2, AODVTYPE_RREQ).size(), 0, "Node 2 kept node 0");
+        NS_TEST_EXPECT_MSG_EQ(m_received[0], 1, "Node 2 reached node 0");
+
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Without reverse requests the destination answers with a single RREP
+ *
+ * The module runs as the AODV baseline of the drivers. Node 0 searches for node 2 two hops away,
+ * which must unicast one RREP back instead of flooding a REV_RREQ, and the queued datagram must
+ * arrive over the route it sets up.
+ */
+class ReverseRequestDisabledTest : public DiscoveryTestCase
+{
+  public:
+    ReverseRequestDisabledTest()
+        : DiscoveryTestCase("Discovery without reverse requests is answered by a RREP")
+    {
+    }
+
+    void DoRun() override
+    {
+        AodvHelper aodv;
+        aodv.Set("EnableReverseRequest", BooleanValue(false));
+        // Hellos are RREPs too; without them every RREP sent answers a RREQ
+        aodv.Set("EnableHello", BooleanValue(false));
+        CreateNetwork({Vector(0, 0, 0), Vector(120, 0, 0), Vector(240, 0, 0)}, aodv);
+
+        ScheduleSend(Seconds(1), 0, 2);
+        Simulator::Stop(Seconds(5));
+        Simulator::Run();
+
+        UintegerValue rrepSent;
+        GetRouting(2)->GetAttribute("RrepSent", rrepSent);
+        UintegerValue revRreqSent;
+        GetRouting(2)->GetAttribute("RevRreqSent", revRreqSent);
+        NS_TEST_EXPECT_MSG_EQ(rrepSent.Get(), 1, "Node 2 answered with one RREP");
+        NS_TEST_EXPECT_MSG_EQ(GetSent(2, AODVTYPE_RREP).size(), 1, "One RREP on the air");
+        NS_TEST_EXPECT_MSG_EQ(revRreqSent.Get(), 0, "No REV_RREQ originated");
+        NS_TEST_EXPECT_MSG_EQ(GetSent(2, AODVTYPE_REV_RREQ).size(), 0, "No REV_RREQ on the air");
+        NS_TEST_EXPECT_MSG_EQ(m_received[2], 1, "Queued datagram delivered");
+
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief A broken link is reported in one RERR, unicast to the single precursor
+ *
+ * Node 0 sends to nodes 3, 4 and 6 through node 1, so node 0 is the only precursor of node 1.
+ * When node 2 leaves, node 1 must report nodes 2, 3 and 4 in one RERR unicast to node 0, also
+ * when a datagram it no longer has a route for arrives within the window. With RerrRateLimit
+ * at one RERR per second, the RERR for node 5 leaving in the same second must be deferred, not
+ * dropped, and go out when the rate limit timer expires at 4 s.
+ */
+class RerrAggregationUnicastTest : public DiscoveryTestCase
+{
+  public:
+    RerrAggregationUnicastTest()
+        : DiscoveryTestCase("Aggregated RERR is unicast to a single precursor and deferred")
+    {
+    }
+
+    void DoRun() override
+    {
+        AodvHelper aodv;
+        aodv.Set("RerrAggregationWindow", TimeValue(MilliSeconds(100)));
+        aodv.Set("RerrRateLimit", UintegerValue(1));
+        // Precursors are set up by RREPs; without hellos only the data packets below detect the
+        // broken links, at known times
+        aodv.Set("EnableReverseRequest", BooleanValue(false));
+        aodv.Set("EnableHello", BooleanValue(false));
+        CreateNetwork(GetBranchPositions(), aodv);
+
+        ScheduleSend(Seconds(1), 0, 3);
+        ScheduleSend(Seconds(1.2), 0, 4);
+        ScheduleSend(Seconds(1.4), 0, 6);
+        Ptr<MobilityModel> mob2 = m_nodes.Get(2)->GetObject<MobilityModel>();
+        Simulator::Schedule(Seconds(2.9), &MobilityModel::SetPosition, mob2, Vector(0, 1e5, 0));
+        ScheduleSend(Seconds(3), 0, 3);
+        // Node 1 drops the first datagram after its retries, well before this one arrives; node 0
+        // still has the route and node 1 reports node 4 again, into the pending RERR
+        ScheduleSend(Seconds(3.05), 0, 4);
+        Ptr<MobilityModel> mob5 = m_nodes.Get(5)->GetObject<MobilityModel>();
+        Simulator::Schedule(Seconds(3.3), &MobilityModel::SetPosition, mob5, Vector(0, -1e5, 0));
+        ScheduleSend(Seconds(3.4), 0, 6);
+        Simulator::Stop(Seconds(4.3));
+        Simulator::Run();
+
+        NS_TEST_EXPECT_MSG_EQ(m_received[3], 1, "First datagram to node 3 delivered");
+        NS_TEST_EXPECT_MSG_EQ(m_received[4], 1, "Datagram to node 4 delivered");
+        NS_TEST_EXPECT_MSG_EQ(m_received[6], 1, "First datagram to node 6 delivered");
+        std::vector<ControlMessage> errors = GetSentMessages(1, AODVTYPE_RERR);
+        NS_TEST_ASSERT_MSG_EQ(errors.size(), 2, "One RERR per broken link");
+
+        std::set<Ipv4Address> first = {m_interfaces.GetAddress(2),
+                                       m_interfaces.GetAddress(3),
+                                       m_interfaces.GetAddress(4)};
+        NS_TEST_EXPECT_MSG_EQ((GetUnreachable(errors[0].message) == first),
+                              true,
+                              "First RERR reports every destination behind node 2");
+        NS_TEST_EXPECT_MSG_EQ(errors[0].destination,
+                              m_interfaces.GetAddress(0),
+                              "First RERR unicast to node 0");
+        NS_TEST_EXPECT_MSG_LT(errors[0].time, Seconds(3.5), "First RERR within the window");
+
+        std::set<Ipv4Address> second = {m_interfaces.GetAddress(5), m_interfaces.GetAddress(6)};
+        NS_TEST_EXPECT_MSG_EQ((GetUnreachable(errors[1].message) == second),
+                              true,
+                              "Second RERR reports every destination behind node 5");
+        NS_TEST_EXPECT_MSG_EQ(errors[1].destination,
+                              m_interfaces.GetAddress(0),
+                              "Second RERR unicast to node 0");
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(errors[1].time,
+                                    Seconds(4),
+                                    "Second RERR deferred to the next rate limit period");
+        UintegerValue rateLimited;
+        GetRouting(1)->GetAttribute("RateLimited", rateLimited);
+        NS_TEST_EXPECT_MSG_EQ(rateLimited.Get(), 1, "Second RERR deferred once");
+        UintegerValue rerrSent;
+        GetRouting(1)->GetAttribute("RerrSent", rerrSent);
+        NS_TEST_EXPECT_MSG_EQ(rerrSent.Get(), 2, "Both RERRs counted as originated");
+
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief A broken link with several precursors is reported in one broadcast RERR
+ *
+ * Node 0 sends to node 3 and node 6 to node 4, both through node 1, so nodes 0 and 5 are
+ * precursors of node 1. When node 2 leaves, node 1 must report nodes 2, 3 and 4 in one RERR
+ * broadcast to both.
+ */
+class RerrAggregationBroadcastTest : public DiscoveryTestCase
+{
+  public:
+    RerrAggregationBroadcastTest()
+        : DiscoveryTestCase("Aggregated RERR is broadcast to several precursors")
+    {
+    }
+
+    void DoRun() override
+    {
+        AodvHelper aodv;
+        aodv.Set("RerrAggregationWindow", TimeValue(MilliSeconds(100)));
+        aodv.Set("EnableReverseRequest", BooleanValue(false));
+        aodv.Set("EnableHello", BooleanValue(false));
+        CreateNetwork(GetBranchPositions(), aodv);
+
+        ScheduleSend(Seconds(1), 0, 3);
+        ScheduleSend(Seconds(1.2), 6, 4);
+        Ptr<MobilityModel> mob = m_nodes.Get(2)->GetObject<MobilityModel>();
+        Simulator::Schedule(Seconds(2.9), &MobilityModel::SetPosition, mob, Vector(0, 1e5, 0));
+        ScheduleSend(Seconds(3), 0, 3);
+        Simulator::Stop(Seconds(3.8));
+        Simulator::Run();
+
+        NS_TEST_EXPECT_MSG_EQ(m_received[3], 1, "First datagram to node 3 delivered");
+        NS_TEST_EXPECT_MSG_EQ(m_received[4], 1, "Datagram to node 4 delivered");
+        std::vector<ControlMessage> errors = GetSentMessages(1, AODVTYPE_RERR);
+        NS_TEST_ASSERT_MSG_EQ(errors.size(), 1, "One RERR for the broken link");
+        std::set<Ipv4Address> unreachable = {m_interfaces.GetAddress(2),
+                                             m_interfaces.GetAddress(3),
+                                             m_interfaces.GetAddress(4)};
+        NS_TEST_EXPECT_MSG_EQ((GetUnreachable(errors[0].message) == unreachable),
+                              true,
+                              "RERR reports every destination behind node 2");
+        NS_TEST_EXPECT_MSG_EQ(errors[0].destination,
+                              Ipv4Address("10.1.1.255"),
+                              "RERR broadcast to both precursors");
+
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief AODV route discovery test suite
+ */
+class AodvDiscoveryTestSuite : public TestSuite
+{
+  public:
+    AodvDiscoveryTestSuite()
+        : TestSuite("routing-aodv-discovery", Type::SYSTEM)
+    {
+        AddTestCase(new MultiDestinationSeqnoTest(), TestCase::Duration::QUICK);
+        AddTestCase(new MultiDestinationAnswerTest(), TestCase::Duration::QUICK);
+        AddTestCase(new PassiveSensingUnicastTest(), TestCase::Duration::QUICK);
+        AddTestCase(new PiggybackHelloTest(), TestCase::Duration::QUICK);
+        AddTestCase(new ReverseRequestDisabledTest(), TestCase::Duration::QUICK);
+        AddTestCase(new RerrAggregationUnicastTest(), TestCase::Duration::QUICK);
+        AddTestCase(new RerrAggregationBroadcastTest(), TestCase::Duration::QUICK);
+    }
+} g_aodvDiscoveryTestSuite; ///< the test suite
+
+} // namespace aodv
+} // namespace ns3
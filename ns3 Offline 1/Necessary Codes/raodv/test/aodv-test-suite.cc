@@ -5,13 +5,18 @@
  *
  * Authors: Pavel Boyko <boyko@iitp.ru>
  */
+#include "ns3/aodv-histogram.h"
 #include "ns3/aodv-neighbor.h"
 #include "ns3/aodv-packet.h"
+#include "ns3/aodv-replay-mobility-model.h"
+#include "ns3/aodv-routing-protocol.h"
 #include "ns3/aodv-rqueue.h"
 #include "ns3/aodv-rtable.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/test.h"
 
+#include <cmath>
+
 namespace ns3
 {
 namespace aodv
@@ -58,6 +63,12 @@ NeighborTest::CheckTimeout1()
     NS_TEST_EXPECT_MSG_EQ(neighbor->IsNeighbor(Ipv4Address("1.1.1.1")), true, "Neighbor exists");
     NS_TEST_EXPECT_MSG_EQ(neighbor->IsNeighbor(Ipv4Address("2.2.2.2")), true, "Neighbor exists");
     NS_TEST_EXPECT_MSG_EQ(neighbor->IsNeighbor(Ipv4Address("3.3.3.3")), true, "Neighbor exists");
+    // One of the two hellos expected since the previous one was lost
+    neighbor->RecordHello(Ipv4Address("3.3.3.3"), Seconds(1));
+    NS_TEST_EXPECT_MSG_EQ_TOL(neighbor->GetEtx(Ipv4Address("3.3.3.3")),
+                              1 / (0.91 * 0.91),
+                              1e-9,
+                              "ETX grows with hello loss");
 }
 
 void
@@ -111,9 +122,24 @@ NeighborTest::DoRun()
     NS_TEST_EXPECT_MSG_EQ(neighbor->GetExpireTime(Ipv4Address("4.3.2.1")),
                           Seconds(0),
                           "Known expire time");
+    NS_TEST_EXPECT_MSG_EQ(neighbor->UpdateByMac(Mac48Address("00:00:00:00:00:09"), Seconds(1)),
+                          Ipv4Address(),
+                          "Unknown hardware address");
+    neighbor->Refresh(Ipv4Address("1.1.1.1"), Seconds(2));
+    NS_TEST_EXPECT_MSG_EQ(neighbor->GetExpireTime(Ipv4Address("1.1.1.1")),
+                          Seconds(2),
+                          "No hello lifetime advertised yet");
+    neighbor->UpdateHello(Ipv4Address("1.1.1.1"), Seconds(4));
+    neighbor->Refresh(Ipv4Address("1.1.1.1"), Seconds(1));
+    NS_TEST_EXPECT_MSG_EQ(neighbor->GetExpireTime(Ipv4Address("1.1.1.1")),
+                          Seconds(4),
+                          "Refresh keeps the advertised hello lifetime");
     neighbor->Update(Ipv4Address("1.1.1.1"), Seconds(5));
     neighbor->Update(Ipv4Address("2.2.2.2"), Seconds(10));
     neighbor->Update(Ipv4Address("3.3.3.3"), Seconds(20));
+    neighbor->RecordHello(Ipv4Address("3.3.3.3"), Seconds(1));
+    NS_TEST_EXPECT_MSG_EQ(neighbor->GetEtx(Ipv4Address("3.3.3.3")), 1, "No loss seen yet");
+    NS_TEST_EXPECT_MSG_EQ(neighbor->GetEtx(Ipv4Address("4.3.2.1")), 1, "Unknown neighbor");
 
     Simulator::Schedule(Seconds(2), &NeighborTest::CheckTimeout1, this);
     Simulator::Schedule(Seconds(15), &NeighborTest::CheckTimeout2, this);
@@ -208,6 +234,316 @@ struct RreqHeaderTest : public TestCase
     }
 };
 
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for RREQ multi-destination extension
+ */
+struct RreqMultiDestinationHeaderTest : public TestCase
+{
+    RreqMultiDestinationHeaderTest()
+        : TestCase("AODV multi-destination RREQ")
+    {
+    }
+
+    void DoRun() override
+    {
+        RreqHeader h(/*flags*/ 0,
+                     /*reserved*/ 0,
+                     /*hopCount*/ 2,
+                     /*requestID*/ 7,
+                     /*dst*/ Ipv4Address("1.2.3.4"),
+                     /*dstSeqNo*/ 40,
+                     /*origin*/ Ipv4Address("4.3.2.1"),
+                     /*originSeqNo*/ 10);
+        NS_TEST_EXPECT_MSG_EQ(h.GetMultiDestination(), false, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.AddDestination(Ipv4Address("1.1.1.1"), 5, true), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.AddDestination(Ipv4Address("2.2.2.2"), 12), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.AddDestination(Ipv4Address("3.3.3.3"), 0), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetMultiDestination(), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetDestinations().size(), 3, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetDestinations()[0].unknownSeqno, true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetDestinations()[0].seqNo, 0, "Unknown sequence number is 0");
+        NS_TEST_EXPECT_MSG_EQ(h.GetDestinations()[1].address, Ipv4Address("2.2.2.2"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetDestinations()[1].seqNo, 12, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetDestinations()[2].unknownSeqno,
+                              false,
+                              "Sequence number 0 is a known one");
+        h.SetUnknownSeqno(true);
+        NS_TEST_EXPECT_MSG_EQ(h.GetMultiDestination(), true, "Flags are independent");
+
+        Ptr<Packet> p = Create<Packet>();
+        p->AddHeader(h);
+        RreqHeader h2;
+        uint32_t bytes = p->RemoveHeader(h2);
+        NS_TEST_EXPECT_MSG_EQ(bytes, 23 + 1 + 3 * 9, "RREQ with three extra destinations");
+        NS_TEST_EXPECT_MSG_EQ(h, h2, "Round trip serialization works");
+        NS_TEST_EXPECT_MSG_EQ(h2.GetDestinations()[0].unknownSeqno, true, "U flag survives");
+        NS_TEST_EXPECT_MSG_EQ(h2.GetDestinations()[2].unknownSeqno, false, "U flag survives");
+
+        for (uint32_t i = 3; i < 255; ++i)
+        {
+            h.AddDestination(Ipv4Address(i), i);
+        }
+        NS_TEST_EXPECT_MSG_EQ(h.GetDestinations().size(), 255, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.AddDestination(Ipv4Address("4.4.4.4"), 1), false, "Extension full");
+
+        h.ClearDestinations();
+        NS_TEST_EXPECT_MSG_EQ(h.GetMultiDestination(), false, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetSerializedSize(), 23, "Plain RREQ size restored");
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for the path ETX extension of RREQ and REV_RREQ
+ */
+struct PathEtxHeaderTest : public TestCase
+{
+    PathEtxHeaderTest()
+        : TestCase("AODV path ETX extension")
+    {
+    }
+
+    void DoRun() override
+    {
+        RreqHeader h(/*flags*/ 0,
+                     /*reserved*/ 0,
+                     /*hopCount*/ 2,
+                     /*requestID*/ 7,
+                     /*dst*/ Ipv4Address("1.2.3.4"),
+                     /*dstSeqNo*/ 40,
+                     /*origin*/ Ipv4Address("4.3.2.1"),
+                     /*originSeqNo*/ 10);
+        NS_TEST_EXPECT_MSG_EQ(h.HasPathEtx(), false, "trivial");
+        h.SetPathEtx(250);
+        NS_TEST_EXPECT_MSG_EQ(h.HasPathEtx(), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetPathEtx(), 250, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetUnknownSeqno(), false, "Flags are independent");
+        h.AddDestination(Ipv4Address("1.1.1.1"), 3);
+
+        Ptr<Packet> p = Create<Packet>();
+        p->AddHeader(h);
+        RreqHeader h2;
+        uint32_t bytes = p->RemoveHeader(h2);
+        NS_TEST_EXPECT_MSG_EQ(bytes, 23 + 1 + 9 + 2, "RREQ with one extra destination and ETX");
+        NS_TEST_EXPECT_MSG_EQ(h, h2, "Round trip serialization works");
+
+        RrevreqHeader r(/*flags*/ 0,
+                        /*reserved*/ 0,
+                        /*hopCount*/ 1,
+                        /*requestID*/ 3,
+                        /*dst*/ Ipv4Address("4.3.2.1"),
+                        /*dstSeqNo*/ 10,
+                        /*origin*/ Ipv4Address("1.2.3.4"),
+                        /*originSeqNo*/ 41);
+        NS_TEST_EXPECT_MSG_EQ(r.GetSerializedSize(), 23, "Plain REV_RREQ size");
+        r.SetPathEtx(0);
+        NS_TEST_EXPECT_MSG_EQ(r.HasPathEtx(), true, "Zero path ETX is carried by the originator");
+        r.SetPathEtx(65535);
+        p = Create<Packet>();
+        p->AddHeader(r);
+        RrevreqHeader r2;
+        bytes = p->RemoveHeader(r2);
+        NS_TEST_EXPECT_MSG_EQ(bytes, 25, "REV_RREQ with ETX");
+        NS_TEST_EXPECT_MSG_EQ(r2.GetPathEtx(), 65535, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(r, r2, "Round trip serialization works");
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for the compact RREQ and REV_RREQ encoding
+ */
+struct CompactRequestHeaderTest : public TestCase
+{
+    CompactRequestHeaderTest()
+        : TestCase("AODV compact RREQ and REV_RREQ")
+    {
+    }
+
+    void DoRun() override
+    {
+        TypeHeader t(AODVTYPE_RREQ_COMPACT);
+        Ptr<Packet> p = Create<Packet>();
+        p->AddHeader(t);
+        TypeHeader t2;
+        p->RemoveHeader(t2);
+        NS_TEST_EXPECT_MSG_EQ(t2.IsValid(), true, "Compact RREQ type is known");
+        NS_TEST_EXPECT_MSG_EQ(t2.Get(), AODVTYPE_RREQ_COMPACT, "trivial");
+
+        RreqHeader h(/*flags*/ 0,
+                     /*reserved*/ 0,
+                     /*hopCount*/ 6,
+                     /*requestID*/ 100,
+                     /*dst*/ Ipv4Address("1.2.3.4"),
+                     /*dstSeqNo*/ 0,
+                     /*origin*/ Ipv4Address("4.3.2.1"),
+                     /*originSeqNo*/ 300);
+        h.SetUnknownSeqno(true);
+        h.SetCompact(true);
+        // flags, hop count, 1-byte ID, 4-byte destination, 4-byte origin, 2-byte seqno
+        NS_TEST_EXPECT_MSG_EQ(h.GetSerializedSize(), 13, "Unknown seqno is left out");
+        NS_TEST_EXPECT_MSG_EQ(h.GetCompactSavings(), 10, "trivial");
+        p = Create<Packet>();
+        p->AddHeader(h);
+        RreqHeader h2;
+        h2.SetCompact(true);
+        uint32_t bytes = p->RemoveHeader(h2);
+        NS_TEST_EXPECT_MSG_EQ(bytes, 13, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h, h2, "Round trip serialization works");
+
+        h.SetDstSeqno(0xffffffff);
+        h.SetUnknownSeqno(false);
+        h.SetId(0x10000000);
+        h.SetOriginSeqno(0xffffffff);
+        h.AddDestination(Ipv4Address("1.1.1.1"), 3);
+        h.SetPathEtx(1234);
+        NS_TEST_EXPECT_MSG_EQ(h.GetSerializedSize(),
+                              2 + 5 + 4 + 5 + 4 + 5 + 1 + 9 + 2,
+                              "Largest varints and both extensions");
+        NS_TEST_EXPECT_MSG_EQ(h.GetCompactSavings(), -2, "Large varints cost bytes");
+        p = Create<Packet>();
+        p->AddHeader(h);
+        RreqHeader h3;
+        h3.SetCompact(true);
+        p->RemoveHeader(h3);
+        NS_TEST_EXPECT_MSG_EQ(h, h3, "Round trip serialization works");
+        NS_TEST_EXPECT_MSG_EQ(h3.GetPathEtx(), 1234, "trivial");
+
+        RrevreqHeader r(/*flags*/ 0,
+                        /*reserved*/ 0,
+                        /*hopCount*/ 1,
+                        /*requestID*/ 127,
+                        /*dst*/ Ipv4Address("4.3.2.1"),
+                        /*dstSeqNo*/ 128,
+                        /*origin*/ Ipv4Address("1.2.3.4"),
+                        /*originSeqNo*/ 41);
+        r.SetCompact(true);
+        NS_TEST_EXPECT_MSG_EQ(r.GetSerializedSize(), 2 + 1 + 4 + 2 + 4 + 1, "Varint boundary");
+        p = Create<Packet>();
+        p->AddHeader(r);
+        p->AddHeader(TypeHeader(AODVTYPE_REV_RREQ_COMPACT));
+
+        RequestView view(p);
+        NS_TEST_EXPECT_MSG_EQ(view.IsValid(), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.IsCompact(), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetCompactSavings(), 9, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetId(), 127, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetDst(), Ipv4Address("4.3.2.1"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetDstSeqno(), 128, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetOrigin(), Ipv4Address("1.2.3.4"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.SetDstSeqno(127), false, "Shorter varint is not patched");
+        NS_TEST_EXPECT_MSG_EQ(view.SetDstSeqno(200), true, "Same length is patched");
+        view.SetHopCount(2);
+
+        Ptr<Packet> forwarded = view.CreatePacket();
+        forwarded->RemoveHeader(t2);
+        NS_TEST_EXPECT_MSG_EQ(t2.Get(), AODVTYPE_REV_RREQ_COMPACT, "trivial");
+        RrevreqHeader r2;
+        r2.SetCompact(true);
+        forwarded->RemoveHeader(r2);
+        r.SetDstSeqno(200);
+        r.SetHopCount(2);
+        NS_TEST_EXPECT_MSG_EQ(r, r2, "Patched bytes match the re-serialized header");
+
+        p = Create<Packet>();
+        p->AddHeader(r);
+        p->AddHeader(TypeHeader(AODVTYPE_REV_RREQ_COMPACT));
+        p->RemoveAtEnd(1);
+        NS_TEST_EXPECT_MSG_EQ(RequestView(p).IsValid(), false, "Truncated varint");
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for RequestView
+ */
+struct RequestViewTest : public TestCase
+{
+    RequestViewTest()
+        : TestCase("AODV RREQ view")
+    {
+    }
+
+    void DoRun() override
+    {
+        RreqHeader h(/*flags*/ 0,
+                     /*reserved*/ 0,
+                     /*hopCount*/ 2,
+                     /*requestID*/ 7,
+                     /*dst*/ Ipv4Address("1.2.3.4"),
+                     /*dstSeqNo*/ 40,
+                     /*origin*/ Ipv4Address("4.3.2.1"),
+                     /*originSeqNo*/ 10);
+        h.SetUnknownSeqno(true);
+        h.AddDestination(Ipv4Address("1.1.1.1"), 3);
+        h.SetPathEtx(250);
+        Ptr<Packet> p = Create<Packet>();
+        p->AddHeader(h);
+        p->AddHeader(TypeHeader(AODVTYPE_RREQ));
+
+        RequestView view(p);
+        NS_TEST_EXPECT_MSG_EQ(view.IsValid(), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetType(), AODVTYPE_RREQ, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetSize(), p->GetSize(), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetHopCount(), 2, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetId(), 7, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetDst(), Ipv4Address("1.2.3.4"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetDstSeqno(), 40, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetOrigin(), Ipv4Address("4.3.2.1"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(view.GetPathEtx(), 250, "ETX follows the M extension");
+        RreqHeader decoded;
+        NS_TEST_EXPECT_MSG_EQ(view.Deserialize(decoded), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(decoded, h, "Decoded from the bytes of the view");
+
+        view.SetHopCount(3);
+        view.SetDstSeqno(41);
+        view.SetPathEtx(375);
+        Ptr<Packet> forwarded = view.CreatePacket();
+        TypeHeader t;
+        forwarded->RemoveHeader(t);
+        NS_TEST_EXPECT_MSG_EQ(t.Get(), AODVTYPE_RREQ, "Type header is kept");
+        RreqHeader h2;
+        forwarded->RemoveHeader(h2);
+        h.SetHopCount(3);
+        h.SetDstSeqno(41);
+        h.SetUnknownSeqno(false);
+        h.SetPathEtx(375);
+        NS_TEST_EXPECT_MSG_EQ(h, h2, "Patched bytes match the re-serialized header");
+
+        RrevreqHeader r(/*flags*/ 0,
+                        /*reserved*/ 0,
+                        /*hopCount*/ 1,
+                        /*requestID*/ 3,
+                        /*dst*/ Ipv4Address("4.3.2.1"),
+                        /*dstSeqNo*/ 10,
+                        /*origin*/ Ipv4Address("1.2.3.4"),
+                        /*originSeqNo*/ 41);
+        p = Create<Packet>();
+        p->AddHeader(r);
+        p->AddHeader(TypeHeader(AODVTYPE_REV_RREQ));
+        RequestView revView(p);
+        NS_TEST_EXPECT_MSG_EQ(revView.IsValid(), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(revView.HasPathEtx(), false, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(revView.GetPathEtx(), 0, "No extension");
+        RrevreqHeader revDecoded;
+        NS_TEST_EXPECT_MSG_EQ(revView.Deserialize(revDecoded), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(revDecoded, r, "Decoded from the bytes of the view");
+        NS_TEST_EXPECT_MSG_EQ(revView.Deserialize(decoded), false, "Not a RREQ");
+
+        p->RemoveAtEnd(1);
+        NS_TEST_EXPECT_MSG_EQ(RequestView(p).IsValid(), false, "Truncated message");
+        p = Create<Packet>();
+        p->AddHeader(RrepAckHeader());
+        p->AddHeader(TypeHeader(AODVTYPE_RREP_ACK));
+        NS_TEST_EXPECT_MSG_EQ(RequestView(p).IsValid(), false, "Not a request");
+    }
+};
+
 /**
  * \ingroup aodv-test
  *
@@ -320,6 +656,75 @@ struct RerrHeaderTest : public TestCase
         uint32_t bytes = p->RemoveHeader(h2);
         NS_TEST_EXPECT_MSG_EQ(bytes, h.GetSerializedSize(), "(De)Serialized size match");
         NS_TEST_EXPECT_MSG_EQ(h, h2, "Round trip serialization works");
+
+        for (uint32_t i = 2; i < 255; ++i)
+        {
+            h.AddUnDestination(Ipv4Address(i), i);
+        }
+        NS_TEST_EXPECT_MSG_EQ(h.GetDestCount(), 255, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.AddUnDestination(Ipv4Address("3.3.3.3"), 1), false, "RERR full");
+        NS_TEST_EXPECT_MSG_EQ(h.AddUnDestination(dst, 14), true, "Known destination fits");
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for the piggyback shim header
+ */
+struct PiggybackHeaderTest : public TestCase
+{
+    PiggybackHeaderTest()
+        : TestCase("AODV piggyback shim")
+    {
+    }
+
+    void DoRun() override
+    {
+        PiggybackHeader h;
+        h.SetSender(Ipv4Address("10.1.1.2"));
+        NS_TEST_EXPECT_MSG_EQ(h.HasHello(), false, "Empty shim");
+        NS_TEST_EXPECT_MSG_EQ(h.HasRerr(), false, "Empty shim");
+        NS_TEST_EXPECT_MSG_EQ(h.GetSerializedSize(), 5, "Flags and sender only");
+
+        RrepHeader hello(/*prefixSize=*/0,
+                         /*hopCount=*/0,
+                         /*dst=*/Ipv4Address("10.1.1.2"),
+                         /*dstSeqNo=*/7,
+                         /*origin=*/Ipv4Address("10.1.1.2"),
+                         /*lifetime=*/Seconds(2));
+        h.SetHello(hello);
+        Ptr<Packet> p = Create<Packet>();
+        p->AddHeader(h);
+        PiggybackHeader h2;
+        uint32_t bytes = p->RemoveHeader(h2);
+        NS_TEST_EXPECT_MSG_EQ(bytes, 24, "Shim with hello");
+        NS_TEST_EXPECT_MSG_EQ(h2.HasHello(), true, "Hello survives");
+        NS_TEST_EXPECT_MSG_EQ(h2.HasRerr(), false, "No RERR");
+        NS_TEST_EXPECT_MSG_EQ(h, h2, "Round trip serialization works");
+
+        RerrHeader rerr;
+        rerr.AddUnDestination(Ipv4Address("10.1.1.9"), 3);
+        rerr.AddUnDestination(Ipv4Address("10.1.1.12"), 5);
+        h.SetRerr(rerr);
+        p = Create<Packet>(100);
+        p->AddHeader(h);
+        bytes = p->RemoveHeader(h2);
+        NS_TEST_EXPECT_MSG_EQ(bytes, 24 + 3 + 16, "Shim with hello and RERR");
+        NS_TEST_EXPECT_MSG_EQ(h, h2, "Round trip serialization works");
+        NS_TEST_EXPECT_MSG_EQ(h2.GetSender(), Ipv4Address("10.1.1.2"), "Sender survives");
+        NS_TEST_EXPECT_MSG_EQ(h2.GetRerr().GetDestCount(), 2, "RERR survives");
+        NS_TEST_EXPECT_MSG_EQ(p->GetSize(), 100, "Payload untouched");
+
+        PiggybackHeader h3;
+        h3.SetSender(Ipv4Address("10.1.1.3"));
+        h3.SetRerr(rerr);
+        p = Create<Packet>();
+        p->AddHeader(h3);
+        bytes = p->RemoveHeader(h2);
+        NS_TEST_EXPECT_MSG_EQ(bytes, 5 + 3 + 16, "Shim with RERR only");
+        NS_TEST_EXPECT_MSG_EQ(h2.HasHello(), false, "No hello");
+        NS_TEST_EXPECT_MSG_EQ(h3, h2, "Round trip serialization works");
     }
 };
 
@@ -537,6 +942,9 @@ void
 AodvRqueueTest::CheckTimeout()
 {
     NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 0, "Must be empty now");
+    NS_TEST_EXPECT_MSG_EQ(q.GetDropCount(RequestQueue::DROP_TIMEOUT), 2, "Expired entries");
+    NS_TEST_EXPECT_MSG_EQ(q.GetDropCount(RequestQueue::DROP_NO_ROUTE), 3, "DropPacketWithDst");
+    NS_TEST_EXPECT_MSG_EQ(q.GetDropCount(RequestQueue::DROP_OVERFLOW), 0, "Never full");
 }
 
 /**
@@ -719,6 +1127,333 @@ struct AodvRtableTest : public TestCase
     }
 };
 
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for precursor bitsets
+ */
+struct AodvPrecursorTest : public TestCase
+{
+    AodvPrecursorTest()
+        : TestCase("Precursors")
+    {
+    }
+
+    void DoRun() override
+    {
+        PrecursorSet a;
+        PrecursorSet b;
+        NS_TEST_EXPECT_MSG_EQ(a.IsEmpty(), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(a.Insert(3), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(a.Insert(3), false, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(a.Insert(70), true, "Second word");
+        NS_TEST_EXPECT_MSG_EQ(b.Insert(70), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(b.Insert(130), true, "Third word");
+        PrecursorSet u = a;
+        u.Union(b);
+        NS_TEST_EXPECT_MSG_EQ(u.GetCount(), 3, "Union");
+        PrecursorSet n = a;
+        n.Intersect(b);
+        NS_TEST_EXPECT_MSG_EQ(n.GetCount(), 1, "Intersection");
+        NS_TEST_EXPECT_MSG_EQ(n.Contains(70), true, "Intersection");
+        NS_TEST_EXPECT_MSG_EQ(a.Erase(70), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(a.Erase(130), false, "trivial");
+        std::vector<uint32_t> slots;
+        u.GetSlots(slots);
+        NS_TEST_EXPECT_MSG_EQ(slots.size(), 3, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(slots[2], 130, "Slots in increasing order");
+
+        // Entries built outside the table are renumbered to the table slots on insertion
+        RoutingTable rtable(Seconds(2));
+        Ptr<NetDevice> dev;
+        Ipv4InterfaceAddress iface;
+        RoutingTableEntry rt(/*output device*/ dev,
+                             /*dst*/ Ipv4Address("1.2.3.4"),
+                             /*validSeqNo*/ true,
+                             /*seqNo*/ 10,
+                             /*interface*/ iface,
+                             /*hop*/ 2,
+                             /*next hop*/ Ipv4Address("1.1.1.1"),
+                             /*lifetime*/ Seconds(10));
+        rt.InsertPrecursor(Ipv4Address("10.0.0.1"));
+        rt.InsertPrecursor(Ipv4Address("10.0.0.2"));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddRoute(rt), true, "trivial");
+        RoutingTableEntry rt2(/*output device*/ dev,
+                              /*dst*/ Ipv4Address("4.3.2.1"),
+                              /*validSeqNo*/ true,
+                              /*seqNo*/ 3,
+                              /*interface*/ iface,
+                              /*hop*/ 3,
+                              /*next hop*/ Ipv4Address("1.1.1.1"),
+                              /*lifetime*/ Seconds(10));
+        rt2.InsertPrecursor(Ipv4Address("10.0.0.3"));
+        rt2.InsertPrecursor(Ipv4Address("10.0.0.2"));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddRoute(rt2), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("4.3.2.1"), rt2), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rt2.LookupPrecursor(Ipv4Address("10.0.0.3")), true, "Renumbered");
+        NS_TEST_EXPECT_MSG_EQ(rt2.LookupPrecursor(Ipv4Address("10.0.0.1")), false, "Renumbered");
+        NS_TEST_EXPECT_MSG_EQ(rt2.GetPrecursorSet().GetCount(), 2, "trivial");
+
+        std::map<Ipv4Address, uint32_t> dsts;
+        dsts.insert(std::make_pair(Ipv4Address("1.2.3.4"), 10));
+        dsts.insert(std::make_pair(Ipv4Address("4.3.2.1"), 3));
+        dsts.insert(std::make_pair(Ipv4Address("5.5.5.5"), 1));
+        std::vector<Ipv4Address> precursors;
+        rtable.GetPrecursors(dsts, precursors);
+        NS_TEST_EXPECT_MSG_EQ(precursors.size(), 3, "Union without duplicates");
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Unit test for the AODV routing table route valid notification
+ */
+struct AodvRtableRouteValidTest : public TestCase
+{
+    AodvRtableRouteValidTest()
+        : TestCase("RtableRouteValid"),
+          m_count(0)
+    {
+    }
+
+    /**
+     * Route valid handler
+     * \param dst the destination whose route became valid
+     */
+    void Handler(Ipv4Address dst)
+    {
+        m_count++;
+        m_last = dst;
+    }
+
+    void DoRun() override
+    {
+        RoutingTable rtable(Seconds(2));
+        rtable.SetRouteValidCallback(MakeCallback(&AodvRtableRouteValidTest::Handler, this));
+        Ptr<NetDevice> dev;
+        Ipv4InterfaceAddress iface;
+        RoutingTableEntry rt(/*output device*/ dev,
+                             /*dst*/ Ipv4Address("1.2.3.4"),
+                             /*validSeqNo*/ false,
+                             /*seqNo*/ 0,
+                             /*interface*/ iface,
+                             /*hop*/ 1,
+                             /*next hop*/ Ipv4Address(),
+                             /*lifetime*/ Seconds(10));
+        rt.SetFlag(IN_SEARCH);
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddRoute(rt), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(m_count, 0, "Discovery entry is not a valid route");
+        rt.SetFlag(VALID);
+        rt.SetNextHop(Ipv4Address("1.1.1.1"));
+        NS_TEST_EXPECT_MSG_EQ(rtable.Update(rt), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(m_count, 1, "IN_SEARCH -> VALID notifies");
+        NS_TEST_EXPECT_MSG_EQ(m_last, Ipv4Address("1.2.3.4"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rtable.Update(rt), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(m_count, 1, "Refreshing a valid route does not notify");
+        NS_TEST_EXPECT_MSG_EQ(rtable.SetEntryState(Ipv4Address("1.2.3.4"), INVALID),
+                              true,
+                              "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rtable.SetEntryState(Ipv4Address("1.2.3.4"), VALID),
+                              true,
+                              "trivial");
+        NS_TEST_EXPECT_MSG_EQ(m_count, 2, "INVALID -> VALID notifies");
+        RoutingTableEntry rt2(/*output device*/ dev,
+                              /*dst*/ Ipv4Address("4.3.2.1"),
+                              /*validSeqNo*/ true,
+                              /*seqNo*/ 3,
+                              /*interface*/ iface,
+                              /*hop*/ 1,
+                              /*next hop*/ Ipv4Address("4.3.2.1"),
+                              /*lifetime*/ Seconds(10));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddRoute(rt2), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(m_count, 3, "New valid route notifies");
+        NS_TEST_EXPECT_MSG_EQ(m_last, Ipv4Address("4.3.2.1"), "trivial");
+        Simulator::Destroy();
+    }
+
+    uint32_t m_count;   ///< number of notifications
+    Ipv4Address m_last; ///< last notified destination
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Log-bucketed histogram test
+ */
+struct LogHistogramTest : public TestCase
+{
+    LogHistogramTest()
+        : TestCase("LogHistogram")
+    {
+    }
+
+    void DoRun() override
+    {
+        LogHistogram h;
+        NS_TEST_EXPECT_MSG_EQ(h.GetQuantile(0.5), 0, "Empty histogram");
+        for (uint64_t v = 1; v <= 100; ++v)
+        {
+            h.Add(v);
+        }
+        NS_TEST_EXPECT_MSG_EQ(h.GetCount(), 100, "Count");
+        NS_TEST_EXPECT_MSG_EQ(h.GetMax(), 100, "Max");
+        NS_TEST_EXPECT_MSG_EQ(h.GetQuantile(0), 1, "Small values are exact");
+        NS_TEST_EXPECT_MSG_EQ(h.GetQuantile(0.5), 51, "Median is the bound of [48, 51]");
+        NS_TEST_EXPECT_MSG_EQ(h.GetQuantile(0.99), 100, "Bound is capped at the max");
+
+        LogHistogram large;
+        large.Add(1000000000000);
+        uint64_t q = large.GetQuantile(1);
+        NS_TEST_EXPECT_MSG_EQ(q, 1000000000000, "A single value is its own max");
+        large.Add(2000000000000);
+        q = large.GetQuantile(0.5);
+        NS_TEST_EXPECT_MSG_EQ((q >= 1000000000000 && q < 1125000000000), true, "Relative error");
+
+        h.Merge(large);
+        NS_TEST_EXPECT_MSG_EQ(h.GetCount(), 102, "Merged count");
+        NS_TEST_EXPECT_MSG_EQ(h.GetMax(), 2000000000000, "Merged max");
+        NS_TEST_EXPECT_MSG_EQ(h.GetQuantile(0.5), 51, "Merged median");
+        h.Clear();
+        NS_TEST_EXPECT_MSG_EQ(h.GetCount(), 0, "Cleared");
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Student t quantile test
+ */
+struct StudentT95Test : public TestCase
+{
+    StudentT95Test()
+        : TestCase("StudentT95")
+    {
+    }
+
+    void DoRun() override
+    {
+        NS_TEST_EXPECT_MSG_EQ(std::isinf(StudentT95(0)), true, "No interval without variance");
+        NS_TEST_EXPECT_MSG_EQ_TOL(StudentT95(1), 12.706, 0.0005, "df = 1");
+        NS_TEST_EXPECT_MSG_EQ_TOL(StudentT95(3), 3.182, 0.0005, "df = 3");
+        NS_TEST_EXPECT_MSG_EQ_TOL(StudentT95(4), 2.776, 0.0005, "df = 4");
+        NS_TEST_EXPECT_MSG_EQ_TOL(StudentT95(10), 2.228, 0.0005, "df = 10");
+        NS_TEST_EXPECT_MSG_EQ_TOL(StudentT95(29), 2.045, 0.0005, "df = 29");
+        NS_TEST_EXPECT_MSG_EQ_TOL(StudentT95(30), 2.042, 0.0005, "df = 30");
+        // Above the table the value may only err on the wide side: t(0.975, 31) = 2.040
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(StudentT95(31), 2.040, "df = 31");
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(StudentT95(41), 2.020, "df = 41");
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(StudentT95(61), 1.999, "df = 61");
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(StudentT95(121), 1.979, "df = 121");
+        for (uint32_t df = 1; df < 200; ++df)
+        {
+            NS_TEST_EXPECT_MSG_GT_OR_EQ(StudentT95(df),
+                                        StudentT95(df + 1),
+                                        "Non-increasing in df");
+        }
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(StudentT95(100000), 1.960, "Never below the normal");
+    }
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Replay mobility model test
+ */
+struct ReplayMobilityTest : public TestCase
+{
+    ReplayMobilityTest()
+        : TestCase("AodvReplayMobilityModel")
+    {
+    }
+
+    /**
+     * Check the state of the model now
+     * \param position the expected position
+     * \param velocity the expected velocity
+     */
+    void Check(Vector position, Vector velocity)
+    {
+        NS_TEST_EXPECT_MSG_EQ_TOL(CalculateDistance(m_model->GetPosition(), position),
+                                  0,
+                                  1e-9,
+                                  "Position at " << Simulator::Now().As(Time::S));
+        NS_TEST_EXPECT_MSG_EQ_TOL(CalculateDistance(m_model->GetVelocity(), velocity),
+                                  0,
+                                  1e-9,
+                                  "Velocity at " << Simulator::Now().As(Time::S));
+    }
+
+    /**
+     * Check the state of the model at a time
+     * \param seconds the time
+     * \param position the expected position
+     * \param velocity the expected velocity
+     */
+    void CheckAt(double seconds, Vector position, Vector velocity)
+    {
+        Simulator::Schedule(Seconds(seconds), &ReplayMobilityTest::Check, this, position, velocity);
+    }
+
+    void DoRun() override
+    {
+        m_model = CreateObject<AodvReplayMobilityModel>();
+        m_model->AddSegment({Seconds(1), Vector(0, 0, 0), Vector(1, 0, 0)});
+        m_model->AddSegment({Seconds(11), Vector(10, 0, 0), Vector(0, 2, 0)});
+        m_model->AddSegment({Seconds(16), Vector(10, 10, 0), Vector()});
+        CheckAt(0, Vector(), Vector());
+        CheckAt(6, Vector(5, 0, 0), Vector(1, 0, 0));
+        CheckAt(11, Vector(10, 0, 0), Vector(0, 2, 0));
+        CheckAt(13, Vector(10, 4, 0), Vector(0, 2, 0));
+        CheckAt(30, Vector(10, 10, 0), Vector());
+        Simulator::Run();
+        Simulator::Destroy();
+        m_model = nullptr;
+    }
+
+    Ptr<AodvReplayMobilityModel> m_model; ///< the model
+};
+
+/**
+ * \ingroup aodv-test
+ *
+ * \brief Adaptive hello interval controller test
+ */
+struct HelloIntervalControllerTest : public TestCase
+{
+    HelloIntervalControllerTest()
+        : TestCase("AdaptiveHello interval controller")
+    {
+    }
+
+    /**
+     * \param interval the current interval, in seconds
+     * \param churn the neighbor churn
+     * \param neighbors the number of neighbors
+     * \returns the next interval, in seconds, within [0.5, 5]
+     */
+    double Next(double interval, uint32_t churn, uint32_t neighbors)
+    {
+        return RoutingProtocol::NextHelloInterval(Seconds(interval),
+                                                  churn,
+                                                  neighbors,
+                                                  MilliSeconds(500),
+                                                  Seconds(5))
+            .GetSeconds();
+    }
+
+    void DoRun() override
+    {
+        NS_TEST_EXPECT_MSG_EQ_TOL(Next(1, 0, 4), 1.25, 1e-9, "Quiet neighborhood stretches");
+        NS_TEST_EXPECT_MSG_EQ_TOL(Next(4.5, 0, 4), 5, 1e-9, "Capped at MaxHelloInterval");
+        NS_TEST_EXPECT_MSG_EQ_TOL(Next(2, 1, 4), 2, 1e-9, "Moderate churn keeps the interval");
+        NS_TEST_EXPECT_MSG_EQ_TOL(Next(2, 2, 4), 1, 1e-9, "Half the neighborhood changed");
+        NS_TEST_EXPECT_MSG_EQ_TOL(Next(0.8, 3, 2), 0.5, 1e-9, "Floored at MinHelloInterval");
+        NS_TEST_EXPECT_MSG_EQ_TOL(Next(2, 1, 0), 1, 1e-9, "First neighbor in an empty list");
+    }
+};
+
 /**
  * \ingroup aodv-test
  *
@@ -731,15 +1466,26 @@ class AodvTestSuite : public TestSuite
         : TestSuite("routing-aodv", Type::UNIT)
     {
         AddTestCase(new NeighborTest, TestCase::Duration::QUICK);
+        AddTestCase(new HelloIntervalControllerTest, TestCase::Duration::QUICK);
         AddTestCase(new TypeHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new RreqHeaderTest, TestCase::Duration::QUICK);
+        AddTestCase(new RreqMultiDestinationHeaderTest, TestCase::Duration::QUICK);
+        AddTestCase(new PathEtxHeaderTest, TestCase::Duration::QUICK);
+        AddTestCase(new RequestViewTest, TestCase::Duration::QUICK);
+        AddTestCase(new CompactRequestHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new RrepHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new RrepAckHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new RerrHeaderTest, TestCase::Duration::QUICK);
+        AddTestCase(new PiggybackHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new QueueEntryTest, TestCase::Duration::QUICK);
         AddTestCase(new AodvRqueueTest, TestCase::Duration::QUICK);
         AddTestCase(new AodvRtableEntryTest, TestCase::Duration::QUICK);
         AddTestCase(new AodvRtableTest, TestCase::Duration::QUICK);
+        AddTestCase(new AodvPrecursorTest, TestCase::Duration::QUICK);
+        AddTestCase(new AodvRtableRouteValidTest, TestCase::Duration::QUICK);
+        AddTestCase(new LogHistogramTest, TestCase::Duration::QUICK);
+        AddTestCase(new StudentT95Test, TestCase::Duration::QUICK);
+        AddTestCase(new ReplayMobilityTest, TestCase::Duration::QUICK);
     }
 } g_aodvTestSuite; ///< the test suite
 
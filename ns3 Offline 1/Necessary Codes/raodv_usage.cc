@@ -8,25 +8,100 @@
 #include "ns3/mobility-module.h"
 #include "ns3/network-module.h"
 #include "ns3/olsr-module.h"
+#include "ns3/wifi-mode.h"
 #include "ns3/yans-wifi-helper.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <dlfcn.h>
+#include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <poll.h>
+#include <set>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
 
 using namespace ns3;
 using namespace dsr;
 
 NS_LOG_COMPONENT_DEFINE("manet-routing-compare");
 
+// Output of a run beyond its result row; every tier adds to the previous one
+enum TraceLevel
+{
+    TRACE_NONE,     // result row only, no packet metadata printing
+    TRACE_SUMMARY,  // per-node and per-flow summary CSVs
+    TRACE_MOBILITY, // binary course change trace (see mobility_report)
+    TRACE_FULL,     // packet printing, ASCII mobility and Wifi traces, pcap, FlowMonitor XML
+};
+
+// A point of a sweep: one scenario and run number
+struct SweepPoint
+{
+    std::string protocol;
+    int nodes;
+    int rate;
+    int speed;
+    uint32_t run;
+};
+
+// One sample of the time series; the fields are the columns of the series file, in order
+struct SeriesSample
+{
+    double time;             // s
+    double throughput;       // kbit/s received over the last interval
+    double deliveryRatio;    // % of the packets sent so far that were received
+    double controlFrameRate; // AODV control frames per second over the last interval, NaN if
+                             // no node runs AODV
+    double controlByteRate;  // AODV control bytes per second over the last interval, NaN too
+    double meanRouteTable;   // mean routing table entries per AODV node, NaN too
+    double maxRouteTable;    // largest routing table, NaN too
+};
+
 class RoutingExperiment
 {
   public:
     RoutingExperiment();
     void Run();
+    int Sweep();
+    int Replicate();
+    std::vector<SweepPoint> SweepPoints(bool runs) const;
+    std::string RunPoint(const SweepPoint& point) const;
+    uint32_t GetJobs() const;
     void CommandSetup(int argc, char** argv);
+    static std::string ScenarioHeader();
+    std::string ScenarioColumns() const;
+    static std::string ResultHeader();
     Ptr<Socket> SetupPacketReceive(Ipv4Address addr, Ptr<Node> node);
     void ReceivePacket(Ptr<Socket> socket);
     void CheckThroughput();
+    void ReportCompactSavings(NodeContainer nodes, std::string phyMode);
+    std::string CompanionFileName(std::string suffix) const;
+    std::string CacheKey() const;
+    std::string CacheFileName(const std::string& key) const;
+    bool HasUncachedOutputs() const;
+    bool LoadCached(const std::string& key, std::string& rows);
+    void StoreCached(const std::string& key, const std::string& rows) const;
+    void EmitRows(const std::string& rows);
+    void WriteCompanion(const std::string& suffix,
+                        const std::string& header,
+                        const std::string& rows);
+    void WriteCounters(NodeContainer nodes);
+    void WriteOverhead(const AodvOverheadMonitor& monitor);
+    void WriteFlows();
+    void WriteSeries() const;
     // //void CalculateMetrics(FlowMonitorHelper& flowmonHelper,
     //                       Ptr<FlowMonitor> flowMonitor,
     //                       double Totaltime);
@@ -41,10 +116,65 @@ class RoutingExperiment
     int m_packetsPerSecond{4};
     int nodeSpeed{20};
     int nodePause{0};
-    std::string m_protocolName{"AODV"};
+    std::string m_protocolName{"RAODV"};
     double m_txp{7.5};
     bool m_traceMobility{false};
-    bool m_flowMonitor{true};
+    std::string m_traceLevelName{"summary"};
+    TraceLevel m_traceLevel{TRACE_SUMMARY};
+    // FlowMonitor probes every IP node and is only needed for its XML; the collector below measures
+    // the flows from the sources and sinks alone
+    bool m_flowMonitor{false};
+    AodvFlowCollector m_flowStats;
+    bool m_etx{false};
+    bool m_compact{false};
+    std::string m_loadTrace;
+    double m_loadInterval{1.0};
+    // Time series sampled by CheckThroughput into a ring buffer preallocated for the whole run and
+    // written to m_seriesFile once at the end
+    std::string m_seriesFile;
+    double m_seriesInterval{1.0};
+    std::vector<SeriesSample> m_series;
+    uint64_t m_seriesCount{0};
+    NodeContainer m_seriesNodes;
+    const AodvOverheadMonitor* m_seriesOverhead{nullptr};
+    uint64_t m_lastControlFrames{0};
+    uint64_t m_lastControlBytes{0};
+    uint32_t m_run{1};
+
+    // Sweep over comma separated lists of values; an empty list means the single value above
+    bool m_sweep{false};
+    std::string m_sweepFile{"sweep.csv"};
+    std::string m_nodeList;
+    std::string m_rateList;
+    std::string m_speedList;
+    std::string m_protocolList;
+    std::string m_runList;
+    uint32_t m_jobs{0};
+    // Replicate every point until the 95% CI half-width of each metric is within this fraction of
+    // its mean; 0 runs every point once per run number instead
+    double m_ciTarget{0};
+    uint32_t m_minRuns{3};
+    uint32_t m_maxRuns{30};
+    // Packets per second to fork the traffic phase into after a shared warm-up
+    std::string m_forkRates;
+    // Start nodes in the steady state of the random waypoint model instead of warming up for 100 s
+    bool m_warmStart{false};
+    // Binary trajectory files (see AodvMobilityRecorder) to record to and to replay instead of
+    // generating random waypoint movement
+    std::string m_mobilityRecord;
+    std::string m_mobilityReplay;
+    // Directory of cached result rows; empty disables the cache
+    std::string m_cacheDir;
+    // Sorted command line options the cache key has no field for, such as --RngSeed and
+    // --ns3::... attribute defaults, so that any of them changing invalidates the cached rows
+    std::string m_cacheOptions;
+    // Header and rows this run appended to each companion file, by suffix, cached with the result
+    // rows so that a reused run writes them again
+    std::map<std::string, std::pair<std::string, std::string>> m_companions;
+    // A sweep worker returns its result row in m_result instead of appending it to the CSV file,
+    // and skips the output files that concurrent workers would clobber
+    bool m_sweepWorker{false};
+    std::string m_result;
 };
 
 RoutingExperiment::RoutingExperiment()
@@ -79,6 +209,7 @@ RoutingExperiment::ReceivePacket(Ptr<Socket> socket)
     {
         bytesTotal += packet->GetSize();
         packetsReceived += 1;
+        m_flowStats.Receive(packet);
         // NS_LOG_UNCOND(PrintReceivedPacket(socket, packet, senderAddress));
     }
 }
@@ -86,16 +217,95 @@ RoutingExperiment::ReceivePacket(Ptr<Socket> socket)
 void
 RoutingExperiment::CheckThroughput()
 {
-    double kbs = (bytesTotal * 8.0) / 1000;
-    bytesTotal = 0;
+    // The oldest sample is overwritten if the run outlasts the buffer
+    SeriesSample& sample = m_series[m_seriesCount++ % m_series.size()];
+    sample.time = Simulator::Now().GetSeconds();
+    sample.throughput = (bytesTotal * 8.0) / 1000 / m_seriesInterval;
+    uint64_t sent = m_flowStats.GetTxPackets();
+    sample.deliveryRatio = sent ? m_flowStats.GetRxPackets() * 100.0 / sent : 0;
+    uint64_t frames = m_seriesOverhead->GetControlFrames();
+    uint64_t bytes = m_seriesOverhead->GetControlBytes();
+    sample.controlFrameRate = (frames - m_lastControlFrames) / m_seriesInterval;
+    sample.controlByteRate = (bytes - m_lastControlBytes) / m_seriesInterval;
+    m_lastControlFrames = frames;
+    m_lastControlBytes = bytes;
+    uint32_t tables = 0;
+    uint64_t entries = 0;
+    uint32_t largest = 0;
+    for (auto i = m_seriesNodes.Begin(); i != m_seriesNodes.End(); ++i)
+    {
+        Ptr<aodv::RoutingProtocol> routing = AodvHelper::GetAodv(*i);
+        if (routing)
+        {
+            tables++;
+            entries += routing->GetRouteTableSize();
+            largest = std::max(largest, routing->GetRouteTableSize());
+        }
+    }
+    sample.meanRouteTable = tables ? (double)entries / tables : 0;
+    sample.maxRouteTable = largest;
+    if (tables == 0)
+    {
+        // Not AODV: the overhead monitor and the routing tables have nothing to report
+        double na = std::numeric_limits<double>::quiet_NaN();
+        sample.controlFrameRate = na;
+        sample.controlByteRate = na;
+        sample.meanRouteTable = na;
+        sample.maxRouteTable = na;
+    }
 
-    // Write throughput data to CSV
-    // std::ofstream out(m_CSVfileName, std::ios::app);
-    // out << (Simulator::Now()).GetSeconds() << "," << kbs << "," << packetsReceived << ","
-    //     << m_nSinks << "," << m_protocolName << "," << m_txp << std::endl;
-    // out.close();
+    bytesTotal = 0;
     packetsReceived = 0;
-    Simulator::Schedule(Seconds(1.0), &RoutingExperiment::CheckThroughput, this);
+    Simulator::Schedule(Seconds(m_seriesInterval), &RoutingExperiment::CheckThroughput, this);
+}
+
+// The file starts with the magic "ATSC", then the format version, the number of columns and the
+// number of rows as 32-bit integers, then every column name as a length byte and the name, then
+// the columns one after another, each as its rows in time order. Values are IEEE 754 doubles; all
+// numbers are little-endian. series_report.cc turns the file into a CSV.
+void
+RoutingExperiment::WriteSeries() const
+{
+    static const std::pair<const char*, double SeriesSample::*> columns[] = {
+        {"Time", &SeriesSample::time},
+        {"Throughput", &SeriesSample::throughput},
+        {"DeliveryRatio", &SeriesSample::deliveryRatio},
+        {"ControlFrameRate", &SeriesSample::controlFrameRate},
+        {"ControlByteRate", &SeriesSample::controlByteRate},
+        {"MeanRouteTable", &SeriesSample::meanRouteTable},
+        {"MaxRouteTable", &SeriesSample::maxRouteTable},
+    };
+    auto writeU32 = [](std::ostream& os, uint32_t value) {
+        for (int i = 0; i < 4; ++i)
+        {
+            os.put(static_cast<char>(value >> (8 * i)));
+        }
+    };
+
+    uint64_t rows = std::min<uint64_t>(m_seriesCount, m_series.size());
+    uint64_t first = m_seriesCount - rows;
+    std::ofstream out(m_seriesFile, std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_UNLESS(out.good(), "Cannot open " << m_seriesFile);
+    out.write("ATSC", 4);
+    writeU32(out, 1);
+    writeU32(out, std::size(columns));
+    writeU32(out, rows);
+    for (const auto& [name, column] : columns)
+    {
+        out.put(static_cast<char>(std::strlen(name)));
+        out.write(name, std::strlen(name));
+    }
+    for (const auto& [name, column] : columns)
+    {
+        for (uint64_t row = first; row < m_seriesCount; ++row)
+        {
+            uint64_t bits;
+            double value = m_series[row % m_series.size()].*column;
+            std::memcpy(&bits, &value, sizeof(bits));
+            writeU32(out, bits);
+            writeU32(out, bits >> 32);
+        }
+    }
 }
 
 Ptr<Socket>
@@ -109,6 +319,92 @@ RoutingExperiment::SetupPacketReceive(Ipv4Address addr, Ptr<Node> node)
     return sink;
 }
 
+void
+RoutingExperiment::ReportCompactSavings(NodeContainer nodes, std::string phyMode)
+{
+    uint32_t discoveries = 0;
+    int64_t bytesSaved = 0;
+    for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+    {
+        Ptr<Ipv4ListRouting> list =
+            DynamicCast<Ipv4ListRouting>((*i)->GetObject<Ipv4>()->GetRoutingProtocol());
+        for (uint32_t k = 0; list && k < list->GetNRoutingProtocols(); ++k)
+        {
+            int16_t priority;
+            Ptr<aodv::RoutingProtocol> routing =
+                DynamicCast<aodv::RoutingProtocol>(list->GetRoutingProtocol(k, priority));
+            if (routing)
+            {
+                discoveries += routing->GetRouteDiscoveries();
+                bytesSaved += routing->GetCompactBytesSaved();
+            }
+        }
+    }
+    if (discoveries == 0)
+    {
+        return;
+    }
+    // Requests are broadcast, i.e. sent at the non-unicast rate which this scenario sets to phyMode
+    double bitRate = WifiMode(phyMode).GetDataRate(22);
+    double bytesPerDiscovery = (double)bytesSaved / discoveries;
+    std::cout << "Compact requests: " << discoveries << " discoveries, " << bytesPerDiscovery
+              << " bytes and " << bytesPerDiscovery * 8 * 1e6 / bitRate
+              << " us of airtime saved per discovery" << std::endl;
+}
+
+// Per-node rows would break the one-row-per-run layout of the results CSV, so they go to
+// companion files keyed by the same scenario columns
+std::string
+RoutingExperiment::CompanionFileName(std::string suffix) const
+{
+    std::string fileName = m_CSVfileName;
+    std::string::size_type dot = fileName.rfind(".csv");
+    if (dot != std::string::npos && dot + 4 == fileName.size())
+    {
+        fileName.erase(dot);
+    }
+    return fileName + "-" + suffix + ".csv";
+}
+
+void
+RoutingExperiment::WriteCompanion(const std::string& suffix,
+                                  const std::string& header,
+                                  const std::string& rows)
+{
+    std::string fileName = CompanionFileName(suffix);
+    bool exists = std::ifstream(fileName).good();
+    std::ofstream out(fileName, std::ios::app);
+    if (!exists)
+    {
+        out << ScenarioHeader() << "," << header << std::endl;
+    }
+    out << rows;
+    m_companions[suffix] = {header, rows};
+}
+
+void
+RoutingExperiment::WriteCounters(NodeContainer nodes)
+{
+    std::ostringstream rows;
+    AodvHelper::WriteCounters(nodes, rows, ScenarioColumns());
+    WriteCompanion("counters", AodvHelper::GetCounterHeader(), rows.str());
+}
+
+void
+RoutingExperiment::WriteOverhead(const AodvOverheadMonitor& monitor)
+{
+    std::ostringstream rows;
+    monitor.WriteNodes(rows, ScenarioColumns());
+    WriteCompanion("overhead", AodvOverheadMonitor::GetNodeHeader(), rows.str());
+}
+
+void
+RoutingExperiment::WriteFlows()
+{
+    std::ostringstream rows;
+    m_flowStats.WriteFlows(rows, ScenarioColumns());
+    WriteCompanion("flows", AodvFlowCollector::GetFlowHeader(), rows.str());
+}
 
 void
 RoutingExperiment::CommandSetup(int argc, char** argv)
@@ -117,7 +413,90 @@ RoutingExperiment::CommandSetup(int argc, char** argv)
     cmd.AddValue("numberOfNodes", "Number of nodes", m_numberOfNodes);
     cmd.AddValue("packetsPerSecond", "Number of packets generated per second", m_packetsPerSecond);
     cmd.AddValue("nodeSpeed", "Speed of nodes in m/s", nodeSpeed);
+    cmd.AddValue("etx", "Select AODV routes by ETX instead of hop count", m_etx);
+    cmd.AddValue("compact", "Send AODV route requests in the compact encoding", m_compact);
+    cmd.AddValue("CSVfileName", "The name of the CSV output file", m_CSVfileName);
+    cmd.AddValue("flowMonitor",
+                 "Also install FlowMonitor, print its aggregate metrics and write its XML",
+                 m_flowMonitor);
+    cmd.AddValue("loadTrace",
+                 "Write per-node forwarding load snapshots to this binary file (see load_report)",
+                 m_loadTrace);
+    cmd.AddValue("loadInterval", "Interval between load snapshots in seconds", m_loadInterval);
+    cmd.AddValue("seriesFile",
+                 "Write a time series of throughput, PDR, control overhead and routing table sizes "
+                 "to this binary file (see series_report)",
+                 m_seriesFile);
+    cmd.AddValue("seriesInterval",
+                 "Interval between time series samples in seconds",
+                 m_seriesInterval);
+    cmd.AddValue("protocol", "Routing protocol: AODV, RAODV, OLSR, DSDV or DSR", m_protocolName);
+    cmd.AddValue("run", "Run number of the random number generator", m_run);
+    cmd.AddValue("sweep", "Run every combination of the list options in parallel", m_sweep);
+    cmd.AddValue("sweepFile", "The name of the CSV file a sweep writes", m_sweepFile);
+    cmd.AddValue("nodeList", "Comma separated numbers of nodes to sweep", m_nodeList);
+    cmd.AddValue("rateList", "Comma separated packets per second to sweep", m_rateList);
+    cmd.AddValue("speedList", "Comma separated node speeds to sweep", m_speedList);
+    cmd.AddValue("protocolList", "Comma separated routing protocols to sweep", m_protocolList);
+    cmd.AddValue("runList", "Comma separated run numbers to sweep", m_runList);
+    cmd.AddValue("jobs", "Number of parallel sweep workers, 0 for one per core", m_jobs);
+    cmd.AddValue("ciTarget",
+                 "Replicate sweep points until the 95% CI half-width is within this fraction "
+                 "of the mean, 0 to disable",
+                 m_ciTarget);
+    cmd.AddValue("minRuns", "Replications of every point before the CI is checked", m_minRuns);
+    cmd.AddValue("maxRuns", "Most replications of a point", m_maxRuns);
+    cmd.AddValue("warmStart",
+                 "Start mobility in its steady state and traffic after 1 s instead of 100 s",
+                 m_warmStart);
+    cmd.AddValue("cacheDir",
+                 "Reuse the result rows of runs already done by this build from this directory",
+                 m_cacheDir);
+    cmd.AddValue("mobilityRecord",
+                 "Record the node trajectories to this binary file for --mobilityReplay",
+                 m_mobilityRecord);
+    cmd.AddValue("mobilityReplay",
+                 "Move the nodes along the trajectories recorded in this file",
+                 m_mobilityReplay);
+    cmd.AddValue("forkRates",
+                 "Comma separated packets per second to run after a single shared warm-up",
+                 m_forkRates);
+    cmd.AddValue("traceLevel",
+                 "Output beyond the result row: none, summary, mobility or full",
+                 m_traceLevelName);
     cmd.Parse(argc, argv);
+
+    // Options already in the cache key, options a sweep worker overrides, and options that only
+    // name outputs or schedule the work; every other option may change the result rows
+    static const std::set<std::string> keyed = {
+        "numberOfNodes", "packetsPerSecond", "nodeSpeed", "protocol", "run", "etx", "compact",
+        "warmStart", "forkRates", "mobilityReplay", "CSVfileName", "loadTrace", "loadInterval",
+        "seriesFile", "seriesInterval", "sweep", "sweepFile", "nodeList", "rateList", "speedList",
+        "protocolList", "runList", "jobs", "ciTarget", "minRuns", "maxRuns", "cacheDir",
+        "mobilityRecord", "traceLevel"};
+    std::vector<std::string> options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string option = argv[i];
+        size_t start = std::min(option.find_first_not_of('-'), option.size());
+        if (keyed.count(option.substr(start, option.find('=') - start)) == 0)
+        {
+            options.push_back(option);
+        }
+    }
+    std::sort(options.begin(), options.end());
+    for (const auto& option : options)
+    {
+        m_cacheOptions += (m_cacheOptions.empty() ? "" : " ") + option;
+    }
+
+    static const std::map<std::string, TraceLevel> levels = {{"none", TRACE_NONE},
+                                                             {"summary", TRACE_SUMMARY},
+                                                             {"mobility", TRACE_MOBILITY},
+                                                             {"full", TRACE_FULL}};
+    auto level = levels.find(m_traceLevelName);
+    NS_ABORT_MSG_IF(level == levels.end(), "Unknown trace level " << m_traceLevelName);
+    m_traceLevel = level->second;
 }
 
 int
@@ -125,26 +504,667 @@ main(int argc, char* argv[])
 {
     RoutingExperiment experiment;
     experiment.CommandSetup(argc, argv);
+    if (!experiment.m_cacheDir.empty())
+    {
+        std::filesystem::create_directories(experiment.m_cacheDir);
+    }
+    if (experiment.m_sweep)
+    {
+        return experiment.Sweep();
+    }
     experiment.Run();
 
     return 0;
 }
 
+// The columns every result and companion row starts with, so that rows of sweeps and
+// replications stay apart when files are concatenated
+std::string
+RoutingExperiment::ScenarioHeader()
+{
+    return "Protocol,Run,NumOfNodes,PacketsPerSec,NodeSpeed";
+}
+
+std::string
+RoutingExperiment::ScenarioColumns() const
+{
+    std::ostringstream columns;
+    columns << m_protocolName << "," << m_run << "," << m_numberOfNodes << ","
+            << m_packetsPerSecond << "," << nodeSpeed << ",";
+    return columns.str();
+}
+
+std::string
+RoutingExperiment::ResultHeader()
+{
+    return ScenarioHeader() +
+           ",Throughput,EndToEndDelay,PacketDeliveryRatio,PacketDropRatio," +
+           AodvHelper::GetPercentileHeader() +
+           ",ControlFrames,ControlBytes,NormalizedRoutingLoad,MacOverhead,DelayP50,DelayP95,"
+           "DelayP99,Jitter,WallClock,PeakRss,Events,EventsPerSecond";
+}
+
+static std::vector<std::string>
+SplitList(const std::string& list, const std::string& single)
+{
+    std::vector<std::string> values;
+    std::istringstream is(list.empty() ? single : list);
+    std::string value;
+    while (std::getline(is, value, ','))
+    {
+        if (!value.empty())
+        {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+// Install the internet stack with a single IPv4 routing protocol
+static void
+InstallRouting(const Ipv4RoutingHelper& routing, NodeContainer nodes)
+{
+    Ipv4ListRoutingHelper list;
+    list.Add(routing, 100);
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(list);
+    internet.Install(nodes);
+}
+
+// The protocols a run can compare, by the name --protocol takes; each entry installs the internet
+// stack and its routing protocol on the nodes. AODV is the aodv module without the reverse request
+// flood that makes it R-AODV
+static const std::map<std::string, std::function<void(NodeContainer)>>&
+Protocols()
+{
+    static const std::map<std::string, std::function<void(NodeContainer)>> protocols = {
+        {"AODV",
+         [](NodeContainer nodes) {
+             AodvHelper aodv;
+             aodv.Set("EnableReverseRequest", BooleanValue(false));
+             InstallRouting(aodv, nodes);
+         }},
+        {"RAODV", [](NodeContainer nodes) { InstallRouting(AodvHelper(), nodes); }},
+        {"OLSR", [](NodeContainer nodes) { InstallRouting(OlsrHelper(), nodes); }},
+        {"DSDV", [](NodeContainer nodes) { InstallRouting(DsdvHelper(), nodes); }},
+        {"DSR",
+         [](NodeContainer nodes) {
+             InternetStackHelper internet;
+             internet.Install(nodes);
+             DsrHelper dsr;
+             DsrMainHelper dsrMain;
+             dsrMain.Install(dsr, nodes);
+         }},
+    };
+    return protocols;
+}
+
+// 64-bit FNV-1a, continued from hash
+static uint64_t
+Fnv1a(const char* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ (unsigned char)data[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static std::string
+Hex(uint64_t value)
+{
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", (unsigned long long)value);
+    return text;
+}
+
+// 64-bit FNV-1a of the contents of a file, continued from hash
+static uint64_t
+HashFile(const std::string& file, uint64_t hash = 0xcbf29ce484222325ULL)
+{
+    std::ifstream in(file, std::ios::binary);
+    NS_ABORT_MSG_UNLESS(in.good(), "Cannot read " << file << " to hash it");
+    char buffer[1 << 16];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
+    {
+        hash = Fnv1a(buffer, in.gcount(), hash);
+    }
+    return hash;
+}
+
+// Hash of the driver executable and of the shared object the AODV model is linked from (the same
+// file in a static build), so that rebuilding either with changes invalidates the cached results
+static std::string
+BuildHash()
+{
+    static std::string hash;
+    if (!hash.empty())
+    {
+        return hash;
+    }
+    uint64_t h = HashFile("/proc/self/exe");
+    Dl_info info;
+    if (dladdr((void*)&aodv::RoutingProtocol::GetTypeId, &info) && info.dli_fname)
+    {
+        h = HashFile(info.dli_fname, h);
+    }
+    hash = Hex(h);
+    return hash;
+}
+
+// Runs work(i) for every i in [0, count) in a forked child process, at most jobs at a time, and
+// returns the text each child produced, or an empty string for a child that failed. Forking is how
+// several simulations run at once: the Simulator is a singleton.
+static std::vector<std::string>
+ForkEach(size_t count, uint32_t jobs, std::function<std::string(size_t)> work)
+{
+    std::vector<std::string> results(count);
+    std::map<pid_t, std::pair<size_t, int>> running; // pid -> (index, read end of the pipe)
+    size_t next = 0;
+    while (next < count || !running.empty())
+    {
+        while (next < count && running.size() < jobs)
+        {
+            int fds[2];
+            NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe failed");
+            std::cout.flush();
+            pid_t pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "fork failed");
+            if (pid == 0)
+            {
+                close(fds[0]);
+                std::string result = work(next);
+                size_t written = 0;
+                while (written < result.size())
+                {
+                    ssize_t n = write(fds[1], result.data() + written, result.size() - written);
+                    if (n < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (n <= 0)
+                    {
+                        break;
+                    }
+                    written += n;
+                }
+                bool ok = !result.empty() && written == result.size();
+                std::cout.flush();
+                _exit(ok ? 0 : 1);
+            }
+            close(fds[1]);
+            running[pid] = {next++, fds[0]};
+        }
+
+        // The pipes are drained as they fill: a child whose output exceeds the pipe buffer blocks
+        // in write until it is read, so waiting for it to exit first would deadlock. A child is
+        // reaped once its pipe reaches end of file.
+        std::vector<pollfd> polled;
+        for (auto i = running.begin(); i != running.end(); ++i)
+        {
+            polled.push_back({i->second.second, POLLIN, 0});
+        }
+        if (poll(polled.data(), polled.size(), -1) < 0)
+        {
+            NS_ABORT_MSG_IF(errno != EINTR, "poll failed");
+            continue;
+        }
+        size_t k = 0;
+        for (auto child = running.begin(); child != running.end(); ++k)
+        {
+            auto [index, fd] = child->second;
+            if (polled[k].revents == 0)
+            {
+                ++child;
+                continue;
+            }
+            char buffer[4096];
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n > 0 || (n < 0 && errno == EINTR))
+            {
+                results[index].append(buffer, std::max<ssize_t>(n, 0));
+                ++child;
+                continue;
+            }
+            close(fd);
+            int status;
+            pid_t pid;
+            while ((pid = waitpid(child->first, &status, 0)) < 0 && errno == EINTR)
+            {
+            }
+            if (n < 0 || pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                results[index].clear();
+            }
+            child = running.erase(child);
+        }
+    }
+    return results;
+}
+
+uint32_t
+RoutingExperiment::GetJobs() const
+{
+    return m_jobs ? m_jobs : std::max<long>(1, sysconf(_SC_NPROCESSORS_ONLN));
+}
+
+std::vector<SweepPoint>
+RoutingExperiment::SweepPoints(bool runs) const
+{
+    // With --forkRates a worker runs all rates of its point after a single warm-up
+    std::string rates = m_forkRates.empty() ? m_rateList : std::to_string(m_packetsPerSecond);
+    std::string runList = runs ? m_runList : std::to_string(m_run);
+    std::vector<SweepPoint> points;
+    std::set<std::string> seen;
+    for (const auto& protocol : SplitList(m_protocolList, m_protocolName))
+    {
+        // Fail before any worker is forked rather than in every worker
+        NS_ABORT_MSG_IF(!Protocols().count(protocol), "No such protocol: " << protocol);
+        for (const auto& nodes : SplitList(m_nodeList, std::to_string(m_numberOfNodes)))
+        {
+            for (const auto& rate : SplitList(rates, std::to_string(m_packetsPerSecond)))
+            {
+                for (const auto& speed : SplitList(m_speedList, std::to_string(nodeSpeed)))
+                {
+                    for (const auto& run : SplitList(runList, std::to_string(m_run)))
+                    {
+                        SweepPoint point{protocol,
+                                         std::stoi(nodes),
+                                         std::stoi(rate),
+                                         std::stoi(speed),
+                                         (uint32_t)std::stoul(run)};
+                        // A value listed twice would only write the same rows twice
+                        std::string key = point.protocol + "," + std::to_string(point.nodes) +
+                                          "," + std::to_string(point.rate) + "," +
+                                          std::to_string(point.speed) + "," +
+                                          std::to_string(point.run);
+                        if (seen.insert(key).second)
+                        {
+                            points.push_back(point);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return points;
+}
+
+std::string
+RoutingExperiment::RunPoint(const SweepPoint& point) const
+{
+    RoutingExperiment worker = *this;
+    worker.m_protocolName = point.protocol;
+    worker.m_numberOfNodes = point.nodes;
+    worker.m_packetsPerSecond = point.rate;
+    worker.nodeSpeed = point.speed;
+    worker.m_run = point.run;
+    worker.m_sweepWorker = true;
+    // The rate children of a forking worker run one at a time, so at most jobs simulations
+    // run at once
+    worker.m_jobs = 1;
+    worker.Run();
+    return worker.m_result;
+}
+
+// Every sweep point runs in its own worker process, forked before this process touches the
+// Simulator; the rows are written in grid order once all points are done
+int
+RoutingExperiment::Sweep()
+{
+    if (!m_cacheDir.empty())
+    {
+        // Hash the build once here rather than in every worker
+        BuildHash();
+    }
+    if (m_ciTarget > 0)
+    {
+        return Replicate();
+    }
+    std::vector<SweepPoint> points = SweepPoints(true);
+    uint32_t jobs = GetJobs();
+    std::cout << "Sweeping " << points.size() << " points with " << jobs << " workers"
+              << std::endl;
+
+    std::vector<std::string> rows =
+        ForkEach(points.size(), jobs, [&](size_t i) { return RunPoint(points[i]); });
+
+    std::ofstream out(m_sweepFile);
+    out << ResultHeader() << std::endl;
+    uint32_t failures = 0;
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        if (rows[i].empty())
+        {
+            const SweepPoint& point = points[i];
+            std::cerr << "Sweep point " << point.protocol << " nodes=" << point.nodes
+                      << " rate=" << point.rate << " speed=" << point.speed
+                      << " run=" << point.run << " failed" << std::endl;
+            failures++;
+        }
+        out << rows[i];
+    }
+    std::cout << "Sweep completed, " << points.size() - failures << " of " << points.size()
+              << " points written to " << m_sweepFile << std::endl;
+    return failures ? 1 : 0;
+}
+
+// Replicates every sweep point with consecutive run numbers from --run until the 95% confidence
+// interval half-width of each of the four headline metrics is within --ciTarget of its mean, or
+// --maxRuns replications are done. Replications are forked in rounds: the first round runs
+// --minRuns of every point, and every later round runs as many more of each open point as the
+// variance seen so far says it still needs, so stable points stop early and the cores stay busy
+// with the noisy ones. NA columns (the AODV-only metrics of OLSR, DSDV and DSR) are carried as NaN,
+// left out of the intervals and the stop test and written as NA.
+int
+RoutingExperiment::Replicate()
+{
+    NS_ABORT_MSG_IF(!m_forkRates.empty(), "--ciTarget cannot be combined with --forkRates");
+    NS_ABORT_MSG_IF(m_minRuns < 2 || m_maxRuns < m_minRuns,
+                    "--minRuns must be at least 2 and at most --maxRuns");
+    // Throughput, EndToEndDelay, PacketDeliveryRatio and PacketDropRatio follow the scenario
+    // columns of a result row
+    const size_t scenarioColumns = SplitList(ScenarioHeader(), "").size();
+    const size_t stopColumns = 4;
+
+    std::vector<std::string> header = SplitList(ResultHeader(), "");
+    size_t metrics = header.size() - scenarioColumns;
+    std::vector<SweepPoint> points = SweepPoints(false);
+    std::vector<std::vector<std::vector<double>>> samples(points.size()); // point -> run -> metric
+    std::vector<uint32_t> started(points.size(), 0);
+    std::vector<uint32_t> wanted(points.size(), m_minRuns);
+    uint32_t jobs = GetJobs();
+    std::cout << "Replicating " << points.size() << " points to a 95% CI half-width of "
+              << m_ciTarget * 100 << "% with " << jobs << " workers" << std::endl;
+
+    // Sample mean and 95% CI half-width of a metric of a point over the runs that report it; both
+    // are NaN when none does
+    auto interval = [&](size_t i, size_t metric) {
+        std::vector<double> values;
+        for (const auto& run : samples[i])
+        {
+            if (!std::isnan(run[metric]))
+            {
+                values.push_back(run[metric]);
+            }
+        }
+        double n = values.size();
+        if (values.empty())
+        {
+            double na = std::numeric_limits<double>::quiet_NaN();
+            return std::make_pair(na, na);
+        }
+        double mean = 0;
+        for (double value : values)
+        {
+            mean += value / n;
+        }
+        if (values.size() < 2)
+        {
+            return std::make_pair(mean, std::numeric_limits<double>::infinity());
+        }
+        double var = 0;
+        for (double value : values)
+        {
+            var += (value - mean) * (value - mean) / (n - 1);
+        }
+        return std::make_pair(mean, aodv::StudentT95(values.size() - 1) * std::sqrt(var / n));
+    };
+
+    for (uint32_t round = 1;; ++round)
+    {
+        std::vector<std::pair<size_t, uint32_t>> tasks; // (point, run)
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            for (uint32_t k = 0; k < wanted[i]; ++k)
+            {
+                tasks.emplace_back(i, m_run + started[i]++);
+            }
+        }
+        if (tasks.empty())
+        {
+            break;
+        }
+        std::cout << "Round " << round << ": " << tasks.size() << " replications" << std::endl;
+        std::vector<std::string> rows = ForkEach(tasks.size(), jobs, [&](size_t t) {
+            SweepPoint point = points[tasks[t].first];
+            point.run = tasks[t].second;
+            return RunPoint(point);
+        });
+        for (size_t t = 0; t < tasks.size(); ++t)
+        {
+            std::vector<std::string> fields = SplitList(rows[t], "");
+            if (fields.size() != header.size())
+            {
+                const SweepPoint& point = points[tasks[t].first];
+                std::cerr << "Replication " << point.protocol << " nodes=" << point.nodes
+                          << " rate=" << point.rate << " speed=" << point.speed
+                          << " run=" << tasks[t].second << " failed" << std::endl;
+                continue;
+            }
+            std::vector<double> values;
+            for (size_t c = scenarioColumns; c < fields.size(); ++c)
+            {
+                values.push_back(fields[c] == "NA" ? std::numeric_limits<double>::quiet_NaN()
+                                                   : std::stod(fields[c]));
+            }
+            samples[tasks[t].first].push_back(values);
+        }
+
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            uint32_t n = samples[i].size();
+            uint32_t left = m_maxRuns - started[i];
+            if (n < 2)
+            {
+                wanted[i] = std::min(left, 2 - n);
+                continue;
+            }
+            // Runs needed for the widest interval to shrink to the target, assuming the
+            // variance estimate holds; a zero mean never converges on a relative target
+            double needed = n;
+            for (size_t m = 0; m < stopColumns; ++m)
+            {
+                auto [mean, half] = interval(i, m);
+                double target = m_ciTarget * std::abs(mean);
+                if (!std::isnan(mean) && half > target)
+                {
+                    needed = std::max(needed,
+                                      target > 0 ? std::ceil(n * (half / target) * (half / target))
+                                                 : std::numeric_limits<double>::infinity());
+                }
+            }
+            wanted[i] = needed > n ? (uint32_t)std::min<double>(left, needed - n) : 0;
+        }
+    }
+
+    std::ofstream out(m_sweepFile);
+    out << "Protocol,NumOfNodes,PacketsPerSec,NodeSpeed,Replications,Converged";
+    for (size_t m = 0; m < metrics; ++m)
+    {
+        out << "," << header[scenarioColumns + m] << "," << header[scenarioColumns + m] << "CI";
+    }
+    out << std::endl;
+    uint32_t converged = 0;
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        const SweepPoint& point = points[i];
+        bool ok = samples[i].size() >= 2;
+        for (size_t m = 0; ok && m < stopColumns; ++m)
+        {
+            auto [mean, half] = interval(i, m);
+            ok = std::isnan(mean) || half <= m_ciTarget * std::abs(mean);
+        }
+        converged += ok;
+        out << point.protocol << "," << point.nodes << "," << point.rate << "," << point.speed
+            << "," << samples[i].size() << "," << ok;
+        for (size_t m = 0; m < metrics; ++m)
+        {
+            auto [mean, half] = interval(i, m);
+            if (std::isnan(mean))
+            {
+                out << ",NA,NA";
+            }
+            else
+            {
+                out << "," << mean << "," << half;
+            }
+        }
+        out << std::endl;
+    }
+    std::cout << "Replication completed, " << converged << " of " << points.size()
+              << " points converged, written to " << m_sweepFile << std::endl;
+    return 0;
+}
+
+// Every parameter that changes the result rows of a run, and the build that produced them
+std::string
+RoutingExperiment::CacheKey() const
+{
+    std::ostringstream key;
+    key << "protocol=" << m_protocolName << " nodes=" << m_numberOfNodes
+        << " rate=" << m_packetsPerSecond << " speed=" << nodeSpeed << " pause=" << nodePause
+        << " sinks=" << m_nSinks << " txp=" << m_txp << " etx=" << m_etx
+        << " compact=" << m_compact << " warmStart=" << m_warmStart
+        << " forkRates=" << m_forkRates << " run=" << m_run << " build=" << BuildHash()
+        << " replay=" << (m_mobilityReplay.empty() ? "" : Hex(HashFile(m_mobilityReplay)))
+        << " columns=" << ResultHeader() << " options=" << m_cacheOptions;
+    return key.str();
+}
+
+std::string
+RoutingExperiment::CacheFileName(const std::string& key) const
+{
+    return m_cacheDir + "/" + Hex(Fnv1a(key.data(), key.size())) + ".csv";
+}
+
+// Outputs a cache entry cannot reproduce: trajectory, time series and load traces, and the
+// packet level traces of the full trace level. A run that writes any of them is never reused.
+bool
+RoutingExperiment::HasUncachedOutputs() const
+{
+    bool sharedOutput = !m_sweepWorker && m_forkRates.empty();
+    return sharedOutput && (!m_mobilityRecord.empty() || m_traceLevel >= TRACE_MOBILITY ||
+                            !m_seriesFile.empty() || !m_loadTrace.empty());
+}
+
+// A cache file holds its key on the first line, so a hash collision reads as a miss. The result
+// rows follow, then every companion file as a line "@<suffix>", its header and its rows. An entry
+// without the companion files this run would write is a miss as well.
+bool
+RoutingExperiment::LoadCached(const std::string& key, std::string& rows)
+{
+    std::ifstream in(CacheFileName(key));
+    std::string line;
+    if (!std::getline(in, line) || line != key)
+    {
+        return false;
+    }
+    rows.clear();
+    std::map<std::string, std::pair<std::string, std::string>> companions;
+    std::pair<std::string, std::string>* companion = nullptr;
+    while (std::getline(in, line))
+    {
+        if (!line.empty() && line[0] == '@')
+        {
+            companion = &companions[line.substr(1)];
+            std::getline(in, companion->first);
+        }
+        else if (companion)
+        {
+            companion->second += line + "\n";
+        }
+        else
+        {
+            rows += line + "\n";
+        }
+    }
+    bool sharedOutput = !m_sweepWorker && m_forkRates.empty();
+    if (rows.empty() ||
+        (sharedOutput && m_traceLevel >= TRACE_SUMMARY && companions.count("flows") == 0))
+    {
+        return false;
+    }
+    if (sharedOutput && m_traceLevel >= TRACE_SUMMARY)
+    {
+        for (auto i = companions.begin(); i != companions.end(); ++i)
+        {
+            WriteCompanion(i->first, i->second.first, i->second.second);
+        }
+    }
+    return true;
+}
+
+// The file is written under a temporary name and renamed, so concurrent sweep workers and
+// interrupted runs never leave a partial entry behind
+void
+RoutingExperiment::StoreCached(const std::string& key, const std::string& rows) const
+{
+    std::string fileName = CacheFileName(key);
+    std::string temporary = fileName + "." + std::to_string(getpid());
+    std::ofstream out(temporary);
+    out << key << "\n" << rows;
+    for (auto i = m_companions.begin(); i != m_companions.end(); ++i)
+    {
+        out << "@" << i->first << "\n" << i->second.first << "\n" << i->second.second;
+    }
+    out.close();
+    if (!out || std::rename(temporary.c_str(), fileName.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        std::cerr << "Cannot write " << fileName << std::endl;
+    }
+}
+
+void
+RoutingExperiment::EmitRows(const std::string& rows)
+{
+    if (m_sweepWorker)
+    {
+        m_result = rows;
+    }
+    else
+    {
+        std::ofstream(m_CSVfileName, std::ios::app) << rows;
+    }
+}
+
 void
 RoutingExperiment::Run()
 {
-    Packet::EnablePrinting();
-    if (!std::ifstream(m_CSVfileName).good())
+    if (m_traceLevel >= TRACE_FULL)
+    {
+        Packet::EnablePrinting();
+    }
+    RngSeedManager::SetRun(m_run);
+    if (!m_sweepWorker && !std::ifstream(m_CSVfileName).good())
     {
         std::ofstream out(m_CSVfileName);
-        out << "NumOfNodes,PacketsPerSec,NodeSpeed,Throughput,EndToEndDelay,PacketDeliveryRatio,"
-               "PacketDropRatio"
-            << std::endl;
+        out << ResultHeader() << std::endl;
         out.close();
     }
+    std::string cacheKey;
+    bool useCache = !m_cacheDir.empty() && !HasUncachedOutputs();
+    if (useCache)
+    {
+        cacheKey = CacheKey();
+        std::string rows;
+        if (LoadCached(cacheKey, rows))
+        {
+            EmitRows(rows);
+            std::cout << "Reused cached result " << CacheFileName(cacheKey) << std::endl;
+            return;
+        }
+    }
+
+    // Cost of the run as the harness sees it: wall-clock time from here, peak resident set size
+    // of the process and simulator events executed
+    auto wallStart = std::chrono::steady_clock::now();
 
-    double TotalTime = 200.0;
-    double startTime = 100.0;
+    // Traffic runs for 100 s, after a warm-up that lets random waypoint mobility settle unless the
+    // nodes start in its steady state
+    double startTime = m_warmStart ? 1.0 : 100.0;
+    double TotalTime = startTime + 100.0;
     int rateVal = 64 * 8 * m_packetsPerSecond;
     std::string rate(std::to_string(rateVal) + "bps");
     std::string phyMode("DsssRate11Mbps");
@@ -154,6 +1174,14 @@ RoutingExperiment::Run()
     Config::SetDefault("ns3::OnOffApplication::DataRate", StringValue(rate));
 
     Config::SetDefault("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue(phyMode));
+    Config::SetDefault("ns3::aodv::RoutingProtocol::EnableEtx", BooleanValue(m_etx));
+    if (m_etx)
+    {
+        // Link delivery ratios are measured from hellos
+        Config::SetDefault("ns3::aodv::RoutingProtocol::EnableHello", BooleanValue(true));
+    }
+    Config::SetDefault("ns3::aodv::RoutingProtocol::CompactControlMessages",
+                       BooleanValue(m_compact));
 
     NodeContainer adhocNodes;
     adhocNodes.Create(m_numberOfNodes);
@@ -178,39 +1206,71 @@ RoutingExperiment::Run()
 
     wifiMac.SetType("ns3::AdhocWifiMac");
     NetDeviceContainer adhocDevices = wifi.Install(wifiPhy, wifiMac, adhocNodes);
+    AodvOverheadMonitor overhead;
+    overhead.Install(adhocDevices);
 
-    MobilityHelper mobilityAdhoc;
-    int64_t streamIndex = 0;
-
-    ObjectFactory pos;
-    pos.SetTypeId("ns3::RandomRectanglePositionAllocator");
-    pos.Set("X", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=300.0]"));
-    pos.Set("Y", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=1500.0]"));
-
-    Ptr<PositionAllocator> taPositionAlloc = pos.Create()->GetObject<PositionAllocator>();
-    streamIndex += taPositionAlloc->AssignStreams(streamIndex);
-
-    std::stringstream ssSpeed;
-    ssSpeed << "ns3::UniformRandomVariable[Min=0.0|Max=" << nodeSpeed << "]";
-    std::stringstream ssPause;
-    ssPause << "ns3::ConstantRandomVariable[Constant=" << nodePause << "]";
-    mobilityAdhoc.SetMobilityModel("ns3::RandomWaypointMobilityModel",
-                                   "Speed",
-                                   StringValue(ssSpeed.str()),
-                                   "Pause",
-                                   StringValue(ssPause.str()),
-                                   "PositionAllocator",
-                                   PointerValue(taPositionAlloc));
-    mobilityAdhoc.SetPositionAllocator(taPositionAlloc);
-    mobilityAdhoc.Install(adhocNodes);
-    streamIndex += mobilityAdhoc.AssignStreams(adhocNodes, streamIndex);
-
-    AodvHelper aodv;
-    InternetStackHelper internet;
-    Ipv4ListRoutingHelper list;
-    list.Add(aodv, 100);
-    internet.SetRoutingHelper(list);
-    internet.Install(adhocNodes);
+    // A replayed trajectory draws no random numbers, so every protocol moves the same way
+    if (!m_mobilityReplay.empty())
+    {
+        AodvMobilityRecorder::Replay(m_mobilityReplay, adhocNodes);
+    }
+    else
+    {
+        MobilityHelper mobilityAdhoc;
+        int64_t streamIndex = 0;
+
+        ObjectFactory pos;
+        pos.SetTypeId("ns3::RandomRectanglePositionAllocator");
+        pos.Set("X", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=300.0]"));
+        pos.Set("Y", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=1500.0]"));
+
+        Ptr<PositionAllocator> taPositionAlloc = pos.Create()->GetObject<PositionAllocator>();
+        streamIndex += taPositionAlloc->AssignStreams(streamIndex);
+
+        std::stringstream ssSpeed;
+        ssSpeed << "ns3::UniformRandomVariable[Min=0.0|Max=" << nodeSpeed << "]";
+        std::stringstream ssPause;
+        ssPause << "ns3::ConstantRandomVariable[Constant=" << nodePause << "]";
+        if (m_warmStart)
+        {
+            // Positions, speeds and pause states are drawn from the stationary distribution, which
+            // only exists for a positive minimum speed
+            mobilityAdhoc.SetMobilityModel("ns3::SteadyStateRandomWaypointMobilityModel",
+                                           "MinSpeed",
+                                           DoubleValue(0.1),
+                                           "MaxSpeed",
+                                           DoubleValue(nodeSpeed),
+                                           "MinPause",
+                                           DoubleValue(nodePause),
+                                           "MaxPause",
+                                           DoubleValue(nodePause),
+                                           "MinX",
+                                           DoubleValue(0.0),
+                                           "MaxX",
+                                           DoubleValue(300.0),
+                                           "MinY",
+                                           DoubleValue(0.0),
+                                           "MaxY",
+                                           DoubleValue(1500.0));
+        }
+        else
+        {
+            mobilityAdhoc.SetMobilityModel("ns3::RandomWaypointMobilityModel",
+                                           "Speed",
+                                           StringValue(ssSpeed.str()),
+                                           "Pause",
+                                           StringValue(ssPause.str()),
+                                           "PositionAllocator",
+                                           PointerValue(taPositionAlloc));
+        }
+        mobilityAdhoc.SetPositionAllocator(taPositionAlloc);
+        mobilityAdhoc.Install(adhocNodes);
+        streamIndex += mobilityAdhoc.AssignStreams(adhocNodes, streamIndex);
+    }
+
+    auto protocol = Protocols().find(m_protocolName);
+    NS_ABORT_MSG_IF(protocol == Protocols().end(), "No such protocol: " << m_protocolName);
+    protocol->second(adhocNodes);
 
     Ipv4AddressHelper addressAdhoc;
     addressAdhoc.SetBase("10.1.1.0", "255.255.255.0");
@@ -223,6 +1283,7 @@ RoutingExperiment::Run()
 
     m_nSinks = m_numberOfNodes / 2;
 
+    ApplicationContainer sources;
     for (int i = 0; i < m_nSinks; i++)
     {
         Ptr<Socket> sink = SetupPacketReceive(adhocInterfaces.GetAddress(i), adhocNodes.Get(i));
@@ -232,9 +1293,11 @@ RoutingExperiment::Run()
 
         Ptr<UniformRandomVariable> var = CreateObject<UniformRandomVariable>();
         ApplicationContainer temp = onoff1.Install(adhocNodes.Get(i + m_nSinks));
-        temp.Start(Seconds(var->GetValue(100.0, 101.0)));
+        temp.Start(Seconds(var->GetValue(startTime, startTime + 1.0)));
         temp.Stop(Seconds(TotalTime));
+        sources.Add(temp);
     }
+    m_flowStats.Install(sources);
 
     std::stringstream ss;
     ss << m_numberOfNodes;
@@ -256,11 +1319,37 @@ RoutingExperiment::Run()
     // tr_name = tr_name + "_" + m_protocolName +"_" + nodes + "nodes_" + sNodeSpeed + "speed_" +
     // sNodePause + "pause_" + sRate + "rate";
 
-    // AsciiTraceHelper ascii;
-    // Ptr<OutputStreamWrapper> osw = ascii.CreateFileStream(tr_name + ".tr");
-    // wifiPhy.EnableAsciiAll(osw);
+    // Processes forked for the traffic phase would share these output files
+    std::vector<std::string> forkRates = SplitList(m_forkRates, "");
+    bool sharedOutput = !m_sweepWorker && forkRates.empty();
+
+    AodvMobilityRecorder mobilityRecorder;
+    std::string mobilityFile = m_mobilityRecord;
+    if (mobilityFile.empty() && m_traceLevel >= TRACE_MOBILITY)
+    {
+        mobilityFile = tr_name + ".amob";
+    }
+    if (sharedOutput && !mobilityFile.empty())
+    {
+        mobilityRecorder.Start(mobilityFile, adhocNodes);
+    }
     AsciiTraceHelper ascii;
-    MobilityHelper::EnableAsciiAll(ascii.CreateFileStream(tr_name + ".mob"));
+    if (sharedOutput && m_traceLevel >= TRACE_FULL)
+    {
+        MobilityHelper::EnableAsciiAll(ascii.CreateFileStream(tr_name + ".mob"));
+        wifiPhy.EnableAsciiAll(ascii.CreateFileStream(tr_name + ".tr"));
+        wifiPhy.EnablePcapAll(tr_name);
+    }
+
+    // Only AODV has the counters, histograms and control messages the reports are made of
+    bool runsAodv = AodvHelper::GetAodv(adhocNodes.Get(0)) != nullptr;
+
+    AodvLoadSampler loadSampler;
+    if (!m_loadTrace.empty() && sharedOutput && runsAodv)
+    {
+        loadSampler.Install(adhocDevices);
+        loadSampler.Start(m_loadTrace, Seconds(m_loadInterval));
+    }
 
     FlowMonitorHelper flowmonHelper;
     Ptr<FlowMonitor> flowmon;
@@ -271,51 +1360,150 @@ RoutingExperiment::Run()
 
     NS_LOG_INFO("Run Simulation.");
 
-    //CheckThroughput();
-
-    Simulator::Stop(Seconds(TotalTime));
-    Simulator::Run();
-
-    if (m_flowMonitor)
+    if (!m_seriesFile.empty() && sharedOutput)
     {
-        flowmon->CheckForLostPackets();
-        FlowMonitor::FlowStatsContainer stats = flowmon->GetFlowStats();
+        NS_ABORT_MSG_UNLESS(m_seriesInterval > 0, "--seriesInterval must be positive");
+        m_series.assign(std::ceil(TotalTime / m_seriesInterval) + 1, SeriesSample());
+        m_seriesNodes = adhocNodes;
+        m_seriesOverhead = &overhead;
+        CheckThroughput();
+    }
+
+    // Simulate until TotalTime and return the result row
+    auto runTraffic = [&]() {
+        Simulator::Stop(Seconds(TotalTime) - Simulator::Now());
+        Simulator::Run();
 
         double throughput = 0.0;
         double delay = 0.0;
         double packetDeliveryRatio = 0.0;
         double packetDropRatio = 0.0;
 
-        // Iterate over flow stats to extract the necessary metrics
-        uint64_t totalBytes = 0;
-        uint64_t totalPackets = 0;
-        uint64_t totalDroppedPackets = 0;
-        uint64_t totalReceivedPackets = 0;
-        double totalDelay = 0;
-
-        for (const auto &entry : stats)
+        // Payload bytes and end to end delays as the applications see them
+        uint64_t totalBytes = m_flowStats.GetRxBytes();
+        uint64_t totalPackets = m_flowStats.GetTxPackets();
+        uint64_t totalDroppedPackets = m_flowStats.GetLostPackets();
+        uint64_t totalReceivedPackets = m_flowStats.GetRxPackets();
+        double totalDelay = m_flowStats.GetDelaySum().GetSeconds();
+        if (m_flowMonitor)
         {
-            FlowMonitor::FlowStats flowStats = entry.second;
-            //throughput += (flowStats.rxBytes * 8.0)/(flowStats. timeLastRxPacket.GetSeconds() - flowStats.timeFirstTxPacket.GetSeconds()) / 1000; // kbps
-            totalBytes += flowStats.rxBytes;
-            totalPackets += flowStats.txPackets;
-            totalDroppedPackets += flowStats.lostPackets;
-            totalReceivedPackets += flowStats.rxPackets;
-            totalDelay += flowStats.delaySum.GetSeconds();
+            flowmon->CheckForLostPackets();
+            FlowMonitor::FlowStatsContainer stats = flowmon->GetFlowStats();
+
+            // FlowMonitor counts IP bytes, headers included, so its aggregates are only printed for
+            // comparison; the row keeps the collector's, as manet-routing-compare does
+            uint64_t monitorBytes = 0;
+            uint64_t monitorPackets = 0;
+            uint64_t monitorReceived = 0;
+            double monitorDelay = 0;
+            for (const auto& entry : stats)
+            {
+                FlowMonitor::FlowStats flowStats = entry.second;
+                monitorBytes += flowStats.rxBytes;
+                monitorPackets += flowStats.txPackets;
+                monitorReceived += flowStats.rxPackets;
+                monitorDelay += flowStats.delaySum.GetSeconds();
+            }
+            std::cout << "FlowMonitor: throughput "
+                      << monitorBytes * 8.0 / ((TotalTime - startTime) * 1024.0) << " kbps, PDR "
+                      << monitorReceived * 100.0 / monitorPackets << " %, delay "
+                      << monitorDelay / monitorReceived << " s" << std::endl;
+            if (sharedOutput && m_traceLevel >= TRACE_FULL)
+            {
+                flowmon->SerializeToXmlFile(tr_name + ".flowmon", false, false);
+            }
         }
 
-        double simulationTimeInSeconds = Simulator::Now().GetSeconds();
-        throughput = (double)(totalBytes * 8.0) /(double)((TotalTime - startTime) *1024.0);// kbps
+        throughput = (double)(totalBytes * 8.0) / (double)((TotalTime - startTime) * 1024.0);
         packetDeliveryRatio = (double)((totalReceivedPackets * 1.0) * 100.0) / (double)totalPackets;
-        packetDropRatio = (double)((totalDroppedPackets * 1.0) * 100.0 )/ (double)totalPackets;
+        packetDropRatio = (double)((totalDroppedPackets * 1.0) * 100.0) / (double)totalPackets;
         delay = totalDelay / (double)totalReceivedPackets;
 
-        // Write the metrics to the CSV file
-        std::ofstream out(m_CSVfileName, std::ios::app);
-        out << m_numberOfNodes << "," << m_packetsPerSecond << "," << nodeSpeed << "," << throughput
-            << "," << delay << "," << packetDeliveryRatio << "," << packetDropRatio << std::endl;
-        out.close();
-        flowmon->SerializeToXmlFile(tr_name + ".flowmon", false, false);
+        std::ostringstream out;
+        out << ScenarioColumns() << throughput << "," << delay << "," << packetDeliveryRatio << ","
+            << packetDropRatio << ",";
+        AodvHelper::WritePercentiles(adhocNodes, out);
+        // Control frames per delivered data packet, and control bytes per delivered data byte.
+        // The monitor only recognizes AODV messages, other protocols report NA.
+        if (runsAodv)
+        {
+            out << "," << overhead.GetControlFrames() << "," << overhead.GetControlBytes() << ","
+                << (double)overhead.GetControlFrames() / (double)totalReceivedPackets << ","
+                << (double)overhead.GetControlBytes() / (double)totalBytes << ",";
+        }
+        else
+        {
+            out << ",NA,NA,NA,NA,";
+        }
+        out << m_flowStats.GetDelayQuantile(0.5).GetSeconds() << ","
+            << m_flowStats.GetDelayQuantile(0.95).GetSeconds() << ","
+            << m_flowStats.GetDelayQuantile(0.99).GetSeconds() << ","
+            << m_flowStats.GetMeanJitter().GetSeconds() << ",";
+        double wallClock =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        // In a forked traffic phase this includes the warm-up pages shared with the parent
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        uint64_t events = Simulator::GetEventCount();
+        out << wallClock << "," << usage.ru_maxrss << "," << events << ","
+            << events / wallClock << std::endl;
+
+        if (m_compact)
+        {
+            ReportCompactSavings(adhocNodes, phyMode);
+        }
+        if (sharedOutput && m_traceLevel >= TRACE_SUMMARY)
+        {
+            if (runsAodv)
+            {
+                WriteCounters(adhocNodes);
+                WriteOverhead(overhead);
+            }
+            WriteFlows();
+        }
+        if (sharedOutput && !m_seriesFile.empty())
+        {
+            WriteSeries();
+        }
+        return out.str();
+    };
+
+    std::string rows;
+    bool complete = true;
+    if (forkRates.empty())
+    {
+        rows = runTraffic();
+    }
+    else
+    {
+        // No source starts before startTime, so the run up to there is the same for every rate:
+        // simulate it once, then continue a copy-on-write copy of this process per rate
+        Simulator::Stop(Seconds(startTime));
+        Simulator::Run();
+        std::vector<std::string> results = ForkEach(forkRates.size(), GetJobs(), [&](size_t i) {
+            m_packetsPerSecond = std::stoi(forkRates[i]);
+            std::string forkRate = std::to_string(64 * 8 * m_packetsPerSecond) + "bps";
+            for (auto app = sources.Begin(); app != sources.End(); ++app)
+            {
+                (*app)->SetAttribute("DataRate", StringValue(forkRate));
+            }
+            return runTraffic();
+        });
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            if (results[i].empty())
+            {
+                std::cerr << "Traffic phase at " << forkRates[i] << " packets/s failed"
+                          << std::endl;
+                complete = false;
+            }
+            rows += results[i];
+        }
+    }
+    EmitRows(rows);
+    if (useCache && complete)
+    {
+        StoreCached(cacheKey, rows);
     }
 
     Simulator::Destroy();
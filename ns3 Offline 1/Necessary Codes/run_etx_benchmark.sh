@@ -0,0 +1,12 @@
+#!/bin/bash
+
+# Compare goodput of hop count and ETX route selection over the run_simulation.sh sweep
+HOPCOUNT_FILE="result_hopcount.csv"
+ETX_FILE="result_etx.csv"
+
+rm -f "$HOPCOUNT_FILE" "$ETX_FILE"
+
+./run_simulation.sh "$HOPCOUNT_FILE" --etx=0
+./run_simulation.sh "$ETX_FILE" --etx=1
+
+python3 etx_plot.py "$HOPCOUNT_FILE" "$ETX_FILE"
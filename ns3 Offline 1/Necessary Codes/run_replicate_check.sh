@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Replicate a small OLSR grid to a CI target: OLSR rows hold NA in the AODV-only columns, which
+# the replication has to leave out of its intervals and write as NA again. The check fails when
+# the run does not finish or the file misses a point.
+REPLICATE_FILE="result_replicate_olsr.csv"
+POINTS=2
+
+rm -f "$REPLICATE_FILE"
+
+./ns3 run "scratch/raodv_usage --sweep --protocol=OLSR --nodeList=20,40 --ciTarget=0.1 --minRuns=2 --maxRuns=4 --sweepFile=$REPLICATE_FILE $*" || exit 1
+
+ROWS=$(($(wc -l < "$REPLICATE_FILE") - 1))
+if [ "$ROWS" -ne "$POINTS" ]; then
+    echo "Expected $POINTS replicated points in $REPLICATE_FILE, found $ROWS"
+    exit 1
+fi
+if ! grep -q ",NA,NA" "$REPLICATE_FILE"; then
+    echo "No NA columns in $REPLICATE_FILE"
+    exit 1
+fi
+echo "Replication of OLSR finished, $ROWS points written to $REPLICATE_FILE"
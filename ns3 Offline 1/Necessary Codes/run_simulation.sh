@@ -10,30 +10,54 @@ CONSTANT_NODE_NUM=20
 CONSTANT_PACKETS=100
 CONSTANT_SPEED=5
 
-# Output file for results (ensure it matches the CSV file used in your program)
-OUTPUT_FILE="result.csv"
-
-## Ensure the header is written only once
-if [ ! -f "$OUTPUT_FILE" ]; then
-    echo "NumOfNodes,PacketsPerSec,NodeSpeed,Throughput,EndToEndDelay,PacketDeliveryRatio,PacketDropRatio" > $OUTPUT_FILE
-fi
+# The points below run one after another. raodv_usage can also run a whole grid in parallel, one
+# worker process per point, and write the rows in grid order, e.g.
+#   ./ns3 run "scratch/raodv_usage --sweep --nodeList=20,40,70,100 --rateList=100,200 --runList=1,2"
+# With --ciTarget every point is replicated with run numbers from --run on until the 95% CI of each
+# metric is within that fraction of its mean (or --maxRuns is reached), and the sweep file holds
+# the means, CI half-widths and replication counts, e.g.
+#   ./ns3 run "scratch/raodv_usage --sweep --nodeList=20,40,70,100 --ciTarget=0.05 --maxRuns=20"
+
+# For paired comparisons, record the movement once and replay it with every driver, e.g.
+#   ./ns3 run "scratch/raodv_usage --numberOfNodes=40 --mobilityRecord=n40.amob"
+#   ./ns3 run "scratch/manet-routing-compare --numberOfNodes=40 --mobilityReplay=n40.amob"
+#   ./ns3 run "scratch/raodv_usage --numberOfNodes=40 --mobilityReplay=n40.amob"
+
+# To benchmark every protocol on the same scenarios in one table, with the wall-clock time, peak
+# RSS and simulated events per second of each run next to the network metrics, e.g.
+#   ./ns3 run "scratch/raodv_usage --sweep --protocolList=AODV,RAODV,OLSR,DSDV,DSR --nodeList=20,40"
+
+# Output file for results, and extra options for every run (e.g. --etx=1):
+#   ./run_simulation.sh [output.csv] [options...]
+OUTPUT_FILE="${1:-result.csv}"
+EXTRA_ARGS="${*:2}"
+
+# Runs already done by the current build are reused from the cache, so the table is rebuilt from
+# scratch every time: a rerun only simulates missing or invalidated points and never duplicates
+# rows. The cache also replays the per-node and per-flow rows of the companion files, which are
+# cleared with the table; runs writing trajectory, series or load traces are never cached.
+# raodv_usage writes the CSV headers itself when the output files do not exist yet
+CACHE_DIR="${CACHE_DIR:-result-cache}"
+OUTPUT_BASE="${OUTPUT_FILE%.csv}"
+rm -f "$OUTPUT_FILE" "$OUTPUT_BASE-counters.csv" "$OUTPUT_BASE-overhead.csv" "$OUTPUT_BASE-flows.csv"
+EXTRA_ARGS="--cacheDir=$CACHE_DIR $EXTRA_ARGS"
 
 # Vary the number of nodes while keeping other parameters constant
 for NODES in "${NODE_NUMS[@]}"; do
     echo "Running simulation with NodeNum=$NODES, PacketsPerSec=$CONSTANT_PACKETS, Speed=$CONSTANT_SPEED"
-    ./ns3 run "scratch/raodv_usage --numberOfNodes=$NODES --packetsPerSecond=$CONSTANT_PACKETS --nodeSpeed=$CONSTANT_SPEED"
+    ./ns3 run "scratch/raodv_usage --numberOfNodes=$NODES --packetsPerSecond=$CONSTANT_PACKETS --nodeSpeed=$CONSTANT_SPEED --CSVfileName=$OUTPUT_FILE $EXTRA_ARGS"
 done
 
 # Vary the number of packets per second while keeping other parameters constant
 for PACKETS in "${PACKETS_PER_SECOND[@]}"; do
     echo "Running simulation with NodeNum=$CONSTANT_NODE_NUM, PacketsPerSec=$PACKETS, Speed=$CONSTANT_SPEED"
-    ./ns3 run "scratch/raodv_usage --numberOfNodes=$CONSTANT_NODE_NUM --packetsPerSecond=$PACKETS --nodeSpeed=$CONSTANT_SPEED"
+    ./ns3 run "scratch/raodv_usage --numberOfNodes=$CONSTANT_NODE_NUM --packetsPerSecond=$PACKETS --nodeSpeed=$CONSTANT_SPEED --CSVfileName=$OUTPUT_FILE $EXTRA_ARGS"
 done
 
 # Vary the speed of nodes while keeping other parameters constant
 for SPEED in "${SPEEDS[@]}"; do
     echo "Running simulation with NodeNum=$CONSTANT_NODE_NUM, PacketsPerSec=$CONSTANT_PACKETS, Speed=$SPEED"
-    ./ns3 run "scratch/raodv_usage --numberOfNodes=$CONSTANT_NODE_NUM --packetsPerSecond=$CONSTANT_PACKETS --nodeSpeed=$SPEED"
+    ./ns3 run "scratch/raodv_usage --numberOfNodes=$CONSTANT_NODE_NUM --packetsPerSecond=$CONSTANT_PACKETS --nodeSpeed=$SPEED --CSVfileName=$OUTPUT_FILE $EXTRA_ARGS"
 done
 
 echo "All simulations completed. Results stored in $OUTPUT_FILE."
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Wall time and disk use of every --traceLevel tier on the same scenario. Each tier runs in an
+# empty directory so that everything it writes can be summed, and is compared with the "none"
+# tier; the table goes to trace_benchmark.csv. Extra options are passed to every run, e.g.
+#   ./run_trace_benchmark.sh --numberOfNodes=40
+OUTPUT_FILE="trace_benchmark.csv"
+ARGS="--numberOfNodes=100 --packetsPerSecond=100 --nodeSpeed=5 $*"
+
+# Build first so that no tier is charged for compiling
+./ns3 build || exit 1
+
+echo "TraceLevel,WallSeconds,Bytes,Files,WallDelta,BytesDelta" > "$OUTPUT_FILE"
+for LEVEL in none summary mobility full; do
+    DIR=$(mktemp -d)
+    START=$(date +%s.%N)
+    ./ns3 run --no-build --cwd="$DIR" "scratch/raodv_usage --traceLevel=$LEVEL $ARGS"
+    END=$(date +%s.%N)
+    WALL=$(echo "$END - $START" | bc)
+    BYTES=$(find "$DIR" -type f -printf '%s\n' | awk '{ s += $1 } END { print s + 0 }')
+    FILES=$(find "$DIR" -type f | wc -l)
+    rm -rf "$DIR"
+    if [ "$LEVEL" = none ]; then
+        BASE_WALL=$WALL
+        BASE_BYTES=$BYTES
+    fi
+    echo "$LEVEL,$WALL,$BYTES,$FILES,$(echo "$WALL - $BASE_WALL" | bc),$((BYTES - BASE_BYTES))" \
+        >> "$OUTPUT_FILE"
+done
+column -s, -t "$OUTPUT_FILE"
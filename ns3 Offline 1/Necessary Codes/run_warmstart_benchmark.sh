@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Compare steady-state mobility initialization (--warmStart) with the 100 s warm-up: the same
+# sweep runs with several seeds in both modes, then warmstart_compare.py tests every metric for
+# equivalence within its margin (TOST) and reports the wall time of both modes. The per-test
+# results are kept in EQUIVALENCE_FILE.
+WARMUP_FILE="result_warmup.csv"
+WARMSTART_FILE="result_warmstart.csv"
+EQUIVALENCE_FILE="warmstart_equivalence.csv"
+RUNS="1,2,3,4,5,6,7,8,9,10"
+GRID="--nodeList=20,40,70 --rateList=100,300 --speedList=5,20 --runList=$RUNS"
+
+rm -f "$WARMUP_FILE" "$WARMSTART_FILE" "$EQUIVALENCE_FILE"
+
+START=$(date +%s.%N)
+./ns3 run "scratch/raodv_usage --sweep $GRID --sweepFile=$WARMUP_FILE $*"
+MIDDLE=$(date +%s.%N)
+./ns3 run "scratch/raodv_usage --sweep $GRID --sweepFile=$WARMSTART_FILE --warmStart=1 $*"
+END=$(date +%s.%N)
+
+python3 warmstart_compare.py "$WARMUP_FILE" "$WARMSTART_FILE" \
+    "$(echo "$MIDDLE - $START" | bc)" "$(echo "$END - $MIDDLE" | bc)" "$EQUIVALENCE_FILE"
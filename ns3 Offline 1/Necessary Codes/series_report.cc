@@ -0,0 +1,126 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Turns the time series raodv_usage --seriesFile writes into a CSV.
+ *
+ *   series_report <series> [csv]
+ *
+ * writes one row per sample and one column per series column. The CSV name defaults to the
+ * series name with its extension replaced by .csv. The program does not depend on ns-3 and
+ * builds with any C++17 compiler.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * Read a little-endian 32-bit integer
+ * \param is the input stream
+ * \param value the value read
+ * \returns false at the end of the stream
+ */
+bool
+ReadU32(std::istream& is, uint32_t& value)
+{
+    unsigned char bytes[4];
+    if (!is.read(reinterpret_cast<char*>(bytes), 4))
+    {
+        return false;
+    }
+    value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | uint32_t(bytes[3]) << 24;
+    return true;
+}
+
+/**
+ * Read a little-endian IEEE 754 double
+ * \param is the input stream
+ * \param value the value read
+ * \returns false at the end of the stream
+ */
+bool
+ReadDouble(std::istream& is, double& value)
+{
+    uint32_t low;
+    uint32_t high;
+    if (!ReadU32(is, low) || !ReadU32(is, high))
+    {
+        return false;
+    }
+    uint64_t bits = uint64_t(high) << 32 | low;
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <series> [csv]" << std::endl;
+        return 1;
+    }
+    std::string series = argv[1];
+    std::string csv = argc == 3 ? argv[2] : series.substr(0, series.rfind('.')) + ".csv";
+
+    std::ifstream in(series, std::ios::binary);
+    char magic[4];
+    uint32_t version;
+    uint32_t columns;
+    uint32_t rows;
+    if (!in.read(magic, 4) || std::string(magic, 4) != "ATSC" || !ReadU32(in, version) ||
+        version != 1 || !ReadU32(in, columns) || !ReadU32(in, rows))
+    {
+        std::cerr << series << ": not a version 1 time series" << std::endl;
+        return 1;
+    }
+    std::vector<std::string> names(columns);
+    for (std::string& name : names)
+    {
+        int length = in.get();
+        name.resize(length == EOF ? 0 : length);
+        if (length == EOF || !in.read(&name[0], length))
+        {
+            std::cerr << series << ": truncated header" << std::endl;
+            return 1;
+        }
+    }
+    // Columns are stored one after another, so all of them are read before the first row
+    std::vector<std::vector<double>> values(columns, std::vector<double>(rows));
+    for (uint32_t c = 0; c < columns; ++c)
+    {
+        for (uint32_t r = 0; r < rows; ++r)
+        {
+            if (!ReadDouble(in, values[c][r]))
+            {
+                std::cerr << series << ": truncated column " << names[c] << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    std::ofstream out(csv);
+    for (uint32_t c = 0; c < columns; ++c)
+    {
+        out << (c ? "," : "") << names[c];
+    }
+    out << std::endl;
+    for (uint32_t r = 0; r < rows; ++r)
+    {
+        for (uint32_t c = 0; c < columns; ++c)
+        {
+            out << (c ? "," : "") << values[c][r];
+        }
+        out << std::endl;
+    }
+    std::cout << rows << " samples of " << columns << " columns written to " << csv << std::endl;
+    return 0;
+}
@@ -8,12 +8,20 @@ file_raodv = "result.csv"  # RAODV data
 output_dir = "graphs/task3"  # Directory to save the graphs
 os.makedirs(output_dir, exist_ok=True)
 
+# Both drivers compute the metrics from AodvFlowCollector with the same definitions: throughput in
+# payload kbit/s, delay, delivery and drop ratios as the applications see them. CSVs written
+# before manet-routing-compare used the collector took its metrics from FlowMonitor (IP bytes,
+# headers included) and must be regenerated before they are plotted against result.csv. Both
+# files now start their rows with Protocol and Run; the columns are read by name, so files from
+# before that change still plot.
+
 # Load the data
 df_aodv = pd.read_csv(file_aodv)
 df_raodv = pd.read_csv(file_raodv)
 
 # Metrics to plot
-metrics = ["Throughput", "EndToEndDelay", "PacketDeliveryRatio", "PacketDropRatio"]
+metrics = ["Throughput", "EndToEndDelay", "PacketDeliveryRatio", "PacketDropRatio",
+           "NormalizedRoutingLoad", "MacOverhead"]
 
 # Define row groups for filtering
 rows_for_nodenumber_aodv = df_aodv.iloc[:4]  # First 4 rows for AODV
@@ -67,4 +75,4 @@ for metric in metrics:
     filename = os.path.join(output_dir, f"NodeSpeed_vs_{metric}.png")
     plot_graph(x_values_aodv, y_values_aodv, x_values_raodv, y_values_raodv, "NodeSpeed", metric, title, filename)
 
-print(f"12 graphs have been saved in the '{output_dir}' directory.")
+print(f"{3 * len(metrics)} graphs have been saved in the '{output_dir}' directory.")
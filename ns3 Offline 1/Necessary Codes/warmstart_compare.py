@@ -0,0 +1,72 @@
+import pandas as pd
+import sys
+from scipy import stats
+
+# Sweep results of both modes, optionally their wall times in seconds and the output file of the
+# per-test results
+file_warmup = sys.argv[1] if len(sys.argv) > 1 else "result_warmup.csv"  # 100 s warm-up
+file_warmstart = sys.argv[2] if len(sys.argv) > 2 else "result_warmstart.csv"  # Steady state
+wall_warmup = float(sys.argv[3]) if len(sys.argv) > 3 else None
+wall_warmstart = float(sys.argv[4]) if len(sys.argv) > 4 else None
+file_results = sys.argv[5] if len(sys.argv) > 5 else "warmstart_equivalence.csv"
+
+df_warmup = pd.read_csv(file_warmup)
+df_warmstart = pd.read_csv(file_warmstart)
+
+# Equivalence margins: the largest difference of the warm start mean from the warm-up mean that
+# still counts as the same result. Throughput and delay are relative to the warm-up mean, the
+# ratios (in percent) are absolute percentage points.
+relative_margins = {"Throughput": 0.05, "EndToEndDelay": 0.05}
+absolute_margins = {"PacketDeliveryRatio": 2.0, "PacketDropRatio": 2.0}
+metrics = list(relative_margins) + list(absolute_margins)
+point = ["Protocol", "NumOfNodes", "PacketsPerSec", "NodeSpeed"]
+alpha = 0.05
+
+
+def margin(metric, warmup):
+    if metric in relative_margins:
+        return relative_margins[metric] * abs(warmup[metric].mean())
+    return absolute_margins[metric]
+
+
+# Two one-sided Welch t-tests (TOST) per sweep point and metric over the runs. Equivalence is
+# shown when the difference is significantly above -margin and significantly below +margin; a
+# test that fails to show it means the runs cannot tell the modes apart within the margin, not
+# that they differ.
+rows = []
+for key, warmup in df_warmup.groupby(point):
+    warmstart = df_warmstart
+    for column, value in zip(point, key):
+        warmstart = warmstart[warmstart[column] == value]
+    if len(warmup) < 2 or len(warmstart) < 2:
+        continue
+    for metric in metrics:
+        delta = margin(metric, warmup)
+        _, p_lower = stats.ttest_ind(warmstart[metric] + delta, warmup[metric],
+                                     equal_var=False, alternative="greater")
+        _, p_upper = stats.ttest_ind(warmstart[metric] - delta, warmup[metric],
+                                     equal_var=False, alternative="less")
+        p = max(p_lower, p_upper)
+        rows.append(dict(zip(point, key)) | {
+            "Metric": metric,
+            "Warmup": warmup[metric].mean(),
+            "WarmStart": warmstart[metric].mean(),
+            "Margin": delta,
+            "P": p,
+            "Equivalent": p < alpha,
+        })
+        print(f"{dict(zip(point, key))} {metric}: {warmup[metric].mean():.4g} (warm-up) vs "
+              f"{warmstart[metric].mean():.4g} (warm start), margin {delta:.4g}, TOST p = {p:.3f}"
+              + ("" if p < alpha else " NOT SHOWN EQUIVALENT"))
+
+if rows:
+    results = pd.DataFrame(rows)
+    results.to_csv(file_results, index=False)
+    for metric in metrics:
+        shown = results[results["Metric"] == metric]["Equivalent"]
+        print(f"{metric}: equivalent at {shown.sum()} of {len(shown)} points "
+              f"(TOST, {alpha:.0%} level)")
+    print(f"Per-test results written to {file_results}")
+if wall_warmup and wall_warmstart:
+    print(f"Wall time: {wall_warmup:.1f} s (warm-up), {wall_warmstart:.1f} s (warm start), "
+          f"{(1 - wall_warmstart / wall_warmup) * 100:.0f}% saved")